@@ -0,0 +1,347 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#include "BatchConverter.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QProcess>
+#include <QTimer>
+
+#include <klocalizedstring.h>
+
+#include <stdio.h>
+
+// Stdout is buffered, the other side waits for the line right away
+static void flush(QIODevice *device)
+{
+    if (QFile *file = qobject_cast<QFile*>(device)) {
+        file->flush();
+    }
+}
+
+bool BatchJob::parse(const QString &line, BatchJob *job)
+{
+    const QStringList fields = line.split(QLatin1Char('\t'));
+    if (fields.count() < 2 || fields.count() > 3) {
+        return false;
+    }
+    job->input = fields.at(0);
+    job->output = fields.at(1);
+    job->mimetype = fields.count() == 3 ? fields.at(2) : QString();
+    return !job->input.isEmpty() && !job->output.isEmpty();
+}
+
+QByteArray BatchJob::toLine() const
+{
+    QString line = input + QLatin1Char('\t') + output;
+    if (!mimetype.isEmpty()) {
+        line += QLatin1Char('\t') + mimetype;
+    }
+    return line.toUtf8() + '\n';
+}
+
+QByteArray BatchJob::resultLine(bool ok)
+{
+    // Distinct enough to be told apart from what filters print to stdout
+    return ok ? QByteArray("calligraconverter-result: ok\n")
+              : QByteArray("calligraconverter-result: failed\n");
+}
+
+
+BatchWorker::~BatchWorker()
+{
+}
+
+void BatchWorker::run(QIODevice *in, QIODevice *out)
+{
+    // An empty line is the end of the input, jobs end with a newline
+    QByteArray line = in->readLine();
+    while (!line.isEmpty()) {
+        if (line.endsWith('\n')) {
+            line.chop(1);
+        }
+        BatchJob job;
+        const bool ok = BatchJob::parse(QString::fromUtf8(line), &job) && convert(job);
+
+        // Documents are deleted with deleteLater()
+        QCoreApplication::processEvents();
+        QCoreApplication::sendPostedEvents(0, QEvent::DeferredDelete);
+
+        out->write(BatchJob::resultLine(ok));
+        flush(out);
+        line = in->readLine();
+    }
+}
+
+
+BatchJobReader::BatchJobReader(const QString &fileName, QObject *parent)
+    : QThread(parent)
+    , m_fileName(fileName)
+{
+}
+
+void BatchJobReader::run()
+{
+    QFile file;
+    bool opened;
+    if (m_fileName == QLatin1String("-")) {
+        opened = file.open(stdin, QIODevice::ReadOnly);
+    } else {
+        file.setFileName(m_fileName);
+        opened = file.open(QIODevice::ReadOnly);
+    }
+    if (!opened) {
+        qCritical() << i18n("Could not open the job list %1", m_fileName);
+        return;
+    }
+
+    // Blocks until the next job or the end of the list
+    QByteArray line = file.readLine();
+    while (!line.isEmpty()) {
+        while (line.endsWith('\n') || line.endsWith('\r')) {
+            line.chop(1);
+        }
+        emit lineRead(QString::fromUtf8(line));
+        line = file.readLine();
+    }
+}
+
+
+BatchConverter::BatchConverter(const QString &jobFile, const QStringList &workerArguments,
+                               int workerCount, int timeout, QObject *parent)
+    : QObject(parent)
+    , m_reader(jobFile)
+    , m_workerArguments(workerArguments)
+    , m_workerCount(qMax(1, workerCount))
+    , m_timeout(timeout)
+    , m_inputDone(false)
+    , m_startFailed(false)
+    , m_failed(0)
+    , m_output(0)
+{
+    // Both are queued, as they are emitted from the reader thread
+    connect(&m_reader, SIGNAL(lineRead(QString)), SLOT(addJob(QString)));
+    connect(&m_reader, SIGNAL(finished()), SLOT(inputFinished()));
+}
+
+BatchConverter::~BatchConverter()
+{
+    foreach (Worker *worker, m_workers) {
+        worker->process->disconnect(this);
+        worker->process->kill();
+        worker->process->waitForFinished();
+        delete worker->process;
+        delete worker->timer;
+        delete worker;
+    }
+    m_reader.wait();
+}
+
+void BatchConverter::setOutput(QIODevice *output)
+{
+    m_output = output;
+}
+
+int BatchConverter::exec()
+{
+    if (!m_output) {
+        m_stdout.open(stdout, QIODevice::WriteOnly);
+        m_output = &m_stdout;
+    }
+    m_reader.start();
+    m_loop.exec();
+    m_reader.wait();
+    return m_failed ? 2 : 0;
+}
+
+void BatchConverter::addJob(const QString &line)
+{
+    if (line.isEmpty() || line.startsWith(QLatin1Char('#'))) {
+        return;
+    }
+    BatchJob job;
+    if (!BatchJob::parse(line, &job)) {
+        qCritical() << i18n("Invalid job: %1", line);
+        ++m_failed;
+        return;
+    }
+    m_pending.enqueue(job);
+    dispatch();
+}
+
+void BatchConverter::inputFinished()
+{
+    m_inputDone = true;
+    dispatch();
+}
+
+void BatchConverter::readResults()
+{
+    Worker *worker = this->worker(sender());
+    if (worker) {
+        readResults(worker);
+        dispatch();
+    }
+}
+
+void BatchConverter::readResults(Worker *worker)
+{
+    while (worker->process->canReadLine()) {
+        const QByteArray line = worker->process->readLine();
+        if (!worker->busy) {
+            continue;
+        }
+        // Anything else is output of the filters
+        if (line.endsWith(BatchJob::resultLine(true))) {
+            finishJob(worker, "ok");
+        } else if (line.endsWith(BatchJob::resultLine(false))) {
+            finishJob(worker, "failed");
+        }
+    }
+}
+
+void BatchConverter::workerFinished()
+{
+    Worker *worker = this->worker(sender());
+    if (!worker) {
+        return;
+    }
+
+    // The answer may have been written right before the worker exited
+    readResults(worker);
+    if (worker->busy) {
+        finishJob(worker, worker->timedOut ? "timeout" : "crashed");
+    }
+
+    m_workers.removeOne(worker);
+    worker->process->deleteLater();
+    delete worker->timer;
+    delete worker;
+
+    dispatch();
+}
+
+void BatchConverter::jobTimedOut()
+{
+    Worker *worker = this->worker(sender());
+    if (worker && worker->busy) {
+        // Reported once the process is gone, see workerFinished()
+        worker->timedOut = true;
+        worker->process->kill();
+    }
+}
+
+BatchConverter::Worker *BatchConverter::startWorker()
+{
+    QProcess *process = new QProcess(this);
+    // The workers log to our stderr, their stdout carries the results
+    process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    process->start(QCoreApplication::applicationFilePath(), m_workerArguments);
+    if (!process->waitForStarted()) {
+        qCritical() << i18n("Could not start a worker: %1", process->errorString());
+        delete process;
+        return 0;
+    }
+    connect(process, SIGNAL(readyReadStandardOutput()), SLOT(readResults()));
+    connect(process, SIGNAL(finished(int,QProcess::ExitStatus)), SLOT(workerFinished()));
+
+    Worker *worker = new Worker;
+    worker->process = process;
+    worker->timer = new QTimer(this);
+    worker->timer->setSingleShot(true);
+    connect(worker->timer, SIGNAL(timeout()), SLOT(jobTimedOut()));
+    worker->busy = false;
+    worker->timedOut = false;
+    m_workers.append(worker);
+    return worker;
+}
+
+BatchConverter::Worker *BatchConverter::worker(QObject *object) const
+{
+    foreach (Worker *worker, m_workers) {
+        if (worker->process == object || worker->timer == object) {
+            return worker;
+        }
+    }
+    return 0;
+}
+
+void BatchConverter::startJob(Worker *worker, const BatchJob &job)
+{
+    worker->job = job;
+    worker->busy = true;
+    worker->process->write(job.toLine());
+    if (m_timeout > 0) {
+        worker->timer->start(m_timeout * 1000);
+    }
+}
+
+void BatchConverter::dispatch()
+{
+    foreach (Worker *worker, m_workers) {
+        if (m_pending.isEmpty()) {
+            break;
+        }
+        if (!worker->busy) {
+            startJob(worker, m_pending.dequeue());
+        }
+    }
+    while (!m_pending.isEmpty() && !m_startFailed && m_workers.count() < m_workerCount) {
+        Worker *worker = startWorker();
+        if (!worker) {
+            // Give up only if there is no worker at all to wait for
+            m_startFailed = m_workers.isEmpty();
+            break;
+        }
+        startJob(worker, m_pending.dequeue());
+    }
+    if (m_startFailed && m_workers.isEmpty()) {
+        while (!m_pending.isEmpty()) {
+            report(m_pending.dequeue(), "failed");
+        }
+    }
+
+    if (m_inputDone && m_pending.isEmpty()) {
+        // Idle workers exit once their stdin is closed
+        foreach (Worker *worker, m_workers) {
+            if (!worker->busy) {
+                worker->process->closeWriteChannel();
+            }
+        }
+        if (m_workers.isEmpty()) {
+            m_loop.quit();
+        }
+    }
+}
+
+void BatchConverter::finishJob(Worker *worker, const char *status)
+{
+    worker->timer->stop();
+    worker->busy = false;
+    report(worker->job, status);
+}
+
+void BatchConverter::report(const BatchJob &job, const char *status)
+{
+    if (qstrcmp(status, "ok") != 0) {
+        ++m_failed;
+    }
+    m_output->write(QByteArray(status) + '\t' + job.input.toUtf8() + '\t' + job.output.toUtf8() + '\n');
+    flush(m_output);
+}
@@ -0,0 +1,163 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#ifndef BATCHCONVERTER_H
+#define BATCHCONVERTER_H
+
+#include <QEventLoop>
+#include <QFile>
+#include <QList>
+#include <QObject>
+#include <QQueue>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+
+class QIODevice;
+class QProcess;
+class QTimer;
+
+/**
+ * One conversion of a batch, given as a line "input<TAB>output" or
+ * "input<TAB>output<TAB>mimetype", where mimetype is the output format.
+ */
+struct BatchJob
+{
+    QString input;
+    QString output;
+    QString mimetype;
+
+    /// @return false if @p line is not a job
+    static bool parse(const QString &line, BatchJob *job);
+    QByteArray toLine() const;
+
+    /// The line a worker answers a job with
+    static QByteArray resultLine(bool ok);
+};
+
+/**
+ * The worker side of a batch conversion. Converts the jobs written to it
+ * one per line, one after the other, and answers each of them with
+ * BatchJob::resultLine(). A line that is not a job is answered as failed.
+ */
+class BatchWorker
+{
+public:
+    virtual ~BatchWorker();
+
+    /// Converts the jobs read from @p in until its end, answering on @p out
+    void run(QIODevice *in, QIODevice *out);
+
+protected:
+    /// @return true if @p job was converted
+    virtual bool convert(const BatchJob &job) = 0;
+};
+
+/**
+ * Reads the lines of the job list in a thread of its own, so the batch
+ * converter keeps watching its workers while it waits for more jobs.
+ */
+class BatchJobReader : public QThread
+{
+    Q_OBJECT
+public:
+    /// @param fileName the job list, or "-" for stdin
+    explicit BatchJobReader(const QString &fileName, QObject *parent = 0);
+
+Q_SIGNALS:
+    void lineRead(const QString &line);
+
+protected:
+    virtual void run();
+
+private:
+    const QString m_fileName;
+};
+
+/**
+ * Converts a list of jobs with a pool of worker processes.
+ *
+ * The workers are instances of this executable started with --worker.
+ * Each of them converts one job after the other, so the application
+ * startup and the plugin scan are paid once per worker and not once per
+ * document. A worker which crashes, runs out of its memory limit or
+ * exceeds the timeout of a job is replaced by a new one.
+ *
+ * The result of every job is written to stdout as a line
+ * "status<TAB>input<TAB>output", status being one of ok, failed, timeout
+ * or crashed.
+ */
+class BatchConverter : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @param jobFile the job list, or "-" for stdin
+     * @param workerArguments the arguments for the worker processes
+     * @param workerCount how many documents are converted in parallel
+     * @param timeout the maximum time for a job in seconds, 0 for none
+     */
+    BatchConverter(const QString &jobFile, const QStringList &workerArguments,
+                   int workerCount, int timeout, QObject *parent = 0);
+    virtual ~BatchConverter();
+
+    /// Sets the device the results are written to, stdout by default
+    void setOutput(QIODevice *output);
+
+    /// Converts all jobs, @return 0 if all of them succeeded, 2 otherwise
+    int exec();
+
+private Q_SLOTS:
+    void addJob(const QString &line);
+    void inputFinished();
+    void readResults();
+    void workerFinished();
+    void jobTimedOut();
+
+private:
+    struct Worker {
+        QProcess *process;
+        QTimer *timer;
+        BatchJob job;
+        bool busy;
+        bool timedOut;
+    };
+
+    Worker *startWorker();
+    Worker *worker(QObject *object) const;
+    void readResults(Worker *worker);
+    void startJob(Worker *worker, const BatchJob &job);
+    void dispatch();
+    void finishJob(Worker *worker, const char *status);
+    void report(const BatchJob &job, const char *status);
+
+    BatchJobReader m_reader;
+    const QStringList m_workerArguments;
+    const int m_workerCount;
+    const int m_timeout;
+    QList<Worker*> m_workers;
+    QQueue<BatchJob> m_pending;
+    bool m_inputDone;
+    bool m_startFailed;
+    int m_failed;
+    QIODevice *m_output;
+    QFile m_stdout;
+    QEventLoop m_loop;
+};
+
+#endif // BATCHCONVERTER_H
@@ -25,6 +25,8 @@
 #include <QCommandLineParser>
 #include <QApplication>
 #include <QDebug>
+#include <QFile>
+#include <QThread>
 
 #include <KAboutData>
 #include <klocalizedstring.h>
@@ -34,11 +36,18 @@
 #include <KoDocumentEntry.h>
 #include <KoDocument.h>
 #include <KoPart.h>
+#include <KoFilterEntry.h>
 #include <KoFilterManager.h>
 #include <KoPrintJob.h>
 #include <KoView.h>
 #include <calligraversion.h>
 
+#include "BatchConverter.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+#include <stdio.h>
 
 bool convertPdf(const QUrl &uIn, const QString &inputFormat, const QUrl &uOut, const QString &outputFormat, const QString &orientation, const QString &papersize, const QString &margin)
 {
@@ -148,6 +157,108 @@ QUrl urlFromFileArg(const QString &file)
     return startsWithProtocol ? QUrl::fromUserInput(file) : QUrl::fromLocalFile(file);
 }
 
+/**
+ * Converts @p urlIn to @p urlOut, to the format @p mimetype or, if that is
+ * empty, the one of @p urlOut. @return the exit code of the conversion
+ */
+int convertFile(const QUrl &urlIn, const QUrl &urlOut, const QString &mimetype, const QCommandLineParser &parser)
+{
+    QMimeDatabase db;
+    QMimeType inputMimetype = db.mimeTypeForUrl(urlIn);
+    if (!inputMimetype.isValid() || inputMimetype.isDefault()) {
+        qCritical() << i18n("Mimetype for input file %1 not found!", urlIn.toDisplayString());
+        return 1;
+    }
+
+    QMimeType outputMimetype;
+    if (!mimetype.isEmpty()) {
+        outputMimetype = db.mimeTypeForName(mimetype);
+        if (! outputMimetype.isValid()) {
+            qCritical() << i18n("Mimetype not found %1", mimetype);
+            return 1;
+        }
+    } else {
+        outputMimetype = db.mimeTypeForUrl(urlOut);
+        if (!outputMimetype.isValid() || outputMimetype.isDefault()) {
+            qCritical() << i18n("Mimetype not found, try using the -mimetype option");
+            return 1;
+        }
+    }
+
+    // Are we in batch mode or in interactive mode.
+    bool batch = parser.isSet("batch");
+    if (parser.isSet("interactive")) {
+        batch = false;
+    }
+
+    QString outputFormat = outputMimetype.name();
+    bool ok = false;
+    if (outputFormat == "application/pdf") {
+        QString orientation = parser.value("print-orientation");
+        QString papersize = parser.value("print-papersize");
+        QString margin = parser.value("print-margin");
+        ok = convertPdf(urlIn, inputMimetype.name(), urlOut, outputFormat, orientation, papersize, margin);
+    } else {
+        ok = convert(urlIn, inputMimetype.name(), urlOut, outputFormat, batch);
+    }
+
+    if (!ok) {
+        qCritical() << i18n("*** The conversion failed! ***");
+        return 2;
+    }
+
+    return 0;
+}
+
+/**
+ * Converts the jobs a BatchConverter writes to stdin with the options of
+ * the worker's own command line.
+ */
+class ConverterWorker : public BatchWorker
+{
+public:
+    explicit ConverterWorker(const QCommandLineParser &parser)
+        : m_parser(parser)
+    {
+    }
+
+protected:
+    virtual bool convert(const BatchJob &job)
+    {
+        return convertFile(urlFromFileArg(job.input), urlFromFileArg(job.output), job.mimetype, m_parser) == 0;
+    }
+
+private:
+    const QCommandLineParser &m_parser;
+};
+
+int runWorker(const QCommandLineParser &parser)
+{
+#ifdef Q_OS_UNIX
+    if (parser.isSet("memory-limit")) {
+        // Allocations beyond the limit fail and end the worker, which the
+        // batch converter then reports and replaces
+        struct rlimit limit;
+        limit.rlim_cur = limit.rlim_max = rlim_t(parser.value("memory-limit").toULongLong()) * 1024 * 1024;
+        if (limit.rlim_cur > 0 && setrlimit(RLIMIT_AS, &limit) != 0) {
+            qWarning() << "Could not set the memory limit";
+        }
+    }
+#endif
+
+    QFile in;
+    QFile out;
+    if (!in.open(stdin, QIODevice::ReadOnly) || !out.open(stdout, QIODevice::WriteOnly)) {
+        return 1;
+    }
+
+    // The filter plugins are scanned once, not for every document
+    KoFilterEntryCache filterEntryCache;
+    ConverterWorker worker(parser);
+    worker.run(&in, &out);
+    return 0;
+}
+
 
 int main(int argc, char **argv)
 {
@@ -182,9 +293,34 @@ int main(int argc, char **argv)
     parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("print-papersize"), i18n("The paper size. A4, Legal, Letter, ..."), QStringLiteral("name")));
     parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("print-margin"), i18n("The size of the paper margin. By default this is 0.2."), QStringLiteral("size")));
 
+    // Batch conversion related options.
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("jobs"), i18n("Convert the jobs listed in file, one per line as input<TAB>output or input<TAB>output<TAB>mimetype. Use - to read them from stdin."), QStringLiteral("file")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("workers"), i18n("The number of documents converted in parallel. By default this is the number of processors."), QStringLiteral("count")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("timeout"), i18n("The maximum time for a job in seconds. By default there is none."), QStringLiteral("seconds")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("memory-limit"), i18n("The maximum memory for a worker in MiB. By default there is none."), QStringLiteral("size")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("worker"), i18n("Internal: convert the jobs written to stdin by --jobs")));
+
     parser.process(app);
     aboutData.processCommandLine(&parser);
 
+    if (parser.isSet("worker")) {
+        return runWorker(parser);
+    }
+
+    if (parser.isSet("jobs")) {
+        // The workers never show dialogs
+        QStringList workerArguments;
+        workerArguments << QStringLiteral("--worker") << QStringLiteral("--batch");
+        foreach (const QString &option, QStringList() << "print-orientation" << "print-papersize" << "print-margin" << "memory-limit") {
+            if (parser.isSet(option)) {
+                workerArguments << QStringLiteral("--") + option << parser.value(option);
+            }
+        }
+        const int workers = parser.isSet("workers") ? parser.value("workers").toInt() : QThread::idealThreadCount();
+        BatchConverter converter(parser.value("jobs"), workerArguments, workers, parser.value("timeout").toInt());
+        return converter.exec();
+    }
+
     const QStringList files = parser.positionalArguments();
     if (files.count() != 2) {
         qCritical() << i18n("Two arguments required");
@@ -194,12 +330,6 @@ int main(int argc, char **argv)
     const QUrl urlIn = urlFromFileArg(files.at(0));
     const QUrl urlOut = urlFromFileArg(files.at(1));
 
-    // Are we in batch mode or in interactive mode.
-    bool batch = parser.isSet("batch");
-    if (parser.isSet("interactive")) {
-        batch = false;
-    }
-
     if (parser.isSet("backup")) {
         // Code form koDocument.cc
         KIO::UDSEntry entry;
@@ -212,52 +342,14 @@ int main(int argc, char **argv)
         }
     }
 
-    QMimeDatabase db;
-    QMimeType inputMimetype = db.mimeTypeForUrl(urlIn);
-    if (!inputMimetype.isValid() || inputMimetype.isDefault()) {
-        qCritical() << i18n("Mimetype for input file %1 not found!", urlIn.toDisplayString());
-        return 1;
-    }
-
-    QMimeType outputMimetype;
-    if (parser.isSet("mimetype")) {
-        QString mime = parser.value("mimetype");
-        outputMimetype = db.mimeTypeForName(mime);
-        if (! outputMimetype.isValid()) {
-            qCritical() << i18n("Mimetype not found %1", mime);
-            return 1;
-        }
-    } else {
-        outputMimetype = db.mimeTypeForUrl(urlOut);
-        if (!outputMimetype.isValid() || outputMimetype.isDefault()) {
-            qCritical() << i18n("Mimetype not found, try using the -mimetype option");
-            return 1;
-        }
-    }
-
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
-    QString outputFormat = outputMimetype.name();
-    bool ok = false;
-    if (outputFormat == "application/pdf") {
-        QString orientation = parser.value("print-orientation");
-        QString papersize = parser.value("print-papersize");
-        QString margin = parser.value("print-margin");
-        ok = convertPdf(urlIn, inputMimetype.name(), urlOut, outputFormat, orientation, papersize, margin);
-    } else {
-        ok = convert(urlIn, inputMimetype.name(), urlOut, outputFormat, batch);
-    }
+    const int result = convertFile(urlIn, urlOut, parser.value("mimetype"), parser);
 
     QTimer::singleShot(0, &app, SLOT(quit()));
     app.exec();
 
     QApplication::restoreOverrideCursor();
 
-    if (!ok) {
-        qCritical() << i18n("*** The conversion failed! ***");
-        return 2;
-    }
-
-    return 0;
+    return result;
 }
-
@@ -0,0 +1,215 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#include "TestBatchConverter.h"
+
+#include <BatchConverter.h>
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QTest>
+#include <QThread>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// The argument BatchConverter starts this executable with as its workers
+static const char fakeWorkerArgument[] = "--fake-worker";
+
+namespace
+{
+
+// Stands in for the conversion, the name of the input tells how it goes
+class FakeWorker : public BatchWorker
+{
+public:
+    QStringList inputs;
+
+protected:
+    virtual bool convert(const BatchJob &job)
+    {
+        inputs << job.input;
+        const QString name = QFileInfo(job.input).baseName();
+        if (name.startsWith(QLatin1String("crash"))) {
+            exit(1);
+        } else if (name.startsWith(QLatin1String("hang"))) {
+            QThread::sleep(60);
+        } else if (name.startsWith(QLatin1String("noisy"))) {
+            // what filters print must not be taken for the answer
+            fputs("Some filter output\n", stdout);
+            fflush(stdout);
+        }
+        return !name.startsWith(QLatin1String("fail"));
+    }
+};
+
+}
+
+void TestBatchConverter::initTestCase()
+{
+    QVERIFY(m_tempDir.isValid());
+}
+
+void TestBatchConverter::testParseJob()
+{
+    BatchJob job;
+    QVERIFY(BatchJob::parse("in.odt\tout.pdf", &job));
+    QCOMPARE(job.input, QString("in.odt"));
+    QCOMPARE(job.output, QString("out.pdf"));
+    QVERIFY(job.mimetype.isEmpty());
+
+    QVERIFY(BatchJob::parse("/tmp/my report.odt\t/tmp/my report.doc\tapplication/msword", &job));
+    QCOMPARE(job.input, QString("/tmp/my report.odt"));
+    QCOMPARE(job.output, QString("/tmp/my report.doc"));
+    QCOMPARE(job.mimetype, QString("application/msword"));
+
+    QVERIFY(!BatchJob::parse(QString(), &job));
+    QVERIFY(!BatchJob::parse("in.odt", &job));
+    QVERIFY(!BatchJob::parse("in.odt out.pdf", &job));
+    QVERIFY(!BatchJob::parse("\tout.pdf", &job));
+    QVERIFY(!BatchJob::parse("in.odt\t", &job));
+    QVERIFY(!BatchJob::parse("in.odt\tout.pdf\tapplication/pdf\textra", &job));
+}
+
+void TestBatchConverter::testJobLine()
+{
+    BatchJob job;
+    job.input = QString::fromUtf8("/tmp/r\xc3\xa9sum\xc3\xa9.odt");
+    job.output = "/tmp/out.pdf";
+    QCOMPARE(job.toLine(), QByteArray("/tmp/r\xc3\xa9sum\xc3\xa9.odt\t/tmp/out.pdf\n"));
+
+    job.mimetype = "application/pdf";
+    QByteArray line = job.toLine();
+    QVERIFY(line.endsWith('\n'));
+    line.chop(1);
+    BatchJob parsed;
+    QVERIFY(BatchJob::parse(QString::fromUtf8(line), &parsed));
+    QCOMPARE(parsed.input, job.input);
+    QCOMPARE(parsed.output, job.output);
+    QCOMPARE(parsed.mimetype, job.mimetype);
+
+    QVERIFY(BatchJob::resultLine(true).endsWith('\n'));
+    QVERIFY(BatchJob::resultLine(true) != BatchJob::resultLine(false));
+}
+
+void TestBatchConverter::testWorkerAnswers()
+{
+    QByteArray input("a.odt\ta.pdf\n"
+                     "not a job\n"
+                     "fail.odt\tfail.pdf\tapplication/pdf\n"
+                     "b.odt\tb.pdf");
+    QBuffer in(&input);
+    QVERIFY(in.open(QIODevice::ReadOnly));
+    QBuffer out;
+    QVERIFY(out.open(QIODevice::WriteOnly));
+
+    FakeWorker worker;
+    worker.run(&in, &out);
+
+    QCOMPARE(worker.inputs, QStringList() << "a.odt" << "fail.odt" << "b.odt");
+    QCOMPARE(out.data(), BatchJob::resultLine(true) + BatchJob::resultLine(false)
+                         + BatchJob::resultLine(false) + BatchJob::resultLine(true));
+}
+
+void TestBatchConverter::testConvertWithWorkers()
+{
+    const QString jobFile = writeJobList("jobs.txt", QStringList()
+                                         << "# a comment"
+                                         << "a.odt\ta.pdf"
+                                         << QString()
+                                         << "noisy.odt\tnoisy.pdf"
+                                         << "b.odt\tb.doc\tapplication/msword"
+                                         << "c.odt\tc.pdf");
+
+    int exitCode = -1;
+    const QStringList results = convert(jobFile, 2, 0, &exitCode);
+    QCOMPARE(exitCode, 0);
+    QCOMPARE(results, QStringList()
+             << "ok\ta.odt\ta.pdf"
+             << "ok\tb.odt\tb.doc"
+             << "ok\tc.odt\tc.pdf"
+             << "ok\tnoisy.odt\tnoisy.pdf");
+}
+
+void TestBatchConverter::testReplaceFailedWorkers()
+{
+    const QString jobFile = writeJobList("failing.txt", QStringList()
+                                         << "crash.odt\tcrash.pdf"
+                                         << "fail.odt\tfail.pdf"
+                                         << "not a job"
+                                         << "hang.odt\thang.pdf"
+                                         << "a.odt\ta.pdf"
+                                         << "b.odt\tb.pdf");
+
+    // the jobs after the crash and the timeout run on new workers
+    int exitCode = -1;
+    const QStringList results = convert(jobFile, 2, 1, &exitCode);
+    QCOMPARE(exitCode, 2);
+    QCOMPARE(results, QStringList()
+             << "crashed\tcrash.odt\tcrash.pdf"
+             << "failed\tfail.odt\tfail.pdf"
+             << "ok\ta.odt\ta.pdf"
+             << "ok\tb.odt\tb.pdf"
+             << "timeout\thang.odt\thang.pdf");
+}
+
+QString TestBatchConverter::writeJobList(const QString &name, const QStringList &lines)
+{
+    const QString fileName = m_tempDir.path() + QLatin1Char('/') + name;
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return QString();
+    }
+    file.write(lines.join(QLatin1String("\n")).toUtf8() + '\n');
+    return fileName;
+}
+
+// @return the sorted result lines, as the workers finish in any order
+QStringList TestBatchConverter::convert(const QString &jobFile, int workerCount, int timeout, int *exitCode)
+{
+    QBuffer output;
+    output.open(QIODevice::WriteOnly);
+    BatchConverter converter(jobFile, QStringList() << QLatin1String(fakeWorkerArgument), workerCount, timeout);
+    converter.setOutput(&output);
+    *exitCode = converter.exec();
+
+    QStringList results = QString::fromUtf8(output.data()).split(QLatin1Char('\n'), QString::SkipEmptyParts);
+    results.sort();
+    return results;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    if (app.arguments().contains(QLatin1String(fakeWorkerArgument))) {
+        QFile in;
+        QFile out;
+        if (!in.open(stdin, QIODevice::ReadOnly) || !out.open(stdout, QIODevice::WriteOnly)) {
+            return 1;
+        }
+        FakeWorker worker;
+        worker.run(&in, &out);
+        return 0;
+    }
+
+    TestBatchConverter test;
+    return QTest::qExec(&test, argc, argv);
+}
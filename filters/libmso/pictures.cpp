@@ -27,6 +27,7 @@
 #include <QDebug>
 #include <QImage>
 #include <QBuffer>
+#include <QSet>
 
 //#define DEBUG_PICTURES
 
@@ -142,6 +143,16 @@ template<class T> void savePicture(PictureReference& ref, const T* a, KoStore* o
     ref.uid = a->rgbUid1 + a->rgbUid2;
     ref.name.clear();
 
+    // a DIB is saved as png
+    const quint16 type = a->rh.recType == officeArtBlipDIB ? officeArtBlipPNG : a->rh.recType;
+    const QString name = ref.uid.toHex() + getSuffix(type);
+    if (out->hasFile(name)) {
+        // the name is the digest of the content, so it was saved before
+        ref.name = name;
+        ref.mimetype = getMimetype(type);
+        return;
+    }
+
     QByteArray imagePixelBytes = a->BLIPFileData;
     if (a->rh.recType == officeArtBlipDIB) {
         // convert to QImage
@@ -161,13 +172,9 @@ template<class T> void savePicture(PictureReference& ref, const T* a, KoStore* o
         }
 
         imagePixelBytes = ba;
-        // save as png
-        ref.name = ref.uid.toHex() + getSuffix(officeArtBlipPNG);
-        ref.mimetype = getMimetype(officeArtBlipPNG);
-    } else {
-        ref.name = ref.uid.toHex() + getSuffix(a->rh.recType);
-        ref.mimetype = getMimetype(a->rh.recType);
     }
+    ref.name = name;
+    ref.mimetype = getMimetype(type);
 
     if (!out->open(ref.name.toLocal8Bit())) {
         ref.name.clear();
@@ -183,6 +190,13 @@ template<class T> void saveDecompressedPicture(PictureReference& ref, const T* a
 {
     if (!a) return;
 
+    ref.uid = a->rgbUid1 + a->rgbUid2;
+    ref.name = ref.uid.toHex() + getSuffix(a->rh.recType);
+    ref.mimetype = getMimetype(a->rh.recType);
+    if (store->hasFile(ref.name)) {
+        return; // saved before, no need to uncompress it again
+    }
+
     QByteArray buff = a->BLIPFileData;
     bool compressed = a->metafileHeader.compression == 0;
 
@@ -202,16 +216,12 @@ template<class T> void saveDecompressedPicture(PictureReference& ref, const T* a
             qDebug() << "Warning: uncompressed size of the metafile differs";
         }
     }
-    //reuse the savePicture code
-    ref.uid = a->rgbUid1 + a->rgbUid2;
-    ref.name = ref.uid.toHex() + getSuffix(a->rh.recType);
     if (!store->open(ref.name.toLocal8Bit())) {
         ref.name.clear();
         ref.uid.clear();
         return; // empty name reports an error
     }
     store->write(buff.data(), buff.size());
-    ref.mimetype = getMimetype(a->rh.recType);
     store->close();
 }
 
@@ -286,12 +296,16 @@ PictureReference savePicture(POLE::Stream& stream, KoStore* out)
     }
     ref.uid = QByteArray((const char*)buffer, 16);
     ref.name = ref.uid.toHex() + namesuffix;
+    unsigned long next = stream.tell() + size;
+    if (out->hasFile(ref.name)) {
+        stream.seek(next); // saved before
+        return ref;
+    }
     if (!out->open(ref.name.toLocal8Bit())) {
         ref.name.clear();
         ref.uid.clear();
         return ref; // empty name reports an error
     }
-    unsigned long next = stream.tell() + size;
     if (compressed) {
         saveDecompressedStream(stream, size, out);
     } else {
@@ -352,6 +366,7 @@ QMap<QByteArray, QString> createPictures(KoStore* store, KoXmlWriter* manifest,
 {
     PictureReference ref;
     QMap<QByteArray, QString> fileNames;
+    QSet<QString> savedNames;
 
     if (!rgfb) return fileNames;
 
@@ -372,9 +387,11 @@ QMap<QByteArray, QString> createPictures(KoStore* store, KoXmlWriter* manifest,
             }
         }
 
-        if (manifest) {
+        // a picture stored more than once is saved once
+        if (manifest && !savedNames.contains(ref.name)) {
             manifest->addManifestEntry("Pictures/" + ref.name, ref.mimetype);
         }
+        savedNames.insert(ref.name);
 
         fileNames[ref.uid] = ref.name;
     }
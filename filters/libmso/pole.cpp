@@ -29,7 +29,7 @@
 
 #include "pole.h"
 
-#include <fstream>
+#include <algorithm>
 #include <iostream>
 #include <list>
 #include <string>
@@ -37,6 +37,8 @@
 #include <string.h>
 #include <ios>       // for std::hex
 
+#include <QByteArray>
+#include <QFile>
 #include <QList>
 #include <QString>
 #include <QDebug>
@@ -158,11 +160,16 @@ class StorageIO
 public:
     Storage* storage;         // owner
     std::string filename;     // filename
-    std::fstream file;        // associated with above name
+    QFile file;               // associated with above name
     int result;               // result of operation
     bool opened;              // true if file is opened
     unsigned long filesize;   // size of the file
 
+    // the whole file, mapped into memory or, if that fails, read into contents
+    const unsigned char* filedata;
+    unsigned char* mapped;
+    QByteArray contents;
+
     Header* header;           // storage header
     DirTree* dirtree;         // directory tree
     AllocTable* bbat;         // allocation table for big blocks
@@ -218,10 +225,16 @@ public:
     unsigned long read(unsigned char* data, unsigned long maxlen);
 
 private:
-    unsigned long readInternal(unsigned char* data, unsigned long maxlen);
-    unsigned long readInternal(unsigned long pos, unsigned char* data, unsigned long maxlen);
+    // a run of the stream stored contiguously in the file
+    struct Extent {
+        unsigned long pos;    // position in the stream
+        unsigned long offset; // position in the file
+        unsigned long length;
+    };
 
-    std::vector<unsigned long> blocks;
+    const Extent* extentAt(unsigned long pos);
+
+    std::vector<Extent> extents;
 
     // no copy or assign
     StreamIO(const StreamIO&);
@@ -230,12 +243,8 @@ private:
     // pointer for read
     unsigned long m_pos;
 
-    // simple cache system to speed-up getch()
-    unsigned char* cache_data;
-    unsigned long base_cache_size;
-    unsigned long cache_size;
-    unsigned long cache_pos;
-    void updateCache();
+    // the extent of the last access, sequential reads mostly stay in it
+    unsigned long m_extent;
 };
 
 } // namespace POLE
@@ -1128,6 +1137,8 @@ StorageIO::StorageIO(Storage* st, const char* fname)
     sbat = new AllocTable();
 
     filesize = 0;
+    filedata = 0;
+    mapped = 0;
     bbat->blockSize = 1 << header->b_shift;
     sbat->blockSize = 1 << header->s_shift;
 }
@@ -1144,7 +1155,7 @@ StorageIO::~StorageIO()
 bool StorageIO::open()
 {
     // already opened ? close first
-    if (opened) close();
+    close();
 
     load();
 
@@ -1159,23 +1170,29 @@ void StorageIO::load()
 
     // open the file, check for error
     result = Storage::OpenFailed;
-    file.open(filename.c_str(), std::ios::binary | std::ios::in);
-    if (!file.good()) return;
+    file.setFileName(QFile::decodeName(filename.c_str()));
+    if (!file.open(QIODevice::ReadOnly)) return;
 
     // find size of input file
-    file.seekg(0, std::ios::end);
-    filesize = file.tellg();
+    filesize = file.size();
 
-    // load header
-    buffer = new unsigned char[OLE_HEADER_SIZE];
-    file.seekg(0);
-    file.read((char*)buffer, OLE_HEADER_SIZE);
-    if (!file.good()) {
-        delete[] buffer;
-        return;
+    // blocks are then copied straight from memory instead of being seeked
+    // to and read one by one
+    mapped = file.map(0, filesize);
+    if (mapped) {
+        filedata = mapped;
+    } else {
+        contents = file.readAll();
+        if ((unsigned long)contents.size() != filesize) {
+            contents.clear();
+            return;
+        }
+        filedata = reinterpret_cast<const unsigned char*>(contents.constData());
     }
-    header->load(buffer);
-    delete[] buffer;
+
+    // load header
+    if (filesize < OLE_HEADER_SIZE) return;
+    header->load(filedata);
 
     // check OLE magic id
     result = Storage::NotOLE;
@@ -1301,8 +1318,8 @@ void StorageIO::create()
 {
     // std::cout << "Creating " << filename << std::endl;
 
-    file.open(filename.c_str(), std::ios::out | std::ios::binary);
-    if (!file.good()) {
+    file.setFileName(QFile::decodeName(filename.c_str()));
+    if (!file.open(QIODevice::WriteOnly)) {
         qCritical() << Q_FUNC_INFO << "Can't create file:" << filename.c_str();
         result = Storage::OpenFailed;
         return;
@@ -1324,9 +1341,15 @@ void StorageIO::flush()
 
 void StorageIO::close()
 {
+    // a failed load leaves the file open too
+    if (mapped) file.unmap(mapped);
+    mapped = 0;
+    contents.clear();
+    filedata = 0;
+    file.close();
+
     if (!opened) return;
 
-    file.close();
     opened = false;
 
     std::list<Stream*>::iterator it;
@@ -1366,21 +1389,20 @@ unsigned long StorageIO::loadBigBlocks(const unsigned long *blocks, unsigned blo
 {
     // sentinel
     if (!data) return 0;
-    if (!file.good()) return 0;
+    if (!filedata) return 0;
     if (!blocks) return 0;
     if (blockCount < 1) return 0;
     if (maxlen == 0) return 0;
 
-    // read block one by one, seems fast enough
+    // copy block one by one, the file is in memory
     unsigned long bytes = 0;
     for (unsigned long i = 0; (i < blockCount) && (bytes < maxlen); i++) {
         unsigned long block = blocks[i];
         unsigned long pos =  bbat->blockSize * (block + 1);
+        if (pos > filesize) return 0;
         unsigned long p = (bbat->blockSize < maxlen - bytes) ? bbat->blockSize : maxlen - bytes;
         if (pos + p > filesize) p = filesize - pos;
-        file.seekg(pos);
-        file.read((char*)data + bytes, p);
-        if (!file.good()) return 0;
+        memcpy(data + bytes, filedata + pos, p);
         bytes += p;
     }
 
@@ -1392,7 +1414,7 @@ unsigned long StorageIO::loadBigBlock(unsigned long block,
 {
     // sentinel
     if (!data) return 0;
-    if (!file.good()) return 0;
+    if (!filedata) return 0;
 
     return loadBigBlocks(&block, 1, data, maxlen);
 }
@@ -1409,15 +1431,12 @@ unsigned long StorageIO::loadSmallBlocks(const unsigned long *blocks, unsigned b
 {
     // sentinel
     if (!data) return 0;
-    if (!file.good()) return 0;
+    if (!filedata) return 0;
     if (!blocks) return 0;
     if (blockCount < 1) return 0;
     if (maxlen == 0) return 0;
 
-    // our own local buffer
-    unsigned char* buf = new unsigned char[ bbat->blockSize ];
-
-    // read small block one by one
+    // copy small block one by one
     unsigned long bytes = 0;
     for (unsigned long i = 0; (i < blockCount) && (bytes < maxlen); i++) {
         unsigned long block = blocks[i];
@@ -1427,22 +1446,18 @@ unsigned long StorageIO::loadSmallBlocks(const unsigned long *blocks, unsigned b
         unsigned long bbindex = pos / bbat->blockSize;
         if (bbindex >= sb_blocks.size()) break;
 
-        unsigned long r = loadBigBlock(sb_blocks[ bbindex ], buf, bbat->blockSize);
-        if (r != bbat->blockSize) {
-            delete[] buf;
-            return 0;
-        }
+        // the big block holding it must be complete
+        unsigned long bbpos = bbat->blockSize * (sb_blocks[ bbindex ] + 1);
+        if (bbpos + bbat->blockSize > filesize) return 0;
 
         // copy the data
         unsigned offset = pos % bbat->blockSize;
         unsigned long p = (maxlen - bytes < bbat->blockSize - offset) ? maxlen - bytes :  bbat->blockSize - offset;
         p = (sbat->blockSize < p) ? sbat->blockSize : p;
-        memcpy(data + bytes, buf + offset, p);
+        memcpy(data + bytes, filedata + bbpos + offset, p);
         bytes += p;
     }
 
-    delete[] buf;
-
     return bytes;
 }
 
@@ -1451,7 +1466,7 @@ unsigned long StorageIO::loadSmallBlock(unsigned long block,
 {
     // sentinel
     if (!data) return 0;
-    if (!file.good()) return 0;
+    if (!filedata) return 0;
 
     return loadSmallBlocks(&block, 1, data, maxlen);
 }
@@ -1466,24 +1481,51 @@ StreamIO::StreamIO(StorageIO* s, DirEntry* e)
     fail = false;
 
     m_pos = 0;
+    m_extent = 0;
 
-    if (entry->size >= io->header->threshold) {
-        blocks = io->bbat->follow(entry->start, fail);
-    } else {
+    const bool small = entry->size < io->header->threshold;
+    std::vector<unsigned long> blocks;
+    if (small) {
         blocks = io->sbat->follow(entry->start, fail);
+    } else {
+        blocks = io->bbat->follow(entry->start, fail);
     }
 
-    // prepare cache
-    cache_pos = 0;
-    base_cache_size = cache_size = 4096; // optimal ?
-    cache_data = new unsigned char[base_cache_size];
-    updateCache();
+    // Resolve the block chain to file offsets once, merging blocks which
+    // follow each other in the file, so reads become plain copies from the
+    // file data.  Blocks past the end of the file end the stream.
+    const unsigned long bigSize = io->bbat->blockSize;
+    const unsigned long blockSize = small ? io->sbat->blockSize : bigSize;
+    unsigned long pos = 0;
+    for (unsigned long i = 0; (i < blocks.size()) && (pos < entry->size); i++) {
+        unsigned long offset;
+        if (small) {
+            // small blocks are stored in the big blocks of the root entry
+            const unsigned long sbpos = blocks[i] * blockSize;
+            const unsigned long bbindex = sbpos / bigSize;
+            if (bbindex >= io->sb_blocks.size()) break;
+            offset = bigSize * (io->sb_blocks[ bbindex ] + 1) + sbpos % bigSize;
+        } else {
+            offset = bigSize * (blocks[i] + 1);
+        }
+        if (offset >= io->filesize) break;
+
+        const unsigned long wanted = std::min(blockSize, entry->size - pos);
+        const unsigned long length = std::min(wanted, io->filesize - offset);
+        if (!extents.empty() && (extents.back().offset + extents.back().length == offset)) {
+            extents.back().length += length;
+        } else {
+            Extent extent = { pos, offset, length };
+            extents.push_back(extent);
+        }
+        pos += length;
+        if (length < wanted) break;
+    }
 }
 
 // FIXME tell parent we're gone
 StreamIO::~StreamIO()
 {
-    delete[] cache_data;
 }
 
 void StreamIO::seek(unsigned long pos)
@@ -1496,20 +1538,50 @@ unsigned long StreamIO::tell()
     return m_pos;
 }
 
-int StreamIO::getch()
+const StreamIO::Extent* StreamIO::extentAt(unsigned long pos)
 {
-    // past end-of-file ?
-    if (m_pos > entry->size) return -1;
+    // the storage was closed
+    if (!io->filedata) return 0;
+
+    if (m_extent < extents.size()) {
+        const Extent& extent = extents[m_extent];
+        if ((pos >= extent.pos) && (pos - extent.pos < extent.length))
+            return &extent;
+        // crossing into the next extent
+        if ((m_extent + 1 < extents.size()) && (pos == extent.pos + extent.length)) {
+            m_extent++;
+            return &extents[m_extent];
+        }
+    }
+
+    // find the last extent starting at or before pos
+    unsigned long first = 0;
+    unsigned long count = extents.size();
+    while (count > 0) {
+        unsigned long step = count / 2;
+        if (extents[first + step].pos <= pos) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    if (first == 0) return 0;
 
-    // need to update cache ?
-    if (!cache_size || (m_pos < cache_pos) ||
-            (m_pos >= cache_pos + cache_size))
-        updateCache();
+    const Extent& extent = extents[first - 1];
+    if (pos - extent.pos >= extent.length) return 0;
+    m_extent = first - 1;
+    return &extent;
+}
 
-    // something bad if we don't get good cache
-    if (!cache_size) return -1;
+int StreamIO::getch()
+{
+    const Extent* extent = extentAt(m_pos);
+
+    // past end-of-file ?
+    if (!extent) return -1;
 
-    int data = cache_data[m_pos - cache_pos];
+    int data = io->filedata[extent->offset + m_pos - extent->pos];
     m_pos++;
 
     return data;
@@ -1524,97 +1596,18 @@ unsigned long StreamIO::read(unsigned char *data, unsigned long maxlen)
     unsigned long totalbytes = 0;
 
     while (totalbytes < maxlen) {
-        // need to update cache ?
-        if (!cache_size || (m_pos < cache_pos) ||
-                (m_pos >= cache_pos + cache_size))
-            updateCache();
-        if (!cache_size) break;
-
-        const unsigned long remaining = cache_size - (m_pos - cache_pos);
-        const unsigned long count = std::min(remaining, maxlen - totalbytes);
-        memcpy(data + totalbytes, &cache_data[m_pos - cache_pos], count);
+        const Extent* extent = extentAt(m_pos);
+        if (!extent) break;
+
+        const unsigned long offset = m_pos - extent->pos;
+        const unsigned long count = std::min(extent->length - offset, maxlen - totalbytes);
+        memcpy(data + totalbytes, io->filedata + extent->offset + offset, count);
         totalbytes += count;
         m_pos += count;
     }
     return totalbytes;
 }
 
-unsigned long StreamIO::readInternal(unsigned long pos, unsigned char* data, unsigned long maxlen)
-{
-    // sanity checks
-    if (!data) return 0;
-    if (maxlen == 0) return 0;
-
-    unsigned long totalbytes = 0;
-
-    if (entry->size < io->header->threshold) {
-        // small file
-        unsigned long index = pos / io->sbat->blockSize;
-
-        if (index >= blocks.size()) return 0;
-
-        unsigned char buf[4096];
-        unsigned long offset = pos % io->sbat->blockSize;
-        while (totalbytes < maxlen) {
-            if (index >= blocks.size()) break;
-            io->loadSmallBlock(blocks[index], &buf[0], io->bbat->blockSize);
-            unsigned long count = io->sbat->blockSize - offset;
-            if (count > maxlen - totalbytes) count = maxlen - totalbytes;
-            memcpy(data + totalbytes, &buf[0] + offset, count);
-            totalbytes += count;
-            offset = 0;
-            index++;
-        }
-
-    } else {
-        // big file
-        unsigned long index = pos / io->bbat->blockSize;
-
-        if (index >= blocks.size()) return 0;
-
-        unsigned char buf[4096];
-        unsigned long offset = pos % io->bbat->blockSize;
-        while (totalbytes < maxlen) {
-            if (index >= blocks.size()) break;
-            unsigned long r = io->loadBigBlock(blocks[index], &buf[0], io->bbat->blockSize);
-            if (r != io->bbat->blockSize) {
-                return 0;
-            }
-            unsigned long count = io->bbat->blockSize - offset;
-            if (count > maxlen - totalbytes) count = maxlen - totalbytes;
-            memcpy(data + totalbytes, &buf[0] + offset, count);
-            totalbytes += count;
-            index++;
-            offset = 0;
-        }
-
-    }
-
-    return totalbytes;
-}
-
-unsigned long StreamIO::readInternal(unsigned char* data, unsigned long maxlen)
-{
-    unsigned long bytes = readInternal(tell(), data, maxlen);
-    m_pos += bytes;
-    return bytes;
-}
-
-void StreamIO::updateCache()
-{
-    // sanity check
-    if (!cache_data) return;
-
-    cache_pos = m_pos - (m_pos % base_cache_size);
-    unsigned long bytes = base_cache_size;
-    if (cache_pos + bytes > entry->size) bytes = entry->size - cache_pos;
-    if (cache_pos + bytes <= m_pos) {
-        cache_size = 0;
-    } else {
-        cache_size = readInternal(cache_pos, cache_data, bytes);
-    }
-}
-
 
 // =========== Storage ==========
 
@@ -23,6 +23,7 @@
 
 #include <QBuffer>
 #include <QByteArray>
+#include <QTemporaryFile>
 
 #include "MsooXmlDebug.h"
 
@@ -109,8 +110,16 @@ KoFilter::ConversionStatus KoOdfExporter::convert(const QByteArray& from, const
     QBuffer contentBuf;
     KoXmlWriter contentWriter(&contentBuf);
     writers.content = &contentWriter;
-    QBuffer bodyBuf;
-    KoXmlWriter bodyWriter(&bodyBuf);
+    //the body is streamed to a file as it is converted, so that large
+    //documents do not have to fit into memory; it can only be copied to
+    //content.xml at the end, after the automatic styles it uses
+    QTemporaryFile bodyFile;
+    if (!bodyFile.open()) {
+        warnMsooXml << "Unable to open the temporary body file!";
+        delete outputStore;
+        return KoFilter::CreationError;
+    }
+    KoXmlWriter bodyWriter(&bodyFile);
     writers.body = &bodyWriter;
 
     // open main tags
@@ -142,7 +151,8 @@ KoFilter::ConversionStatus KoOdfExporter::convert(const QByteArray& from, const
         delete outputStore;
         return KoFilter::CreationError;
     }
-    realBodyWriter->addCompleteElement(&bodyBuf);
+    bodyFile.close(); // does not really close but seeks to the beginning of the file
+    realBodyWriter->addCompleteElement(&bodyFile);
 
     //now close content & body writers
     if (!oasisStore.closeContentWriter()) {
@@ -0,0 +1,134 @@
+/*
+ * This file is part of Office 2007 Filters for Calligra
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include "MsooXmlFileCopier.h"
+#include "MsooXmlDebug.h"
+
+#include <QCryptographicHash>
+#include <QScopedPointer>
+
+#include <KoStore.h>
+
+#include <klocalizedstring.h>
+#include <kzip.h>
+
+using namespace MSOOXML;
+
+static const int BlockSize = 4096;
+
+/**
+ * Reads @a file block by block, adding the blocks to @a hash and writing
+ * them to the open entry of @a store if it is given.
+ * @return false if the file could not be read or written completely.
+ */
+static bool transfer(const KZipFileEntry *file, QCryptographicHash *hash, KoStore *store)
+{
+    QScopedPointer<QIODevice> device(file->createDevice());
+    if (!device) {
+        return false;
+    }
+    char block[BlockSize];
+    qint64 size = 0;
+    while (true) {
+        const qint64 in = device->read(block, BlockSize);
+        if (in < 0) {
+            return false;
+        }
+        if (in == 0) {
+            break;
+        }
+        hash->addData(block, in);
+        if (store && store->write(block, in) != in) {
+            return false;
+        }
+        size += in;
+    }
+    return size == file->size();
+}
+
+MsooXmlFileCopier::MsooXmlFileCopier(const KZip *zip, KoStore *store)
+    : m_zip(zip)
+    , m_store(store)
+{
+}
+
+KoFilter::ConversionStatus MsooXmlFileCopier::copyFile(const QString &sourceName,
+        QString &destinationName, QString &errorMessage)
+{
+    errorMessage.clear();
+    const QHash<QString, QString>::ConstIterator copied(m_copiedFiles.constFind(sourceName));
+    if (copied != m_copiedFiles.constEnd()) {
+        destinationName = copied.value();
+        return KoFilter::OK;
+    }
+    if (m_store->hasFile(destinationName)) {
+        return KoFilter::OK;
+    }
+
+    const KArchiveEntry *entry = m_zip->directory()->entry(sourceName);
+    if (!entry) {
+        errorMessage = i18n("Entry '%1' not found.", sourceName);
+        return KoFilter::FileNotFound;
+    }
+    if (!entry->isFile()) {
+        errorMessage = i18n("Entry '%1' is not a file.", sourceName);
+        return KoFilter::WrongFormat;
+    }
+    const KZipFileEntry *file = static_cast<const KZipFileEntry*>(entry);
+
+    // The same picture is often stored under several names, e.g. once per
+    // slide layout. Only a file with a known checksum can be such a copy.
+    const Checksum checksum(file->crc32(), file->size());
+    QByteArray digest;
+    if (m_checksums.contains(checksum)) {
+        QCryptographicHash hash(QCryptographicHash::Md5);
+        if (!transfer(file, &hash, 0)) {
+            errorMessage = i18n("Could not read entry '%1'.", sourceName);
+            return KoFilter::FileNotFound;
+        }
+        digest = hash.result();
+        const QHash<QByteArray, QString>::ConstIterator stored(m_copiedContents.constFind(digest));
+        if (stored != m_copiedContents.constEnd()) {
+            debugMsooXml << sourceName << "has the content of" << stored.value();
+            destinationName = stored.value();
+            m_copiedFiles.insert(sourceName, destinationName);
+            return KoFilter::OK;
+        }
+    }
+
+    if (!m_store->open(destinationName)) {
+        errorMessage = i18n("Could not open entry \"%1\" for writing.", destinationName);
+        return KoFilter::CreationError;
+    }
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    const bool written = transfer(file, &hash, m_store);
+    m_store->close();
+    if (!written) {
+        errorMessage = i18n("Could not write block");
+        return KoFilter::CreationError;
+    }
+    if (digest.isEmpty()) {
+        digest = hash.result();
+    }
+
+    m_copiedFiles.insert(sourceName, destinationName);
+    m_copiedContents.insert(digest, destinationName);
+    m_checksums.insert(checksum);
+    return KoFilter::OK;
+}
@@ -0,0 +1,76 @@
+/*
+ * This file is part of Office 2007 Filters for Calligra
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#ifndef MSOOXMLFILECOPIER_H
+#define MSOOXMLFILECOPIER_H
+
+#include "komsooxml_export.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QPair>
+#include <QSet>
+#include <QString>
+
+#include <KoFilter.h>
+
+class KZip;
+class KZipFileEntry;
+class KoStore;
+
+namespace MSOOXML
+{
+
+/**
+ * Copies files of the input archive to the output store, storing each
+ * content once.
+ *
+ * A file whose content was copied before, under whatever name, is not
+ * written again; the name of the earlier copy is handed back instead.
+ * Contents are compared by their MD5 digest. Files are streamed block by
+ * block, and a file is only read twice if the checksum and size the zip
+ * directory records for it match those of a file copied before.
+ */
+class KOMSOOXML_EXPORT MsooXmlFileCopier
+{
+public:
+    MsooXmlFileCopier(const KZip *zip, KoStore *store);
+
+    /**
+     * Copies the file @a sourceName of the archive to @a destinationName in
+     * the store. If the same content was copied before, @a destinationName
+     * is set to the name of that copy and nothing is written.
+     * @return KoFilter::OK on success; on failure @a errorMessage is set.
+     */
+    KoFilter::ConversionStatus copyFile(const QString &sourceName, QString &destinationName,
+                                        QString &errorMessage);
+
+private:
+    typedef QPair<quint32, qint64> Checksum; //!< the crc32 and size of a file
+
+    const KZip *m_zip;
+    KoStore *m_store;
+    QHash<QString, QString> m_copiedFiles; //!< destination names of the copied files, by source name
+    QHash<QByteArray, QString> m_copiedContents; //!< destination names of the copied files, by digest
+    QSet<Checksum> m_checksums; //!< of the copied files
+};
+
+} // namespace MSOOXML
+
+#endif
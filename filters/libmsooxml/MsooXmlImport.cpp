@@ -30,6 +30,8 @@
 #include "MsooXmlContentTypes.h"
 #include "MsooXmlRelationships.h"
 #include "MsooXmlTheme.h"
+#include "MsooXmlPartPrefetcher.h"
+#include "MsooXmlFileCopier.h"
 #include "ooxml_pole.h"
 
 #include <QColor>
@@ -41,6 +43,7 @@
 #include <QInputDialog>
 #include <QImageReader>
 #include <QFileInfo>
+#include <QBuffer>
 
 #include "MsooXmlDebug.h"
 #include <kzip.h>
@@ -69,6 +72,8 @@ using namespace MSOOXML;
 MsooXmlImport::MsooXmlImport(const QString& bodyContentElement, QObject* parent)
         : KoOdfExporter(bodyContentElement, parent),
         m_zip(0),
+        m_prefetcher(0),
+        m_fileCopier(0),
         m_outputStore(0)
 {
 }
@@ -146,6 +151,10 @@ KoFilter::ConversionStatus MsooXmlImport::createDocument(KoStore *outputStore,
 
     status = openFile(writers, errorMessage);
 
+    delete m_prefetcher;
+    m_prefetcher = 0;
+    delete m_fileCopier;
+    m_fileCopier = 0;
     m_zip = 0; // clear context
     m_outputStore = 0; // clear context
 
@@ -571,14 +580,21 @@ KoFilter::ConversionStatus MsooXmlImport::createImage(const QImage& source,
 }
 
 KoFilter::ConversionStatus MsooXmlImport::copyFile(const QString& sourceName,
-        const QString& destinationName, bool oleFile)
+        QString& destinationName, bool oleFile)
 {
     if (!m_zip || !m_outputStore) {
         return KoFilter::UsageError;
     }
     QString errorMessage;
-    const KoFilter::ConversionStatus status = Utils::copyFile(
-                m_zip, errorMessage, sourceName, m_outputStore, destinationName, oleFile);
+    KoFilter::ConversionStatus status;
+    if (oleFile) {
+        status = Utils::copyFile(m_zip, errorMessage, sourceName, m_outputStore, destinationName, oleFile);
+    } else {
+        if (!m_fileCopier) {
+            m_fileCopier = new MsooXmlFileCopier(m_zip, m_outputStore);
+        }
+        status = m_fileCopier->copyFile(sourceName, destinationName, errorMessage);
+    }
 //! @todo transmit the error to the GUI...
     if(status != KoFilter::OK)
         warnMsooXml << "Failed to copyFile:" << errorMessage;
@@ -661,8 +677,10 @@ KoFilter::ConversionStatus MsooXmlImport::loadAndParseDocumentFromFileInternal(
     if (!m_zip) {
         return KoFilter::UsageError;
     }
-    KoFilter::ConversionStatus status = Utils::loadAndParseDocument(
-               reader, m_zip, writers, errorMessage, fileName, context);
+    KoFilter::ConversionStatus status;
+    if (!loadAndParsePrefetchedDocument(reader, fileName, errorMessage, context, &status)) {
+        status = Utils::loadAndParseDocument(reader, m_zip, writers, errorMessage, fileName, context);
+    }
     *pathFound = status != KoFilter::FileNotFound;
     return status;
 }
@@ -719,8 +737,10 @@ KoFilter::ConversionStatus MsooXmlImport::loadAndParseDocument(
         return KoFilter::UsageError;
     }
     QString errorMessage;
-    KoFilter::ConversionStatus status = Utils::loadAndParseDocument(
-                                            reader, m_zip, reader, errorMessage, path, context);
+    KoFilter::ConversionStatus status;
+    if (!loadAndParsePrefetchedDocument(reader, path, errorMessage, context, &status)) {
+        status = Utils::loadAndParseDocument(reader, m_zip, reader, errorMessage, path, context);
+    }
     if (status != KoFilter::OK)
         reader->raiseError(errorMessage);
     return status;
@@ -733,11 +753,46 @@ KoFilter::ConversionStatus MsooXmlImport::loadAndParseDocument(
     if (!m_zip) {
         return KoFilter::UsageError;
     }
-    KoFilter::ConversionStatus status = Utils::loadAndParseDocument(
-                                            reader, m_zip, reader, errorMessage, path, context);
+    KoFilter::ConversionStatus status;
+    if (!loadAndParsePrefetchedDocument(reader, path, errorMessage, context, &status)) {
+        status = Utils::loadAndParseDocument(reader, m_zip, reader, errorMessage, path, context);
+    }
     return status;
 }
 
+void MsooXmlImport::prefetchParts(const QStringList& paths)
+{
+    if (!m_zip) {
+        return;
+    }
+    if (!m_prefetcher) {
+        m_prefetcher = new MsooXmlPartPrefetcher(m_zip);
+    }
+    m_prefetcher->prefetch(paths);
+}
+
+// private
+bool MsooXmlImport::loadAndParsePrefetchedDocument(MsooXmlReader *reader, const QString& path,
+    QString& errorMessage, MsooXmlReaderContext* context, KoFilter::ConversionStatus *status)
+{
+    QByteArray data;
+    if (!m_prefetcher || !m_prefetcher->fetch(path, &data)) {
+        return false;
+    }
+    errorMessage.clear();
+    QBuffer device(&data);
+    device.open(QIODevice::ReadOnly);
+    reader->setDevice(&device);
+    reader->setFileName(path); // for error reporting
+    *status = reader->read(context);
+    if (*status != KoFilter::OK) {
+        errorMessage = reader->errorString();
+    } else {
+        debugMsooXml << "File" << path << "loaded and parsed.";
+    }
+    return true;
+}
+
 KoFilter::ConversionStatus MsooXmlImport::loadAndParseFromDevice(MsooXmlReader* reader, QIODevice* device,
         MsooXmlReaderContext* context)
 {
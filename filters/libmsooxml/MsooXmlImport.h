@@ -30,6 +30,7 @@
 
 #include <QByteArray>
 #include <QHash>
+#include <QStringList>
 #include <QVariant>
 
 #include <KoBorder.h>
@@ -49,6 +50,8 @@ namespace MSOOXML
 class MsooXmlReader;
 class MsooXmlReaderContext;
 class MsooXmlRelationships;
+class MsooXmlPartPrefetcher;
+class MsooXmlFileCopier;
 
 //! A base class for MSOOXML-to-ODF import filters
 class KOMSOOXML_EXPORT MsooXmlImport : public KoOdfExporter
@@ -72,6 +75,13 @@ public:
             QString& errorMessage,
             MsooXmlReaderContext* context = 0);
 
+    /*! Starts inflating the parts @a paths of the input archive in the background,
+    in the order they are going to be loaded with loadAndParseDocument() or its variants.
+    Each part is then inflated only once, even if it is parsed more than once,
+    and it is kept until a part queued after it is loaded.
+    Does nothing if called outside of the importing process. */
+    void prefetchParts(const QStringList& paths);
+
     //! Loads a file from a device
     KoFilter::ConversionStatus loadAndParseFromDevice(MsooXmlReader* reader, QIODevice* device,
             MsooXmlReaderContext* context);
@@ -79,10 +89,12 @@ public:
     /*! Copies file @a sourceName from the input archive to the output document
     under @a destinationName name. @return KoFilter::OK on success.
     On failure @a errorMessage is set.
+    Each content is stored once: if a file with the same content was copied
+    before, @a destinationName is set to the name it was stored under.
     KoFilter::UsageError is returned if this method is called outside
     of the importing process, i.e. not from within parseParts(). */
     KoFilter::ConversionStatus copyFile(const QString& sourceName,
-                                        const QString& destinationName,
+                                        QString& destinationName,
                                         bool oleFile);
 
     /* Creates an image to the resulting odf with the given name */
@@ -165,8 +177,16 @@ private:
         const QString& fileName, MsooXmlReader *reader, KoOdfWriters *writers,
         QString& errorMessage, MsooXmlReaderContext* context, bool *pathFound);
 
+    //! Parses @a path if it was prefetched, @return false if it was not.
+    bool loadAndParsePrefetchedDocument(MsooXmlReader *reader, const QString& path,
+        QString& errorMessage, MsooXmlReaderContext* context, KoFilter::ConversionStatus *status);
+
     KZip* m_zip; //!< Input zip file
 
+    MsooXmlPartPrefetcher* m_prefetcher; //!< parts inflated ahead, see prefetchParts()
+
+    MsooXmlFileCopier* m_fileCopier; //!< stores each copied content once, see copyFile()
+
     KoStore* m_outputStore; //!< output store used for copying files
 
     //! XML from "[Content_Types].xml" file.
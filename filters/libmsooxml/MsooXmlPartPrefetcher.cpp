@@ -0,0 +1,200 @@
+/*
+ * This file is part of Office 2007 Filters for Calligra
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include "MsooXmlPartPrefetcher.h"
+#include "MsooXmlDebug.h"
+
+#include <QBuffer>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+
+#include <KCompressionDevice>
+#include <kzip.h>
+
+using namespace MSOOXML;
+
+// zip compression methods, see the PKWARE APPNOTE
+static const int ZipStored = 0;
+static const int ZipDeflated = 8;
+
+class MsooXmlPartPrefetcher::InflateJob : public QRunnable
+{
+public:
+    InflateJob(MsooXmlPartPrefetcher *prefetcher, Part *part)
+        : m_prefetcher(prefetcher), m_part(part)
+    {
+    }
+
+    virtual void run()
+    {
+        // m_part->raw is not touched by the owning thread once the job started
+        const bool ok = MsooXmlPartPrefetcher::inflate(m_part);
+
+        QMutexLocker locker(&m_prefetcher->m_mutex);
+        m_part->raw.clear();
+        m_part->ok = ok;
+        m_part->done = true;
+        if (m_part->released || !ok) {
+            m_part->data.clear();
+        }
+        m_prefetcher->m_partDone.wakeAll();
+    }
+
+private:
+    MsooXmlPartPrefetcher *m_prefetcher;
+    Part *m_part;
+};
+
+const qint64 MsooXmlPartPrefetcher::DefaultMemoryBudget;
+
+MsooXmlPartPrefetcher::MsooXmlPartPrefetcher(const KZip *zip, qint64 memoryBudget)
+    : m_zip(zip)
+    , m_first(0)
+    , m_memoryBudget(memoryBudget)
+{
+    const int threads = qMax(1, QThread::idealThreadCount());
+    m_pool.setMaxThreadCount(threads);
+    m_window = qMax(2, 2 * threads);
+}
+
+MsooXmlPartPrefetcher::~MsooXmlPartPrefetcher()
+{
+    m_pool.waitForDone();
+    qDeleteAll(m_parts);
+}
+
+void MsooXmlPartPrefetcher::prefetch(const QStringList &paths)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        foreach (const QString &path, paths) {
+            if (m_indexes.contains(path)) {
+                continue;
+            }
+            Part *part = new Part;
+            part->path = path;
+            m_indexes.insert(path, m_parts.count());
+            m_parts.append(part);
+        }
+    }
+    startJobs();
+}
+
+bool MsooXmlPartPrefetcher::fetch(const QString &path, QByteArray *data)
+{
+    const int index = m_indexes.value(path, -1);
+    if (index < m_first) {
+        return false;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        // parts are fetched in queue order, so the ones before are not needed anymore
+        for (; m_first < index; ++m_first) {
+            Part *part = m_parts[m_first];
+            part->released = true;
+            if (part->done || !part->started) {
+                part->data.clear();
+            }
+        }
+    }
+    startJobs();
+
+    Part *part = m_parts[index];
+    QMutexLocker locker(&m_mutex);
+    if (!part->started) {
+        return false;
+    }
+    while (!part->done) {
+        m_partDone.wait(&m_mutex);
+    }
+    if (!part->ok) {
+        return false;
+    }
+    *data = part->data;
+    return true;
+}
+
+void MsooXmlPartPrefetcher::startJobs()
+{
+    const int end = qMin(m_parts.count(), m_first + m_window);
+    qint64 bytes = 0; // inflated or being inflated, from m_first on
+    for (int i = m_first; i < end; ++i) {
+        Part *part = m_parts[i];
+        if (part->started) {
+            bytes += part->size;
+            continue;
+        }
+        if (i > m_first && bytes >= m_memoryBudget) {
+            break;
+        }
+        part->started = true;
+        const bool read = readCompressed(part);
+        bytes += part->size;
+        if (!read) {
+            QMutexLocker locker(&m_mutex);
+            part->done = true;
+            continue;
+        }
+        m_pool.start(new InflateJob(this, part));
+    }
+}
+
+bool MsooXmlPartPrefetcher::readCompressed(Part *part)
+{
+    const KArchiveEntry *entry = m_zip->directory()->entry(part->path);
+    if (!entry || !entry->isFile()) {
+        return false;
+    }
+    const KZipFileEntry *file = static_cast<const KZipFileEntry*>(entry);
+    if (file->encoding() != ZipStored && file->encoding() != ZipDeflated) {
+        return false;
+    }
+    QIODevice *device = m_zip->device();
+    if (!device->seek(file->position())) {
+        return false;
+    }
+    part->raw = device->read(file->compressedSize());
+    if (part->raw.size() != file->compressedSize()) {
+        warnMsooXml << "Could not read" << part->path;
+        part->raw.clear();
+        return false;
+    }
+    part->encoding = file->encoding();
+    part->size = file->size();
+    return true;
+}
+
+bool MsooXmlPartPrefetcher::inflate(Part *part)
+{
+    if (part->encoding == ZipStored) {
+        part->data = part->raw;
+        return true;
+    }
+
+    QBuffer buffer(&part->raw);
+    KCompressionDevice device(&buffer, false, KCompressionDevice::GZip);
+    device.setSkipHeaders(); // raw deflate data, as in zip
+    if (!device.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    part->data = device.read(part->size);
+    return part->data.size() == part->size;
+}
@@ -0,0 +1,110 @@
+/*
+ * This file is part of Office 2007 Filters for Calligra
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#ifndef MSOOXMLPARTPREFETCHER_H
+#define MSOOXMLPARTPREFETCHER_H
+
+#include "komsooxml_export.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+
+class KZip;
+class TestMsooXmlPartPrefetcher;
+
+namespace MSOOXML
+{
+
+/**
+ * Inflates parts of the input archive on worker threads ahead of their use.
+ *
+ * Parts are expected to be fetched in the order they were queued with
+ * prefetch(). Only a few parts past the last fetched one are inflated at a
+ * time, and no more once they add up to the memory budget; the part to be
+ * fetched next is inflated whatever its size. Fetching a part releases every
+ * part queued before it, so memory stays bounded however long the queue is.
+ * A fetched part stays available until a later part is fetched, which lets
+ * readers parse it more than once.
+ *
+ * The compressed data is read from the archive device on the calling thread;
+ * only the inflating happens on the workers. All methods must be called from
+ * the thread that owns the archive.
+ */
+class KOMSOOXML_EXPORT MsooXmlPartPrefetcher
+{
+public:
+    /// Inflated data kept ahead of the fetched part by default
+    static const qint64 DefaultMemoryBudget = 64 * 1024 * 1024;
+
+    explicit MsooXmlPartPrefetcher(const KZip *zip, qint64 memoryBudget = DefaultMemoryBudget);
+
+    /// Waits for the running workers
+    ~MsooXmlPartPrefetcher();
+
+    /// Appends @a paths to the queue of parts to inflate
+    void prefetch(const QStringList &paths);
+
+    /**
+     * Sets @a data to the content of the part @a path, waiting for it to be
+     * inflated if needed. @return false if the part was not queued, was
+     * already released or could not be inflated; the caller should read it
+     * from the archive then.
+     */
+    bool fetch(const QString &path, QByteArray *data);
+
+private:
+    struct Part {
+        Part() : encoding(0), size(0), started(false), done(false), ok(false), released(false) {}
+        QString path;
+        QByteArray raw;
+        QByteArray data;
+        int encoding;
+        qint64 size;
+        bool started;
+        bool done;
+        bool ok;
+        bool released;
+    };
+    class InflateJob;
+    friend class ::TestMsooXmlPartPrefetcher; // checks which parts are inflated
+
+    void startJobs();
+    bool readCompressed(Part *part);
+    static bool inflate(Part *part);
+
+    const KZip *m_zip;
+    QVector<Part*> m_parts;
+    QHash<QString, int> m_indexes;
+    int m_first; //!< the first part that is not released
+    int m_window; //!< the number of parts inflated ahead of m_first
+    qint64 m_memoryBudget; //!< the inflated bytes kept from m_first on
+    QThreadPool m_pool;
+    QMutex m_mutex;
+    QWaitCondition m_partDone;
+};
+
+} // namespace MSOOXML
+
+#endif
@@ -118,6 +118,26 @@ const char MsooXmlReader::constString[] = "string";
 void MsooXmlReader::init()
 {
     m_readUndoed = false;
+    m_qualifiedNameHash = 0;
+    m_qualifiedNameHashOffset = -1;
+    m_qualifiedNameHashToken = NoToken;
+    m_qualifiedNameHashDevice = 0;
+}
+
+void MsooXmlReader::updateQualifiedNameHash()
+{
+    // Same as qualifiedNameHash(const char*); characters outside of Latin-1
+    // only have to keep the hash deterministic, names are compared anyway.
+    const QStringRef name(qualifiedName());
+    const QChar *data = name.unicode();
+    uint hash = 2166136261u;
+    for (int i = 0; i < name.size(); ++i) {
+        hash = (hash ^ uchar(data[i].unicode())) * 16777619u;
+    }
+    m_qualifiedNameHash = hash;
+    m_qualifiedNameHashOffset = characterOffset();
+    m_qualifiedNameHashToken = tokenType();
+    m_qualifiedNameHashDevice = device();
 }
 
 /*
@@ -267,7 +287,13 @@ bool MsooXmlReader::expectElEnd(const QString& qualifiedElementName)
 
 bool MsooXmlReader::expectElEnd(const char* qualifiedElementName)
 {
-    return expectElEnd(QLatin1String(qualifiedElementName));
+    // compare the Latin-1 name directly, this is called at the end of every read_*()
+    const QLatin1String name(qualifiedElementName);
+    if (!isEndElement() || qualifiedName() != name) {
+        raiseError(i18n("Expected closing of element \"%1\"", name));
+        return false;
+    }
+    return true;
 }
 
 bool MsooXmlReader::expectNS(const char* nsName)
@@ -41,6 +41,13 @@ namespace MSOOXML
 
 class MsooXmlRelationships;
 
+//! @return FNV-1a hash of the Latin-1 qualified element name @a name.
+//! Evaluated at compile time for literals, see QUALIFIED_NAME_HASH in MsooXmlReader_p.h.
+inline constexpr uint qualifiedNameHash(const char *name, uint hash = 2166136261u)
+{
+    return *name ? qualifiedNameHash(name + 1, (hash ^ uchar(*name)) * 16777619u) : hash;
+}
+
 //! Context for MsooXmlReader::read()
 class KOMSOOXML_EXPORT MsooXmlReaderContext
 {
@@ -92,6 +99,21 @@ public:
     //! Reimplemented after QXmlStreamReader for supporting undo read and for debugging purposes
     //TokenType readNext();
 
+    //! @return hash of qualifiedName() of the current token, computed once per token.
+    //! Element dispatch compares it against compile-time hashes of the expected
+    //! names before comparing any strings.
+    //! The cached value is keyed on the position of the token rather than reset when
+    //! reading, so it stays right however the reader is advanced, e.g. through a
+    //! QXmlStreamReader pointer.
+    uint qualifiedNameHash() {
+        if (characterOffset() != m_qualifiedNameHashOffset || tokenType() != m_qualifiedNameHashToken
+            || device() != m_qualifiedNameHashDevice)
+        {
+            updateQualifiedNameHash();
+        }
+        return m_qualifiedNameHash;
+    }
+
     //! Undoes recent readNext(); only one recent readNext() can be undoed
     //void undoReadNext();
 
@@ -144,8 +166,15 @@ private:
     QString m_fileName;
     bool m_readUndoed;
     QXmlStreamReader::TokenType m_recentType;
+    uint m_qualifiedNameHash;
+    //! Token the hash was computed for; tokens end at different offsets, except
+    //! the start and end of an empty element, which differ in type
+    qint64 m_qualifiedNameHashOffset;
+    QXmlStreamReader::TokenType m_qualifiedNameHashToken;
+    QIODevice *m_qualifiedNameHashDevice;
 
     void init();
+    void updateQualifiedNameHash();
 };
 
 } // namespace MSOOXML
@@ -26,6 +26,8 @@
 
 #include <klocalizedstring.h>
 
+#include <type_traits>
+
 #ifndef MSOOXML_CURRENT_CLASS
 #error Please include MsooXmlReader_p.h after defining MSOOXML_CURRENT_CLASS and MSOOXML_CURRENT_NS!
 #endif
@@ -68,6 +70,15 @@
     STRINGIFY(name)
 #endif
 
+//! Hash of the qualified name literal @a qname, always computed at compile time
+#define QUALIFIED_NAME_HASH(qname) \
+    (std::integral_constant<uint, MSOOXML::qualifiedNameHash(qname)>::value)
+
+//! True if the current token is named @a qname. The per-token hash is compared first,
+//! so a chain of these compares at most one string per token, see MsooXmlReader::qualifiedNameHash().
+#define QUALIFIED_NAME_EQUALS(qname) \
+    (qualifiedNameHash() == QUALIFIED_NAME_HASH(qname) && qualifiedName() == QLatin1String(qname))
+
 #ifdef NDEBUG
 # define PUSH_NAME_INTERNAL
 # define POP_NAME_INTERNAL
@@ -127,19 +138,24 @@
         break; \
     }
 
+#define BREAK_IF_END_OF_LATIN1(qname) \
+    if (isEndElement() && QUALIFIED_NAME_EQUALS(qname)) { \
+        break; \
+    }
+
 #define BREAK_IF_END_OF(name) \
-    BREAK_IF_END_OF_QSTRING(QLatin1String(QUALIFIED_NAME(name)))
+    BREAK_IF_END_OF_LATIN1(QUALIFIED_NAME(name))
 
 #define BREAK_IF_END_OF_WITH_NS(ns, name) \
-    BREAK_IF_END_OF_QSTRING(QLatin1String(JOIN(STRINGIFY(ns) ":",name)))
+    BREAK_IF_END_OF_LATIN1(JOIN(STRINGIFY(ns) ":",name))
 
 //inline bool aaaa(const char * aa) { debugMsooXml << "aa" << aa; return true; }
 
 #define QUALIFIED_NAME_IS(name) \
-    (qualifiedName() == QLatin1String(QUALIFIED_NAME(name)))
+    QUALIFIED_NAME_EQUALS(QUALIFIED_NAME(name))
 
 #define TRY_READ_IF_INTERNAL(name, qname, context) \
-    if (qualifiedName() == QLatin1String(qname)) { \
+    if (QUALIFIED_NAME_EQUALS(qname)) { \
         if (!isStartElement()) { /* sanity check */ \
             raiseError(i18n("Start element \"%1\" expected, found \"%2\"", \
                        QLatin1String(STRINGIFY(name)), tokenString())); \
@@ -177,7 +193,7 @@
     else TRY_READ_IF_NS_IN_CONTEXT_INTERNAL(ns, name, PASS_CONTEXT(name))
 
 #define TRY_READ_IF_NS_INTERNAL(ns, name) \
-    if (qualifiedName() == QLatin1String(JOIN(STRINGIFY(ns) ":", name))) { \
+    if (QUALIFIED_NAME_EQUALS(JOIN(STRINGIFY(ns) ":", name))) { \
         /*debugMsooXml << "TRY_READ_IF_NS " JOIN(STRINGIFY(ns) ":", name) " started";*/ \
         TRY_READ(name); \
         /*debugMsooXml << "TRY_READ_IF_NS " JOIN(STRINGIFY(ns) ":", name) " finished";*/ \
@@ -395,12 +411,13 @@ inline QString atrToString(const QXmlStreamAttributes& attrs, const char* atrnam
 #define SKIP_EVERYTHING \
     /*debugMsooXml << "Skipping everything in element" << qualifiedName() << "...";*/ \
     const QString qn(qualifiedName().toString()); \
+    const uint qnHash = qualifiedNameHash(); \
     /*debugMsooXml << *this; */\
     while (true) { \
         readNext(); \
         if (atEnd()) \
             break; \
-        if (isEndElement() && qualifiedName() == qn) { \
+        if (isEndElement() && qualifiedNameHash() == qnHash && qualifiedName() == qn) { \
             break; \
         } \
     }
@@ -0,0 +1,201 @@
+/*
+ * This file is part of Office 2007 Filters for Calligra
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include "MsooXmlReaderBenchmark.h"
+
+#include <MsooXmlReader.h>
+
+#include <QBuffer>
+#include <QTest>
+
+#define MSOOXML_CURRENT_NS "w"
+#define MSOOXML_CURRENT_CLASS BenchmarkReader
+
+#include <MsooXmlReader_p.h>
+
+const int PARAGRAPHS = 20000;
+
+#define NAME_IS(name) QUALIFIED_NAME_IS(name)
+
+namespace
+{
+
+/**
+ * Reads a WordprocessingML body with dispatch chains shaped like the ones
+ * of DocxXmlDocumentReader: a few likely siblings tested before the match.
+ */
+class BenchmarkReader : public MSOOXML::MsooXmlReader
+{
+public:
+    explicit BenchmarkReader(KoOdfWriters *writers)
+        : MsooXmlReader(writers), paragraphs(0), runs(0), properties(0), characters(0)
+    {
+    }
+
+    virtual KoFilter::ConversionStatus read(MSOOXML::MsooXmlReaderContext* = 0)
+    {
+        while (!atEnd()) {
+            readNext();
+            if (isStartElement()) {
+                if (NAME_IS(body)) {
+                    readBody();
+                } else if (!NAME_IS(document)) {
+                    skipCurrentElement();
+                }
+            }
+        }
+        return hasError() ? KoFilter::WrongFormat : KoFilter::OK;
+    }
+
+    int paragraphs;
+    int runs;
+    int properties;
+    int characters;
+
+private:
+    void readBody()
+    {
+        while (!atEnd()) {
+            readNext();
+            if (isEndElement() && NAME_IS(body)) {
+                break;
+            }
+            if (isStartElement()) {
+                if (NAME_IS(tbl) || NAME_IS(sdt) || NAME_IS(bookmarkStart)
+                    || NAME_IS(bookmarkEnd) || NAME_IS(customXml) || NAME_IS(sectPr)) {
+                    skipCurrentElement();
+                } else if (NAME_IS(p)) {
+                    readParagraph();
+                } else {
+                    skipCurrentElement();
+                }
+            }
+        }
+    }
+
+    void readParagraph()
+    {
+        ++paragraphs;
+        while (!atEnd()) {
+            readNext();
+            if (isEndElement() && NAME_IS(p)) {
+                break;
+            }
+            if (isStartElement()) {
+                if (NAME_IS(hyperlink) || NAME_IS(fldSimple) || NAME_IS(bookmarkStart)
+                    || NAME_IS(bookmarkEnd) || NAME_IS(ins) || NAME_IS(del) || NAME_IS(proofErr)) {
+                    skipCurrentElement();
+                } else if (NAME_IS(pPr)) {
+                    readProperties();
+                } else if (NAME_IS(r)) {
+                    readRun();
+                } else {
+                    skipCurrentElement();
+                }
+            }
+        }
+    }
+
+    void readRun()
+    {
+        ++runs;
+        while (!atEnd()) {
+            readNext();
+            if (isEndElement() && NAME_IS(r)) {
+                break;
+            }
+            if (isStartElement()) {
+                if (NAME_IS(tab) || NAME_IS(br) || NAME_IS(drawing) || NAME_IS(object)
+                    || NAME_IS(fldChar) || NAME_IS(instrText)) {
+                    skipCurrentElement();
+                } else if (NAME_IS(rPr)) {
+                    readProperties();
+                } else if (NAME_IS(t)) {
+                    characters += readElementText().length();
+                } else {
+                    skipCurrentElement();
+                }
+            }
+        }
+    }
+
+    // pPr and rPr
+    void readProperties()
+    {
+        const QString name(qualifiedName().toString());
+        while (!atEnd()) {
+            readNext();
+            if (isEndElement() && qualifiedName() == name) {
+                break;
+            }
+            if (isStartElement()) {
+                if (NAME_IS(pStyle) || NAME_IS(rStyle) || NAME_IS(keepNext) || NAME_IS(numPr)
+                    || NAME_IS(spacing) || NAME_IS(ind) || NAME_IS(jc) || NAME_IS(rFonts)
+                    || NAME_IS(b) || NAME_IS(i) || NAME_IS(u) || NAME_IS(color)
+                    || NAME_IS(sz) || NAME_IS(szCs) || NAME_IS(lang)) {
+                    ++properties;
+                }
+                skipCurrentElement();
+            }
+        }
+    }
+};
+
+void parse(BenchmarkReader *reader, QByteArray *document)
+{
+    QBuffer buffer(document);
+    buffer.open(QIODevice::ReadOnly);
+    reader->setDevice(&buffer);
+    QCOMPARE(reader->read(), KoFilter::OK);
+}
+
+}
+
+void MsooXmlReaderBenchmark::initTestCase()
+{
+    m_document = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+        "<w:document xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\"><w:body>";
+    for (int i = 0; i < PARAGRAPHS; ++i) {
+        if (i % 10 == 0) {
+            m_document += "<w:bookmarkStart w:id=\"" + QByteArray::number(i) + "\" w:name=\"b\"/>";
+        }
+        m_document += "<w:p><w:pPr><w:pStyle w:val=\"Normal\"/><w:spacing w:after=\"120\"/><w:jc w:val=\"both\"/></w:pPr>"
+            "<w:r><w:rPr><w:rFonts w:ascii=\"Arial\"/><w:b/><w:sz w:val=\"22\"/><w:szCs w:val=\"22\"/><w:lang w:val=\"en-US\"/></w:rPr>"
+            "<w:t>Lorem ipsum dolor sit amet</w:t></w:r>"
+            "<w:proofErr w:type=\"spellStart\"/>"
+            "<w:r><w:rPr><w:i/><w:color w:val=\"FF0000\"/></w:rPr><w:t xml:space=\"preserve\"> consectetur</w:t><w:tab/></w:r></w:p>";
+    }
+    m_document += "<w:sectPr><w:pgSz w:w=\"11906\" w:h=\"16838\"/></w:sectPr></w:body></w:document>";
+}
+
+void MsooXmlReaderBenchmark::benchmarkDispatch()
+{
+    KoOdfWriters writers;
+    QBENCHMARK {
+        BenchmarkReader reader(&writers);
+        parse(&reader, &m_document);
+
+        QCOMPARE(reader.paragraphs, PARAGRAPHS);
+        QCOMPARE(reader.runs, 2 * PARAGRAPHS);
+        QCOMPARE(reader.properties, 10 * PARAGRAPHS);
+        QCOMPARE(reader.characters, 38 * PARAGRAPHS);
+    }
+}
+
+QTEST_GUILESS_MAIN(MsooXmlReaderBenchmark)
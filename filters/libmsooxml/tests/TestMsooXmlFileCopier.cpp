@@ -0,0 +1,106 @@
+/*
+ * This file is part of Office 2007 Filters for Calligra
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include "TestMsooXmlFileCopier.h"
+
+#include <MsooXmlFileCopier.h>
+
+#include <KoStore.h>
+
+#include <QTest>
+
+#include <kzip.h>
+
+using MSOOXML::MsooXmlFileCopier;
+
+void TestMsooXmlFileCopier::initTestCase()
+{
+    QVERIFY(m_tempDir.isValid());
+    m_zipFileName = m_tempDir.path() + QLatin1String("/input.pptx");
+
+    // spanning several copy blocks
+    for (int i = 0; m_picture.size() < 64 * 1024; ++i) {
+        m_picture += QByteArray::number(i * 7919 % 10007);
+    }
+    // same size, other content
+    m_otherPicture = m_picture;
+    m_otherPicture[1000] = 'x';
+
+    KZip zip(m_zipFileName);
+    QVERIFY(zip.open(QIODevice::WriteOnly));
+    QVERIFY(zip.writeFile("ppt/media/image1.png", m_picture));
+    QVERIFY(zip.writeFile("ppt/media/image2.png", m_otherPicture));
+    QVERIFY(zip.writeFile("ppt/media/image7.png", m_picture));
+    QVERIFY(zip.close());
+}
+
+void TestMsooXmlFileCopier::testSameContentStoredOnce()
+{
+    const QString storeFileName = m_tempDir.path() + QLatin1String("/output.odp");
+    KZip zip(m_zipFileName);
+    QVERIFY(zip.open(QIODevice::ReadOnly));
+    KoStore *store = KoStore::createStore(storeFileName, KoStore::Write,
+                                          "application/vnd.oasis.opendocument.presentation", KoStore::Zip);
+    QVERIFY(store);
+    QVERIFY(!store->bad());
+
+    MsooXmlFileCopier copier(&zip, store);
+    QString errorMessage;
+
+    QString first("Pictures/image1.png");
+    QCOMPARE(copier.copyFile("ppt/media/image1.png", first, errorMessage), KoFilter::OK);
+    QCOMPARE(first, QString("Pictures/image1.png"));
+
+    QString other("Pictures/image2.png");
+    QCOMPARE(copier.copyFile("ppt/media/image2.png", other, errorMessage), KoFilter::OK);
+    QCOMPARE(other, QString("Pictures/image2.png"));
+
+    // the same content under another name refers to the first copy
+    QString second("Pictures/image7.png");
+    QCOMPARE(copier.copyFile("ppt/media/image7.png", second, errorMessage), KoFilter::OK);
+    QCOMPARE(second, first);
+
+    // and so does every later reference to it
+    QString again("Pictures/image7.png");
+    QCOMPARE(copier.copyFile("ppt/media/image7.png", again, errorMessage), KoFilter::OK);
+    QCOMPARE(again, first);
+
+    QString missing("Pictures/image9.png");
+    QCOMPARE(copier.copyFile("ppt/media/image9.png", missing, errorMessage), KoFilter::FileNotFound);
+    QVERIFY(!errorMessage.isEmpty());
+
+    QVERIFY(store->finalize());
+    delete store;
+
+    store = KoStore::createStore(storeFileName, KoStore::Read);
+    QVERIFY(store);
+    QVERIFY(!store->bad());
+    QVERIFY(store->hasFile("Pictures/image1.png"));
+    QVERIFY(store->hasFile("Pictures/image2.png"));
+    QVERIFY(!store->hasFile("Pictures/image7.png"));
+    QVERIFY(store->open("Pictures/image1.png"));
+    QCOMPARE(store->read(store->size()), m_picture);
+    QVERIFY(store->close());
+    QVERIFY(store->open("Pictures/image2.png"));
+    QCOMPARE(store->read(store->size()), m_otherPicture);
+    QVERIFY(store->close());
+    delete store;
+}
+
+QTEST_GUILESS_MAIN(TestMsooXmlFileCopier)
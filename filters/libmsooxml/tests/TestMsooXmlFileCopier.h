@@ -0,0 +1,42 @@
+/*
+ * This file is part of Office 2007 Filters for Calligra
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#ifndef TESTMSOOXMLFILECOPIER_H
+#define TESTMSOOXMLFILECOPIER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QTemporaryDir>
+
+class TestMsooXmlFileCopier : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+
+    void testSameContentStoredOnce();
+
+private:
+    QTemporaryDir m_tempDir;
+    QString m_zipFileName;
+    QByteArray m_picture;
+    QByteArray m_otherPicture;
+};
+
+#endif // TESTMSOOXMLFILECOPIER_H
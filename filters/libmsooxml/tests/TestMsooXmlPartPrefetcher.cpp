@@ -0,0 +1,168 @@
+/*
+ * This file is part of Office 2007 Filters for Calligra
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#include "TestMsooXmlPartPrefetcher.h"
+
+#include <MsooXmlPartPrefetcher.h>
+
+#include <QTest>
+
+#include <kzip.h>
+
+using MSOOXML::MsooXmlPartPrefetcher;
+
+// what the importer does when the prefetcher has no data for a part
+static QByteArray readFromArchive(const KZip &zip, const QString &path)
+{
+    const KArchiveEntry *entry = zip.directory()->entry(path);
+    if (!entry || !entry->isFile()) {
+        return QByteArray();
+    }
+    return static_cast<const KArchiveFile*>(entry)->data();
+}
+
+void TestMsooXmlPartPrefetcher::initTestCase()
+{
+    QVERIFY(m_tempDir.isValid());
+    m_zipFileName = m_tempDir.path() + QLatin1String("/input.xlsx");
+
+    for (int i = 1; i <= 6; ++i) {
+        QByteArray content;
+        for (int j = 0; content.size() < 64 * 1024; ++j) {
+            content += QByteArray::number((j * 7919 + i) % 10007) + ' ';
+        }
+        m_paths << QString("xl/worksheets/sheet%1.xml").arg(i);
+        m_contents << content;
+    }
+    // a stored part among the deflated ones
+    m_paths.insert(3, "xl/media/image1.png");
+    m_contents.insert(3, QByteArray(16 * 1024, 'p'));
+
+    KZip zip(m_zipFileName);
+    QVERIFY(zip.open(QIODevice::WriteOnly));
+    for (int i = 0; i < m_paths.count(); ++i) {
+        zip.setCompression(i == 3 ? KZip::NoCompression : KZip::DeflateCompression);
+        QVERIFY(zip.writeFile(m_paths[i], m_contents[i]));
+    }
+    QVERIFY(zip.close());
+}
+
+void TestMsooXmlPartPrefetcher::testFetchInQueueOrder()
+{
+    KZip zip(m_zipFileName);
+    QVERIFY(zip.open(QIODevice::ReadOnly));
+
+    MsooXmlPartPrefetcher prefetcher(&zip);
+    prefetcher.prefetch(m_paths);
+
+    QByteArray data;
+    QVERIFY(prefetcher.fetch(m_paths[0], &data));
+    QCOMPARE(data, m_contents[0]);
+    // a fetched part stays available until a later part is fetched
+    QVERIFY(prefetcher.fetch(m_paths[0], &data));
+    QCOMPARE(data, m_contents[0]);
+
+    // skipping a part releases it along with the fetched ones
+    QVERIFY(prefetcher.fetch(m_paths[2], &data));
+    QCOMPARE(data, m_contents[2]);
+    QVERIFY(!prefetcher.fetch(m_paths[0], &data));
+    QVERIFY(!prefetcher.fetch(m_paths[1], &data));
+    QCOMPARE(data, m_contents[2]);
+    prefetcher.m_pool.waitForDone();
+    QVERIFY(prefetcher.m_parts[0]->data.isEmpty());
+    QVERIFY(prefetcher.m_parts[1]->data.isEmpty());
+    QVERIFY(!prefetcher.m_parts[2]->data.isEmpty());
+
+    for (int i = 3; i < m_paths.count(); ++i) {
+        QVERIFY(prefetcher.fetch(m_paths[i], &data));
+        QCOMPARE(data, m_contents[i]);
+    }
+}
+
+void TestMsooXmlPartPrefetcher::testFallBackToArchive()
+{
+    KZip zip(m_zipFileName);
+    QVERIFY(zip.open(QIODevice::ReadOnly));
+
+    const QString missing("xl/worksheets/sheet9.xml");
+    MsooXmlPartPrefetcher prefetcher(&zip);
+    prefetcher.prefetch(QStringList() << m_paths[0] << missing << m_paths[1]);
+
+    // not queued
+    QByteArray data;
+    QVERIFY(!prefetcher.fetch(m_paths[2], &data));
+    QVERIFY(data.isNull());
+    QCOMPARE(readFromArchive(zip, m_paths[2]), m_contents[2]);
+
+    QVERIFY(prefetcher.fetch(m_paths[0], &data));
+    QCOMPARE(data, m_contents[0]);
+
+    // queued but not in the archive
+    data.clear();
+    QVERIFY(!prefetcher.fetch(missing, &data));
+    QVERIFY(data.isNull());
+    QVERIFY(readFromArchive(zip, missing).isNull());
+
+    // the queue goes on after it
+    QVERIFY(prefetcher.fetch(m_paths[1], &data));
+    QCOMPARE(data, m_contents[1]);
+
+    // released
+    data.clear();
+    QVERIFY(!prefetcher.fetch(m_paths[0], &data));
+    QVERIFY(data.isNull());
+    QCOMPARE(readFromArchive(zip, m_paths[0]), m_contents[0]);
+}
+
+void TestMsooXmlPartPrefetcher::testMemoryBudget()
+{
+    KZip zip(m_zipFileName);
+    QVERIFY(zip.open(QIODevice::ReadOnly));
+
+    // the sheets only, each a bit larger than 64 KiB, so the third one reaches the budget
+    QStringList paths = m_paths;
+    QList<QByteArray> contents = m_contents;
+    paths.removeAt(3);
+    contents.removeAt(3);
+    MsooXmlPartPrefetcher prefetcher(&zip, 160 * 1024);
+    prefetcher.m_window = paths.count(); // so only the budget limits the parts inflated
+    prefetcher.prefetch(paths);
+
+    QVERIFY(prefetcher.m_parts[2]->started);
+    QVERIFY(!prefetcher.m_parts[3]->started);
+
+    QByteArray data;
+    QVERIFY(prefetcher.fetch(paths[0], &data));
+    QCOMPARE(data, contents[0]);
+    QVERIFY(!prefetcher.m_parts[3]->started);
+
+    // releasing the first part makes room for one more
+    QVERIFY(prefetcher.fetch(paths[1], &data));
+    QCOMPARE(data, contents[1]);
+    QVERIFY(prefetcher.m_parts[3]->started);
+    QVERIFY(!prefetcher.m_parts[4]->started);
+
+    // releasing three parts at once lets the rest of the queue start
+    QVERIFY(prefetcher.fetch(paths[4], &data));
+    QCOMPARE(data, contents[4]);
+    QVERIFY(prefetcher.m_parts[5]->started);
+    QVERIFY(prefetcher.fetch(paths[5], &data));
+    QCOMPARE(data, contents[5]);
+}
+
+QTEST_GUILESS_MAIN(TestMsooXmlPartPrefetcher)
@@ -0,0 +1,45 @@
+/*
+ * This file is part of Office 2007 Filters for Calligra
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+#ifndef TESTMSOOXMLPARTPREFETCHER_H
+#define TESTMSOOXMLPARTPREFETCHER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QList>
+#include <QStringList>
+#include <QTemporaryDir>
+
+class TestMsooXmlPartPrefetcher : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+
+    void testFetchInQueueOrder();
+    void testFallBackToArchive();
+    void testMemoryBudget();
+
+private:
+    QTemporaryDir m_tempDir;
+    QString m_zipFileName;
+    QStringList m_paths;
+    QList<QByteArray> m_contents;
+};
+
+#endif // TESTMSOOXMLPARTPREFETCHER_H
@@ -0,0 +1,130 @@
+/*
+ * This file is part of Office 2007 Filters for Calligra
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#include "TestMsooXmlReader.h"
+
+#include <MsooXmlReader.h>
+
+#include <QBuffer>
+#include <QTest>
+
+#define MSOOXML_CURRENT_NS "w"
+#define MSOOXML_CURRENT_CLASS NameReader
+
+#include <MsooXmlReader_p.h>
+
+namespace
+{
+
+/// Exposes the name checks of the reader macros
+class NameReader : public MSOOXML::MsooXmlReader
+{
+public:
+    explicit NameReader(KoOdfWriters *writers)
+        : MsooXmlReader(writers)
+    {
+    }
+
+    virtual KoFilter::ConversionStatus read(MSOOXML::MsooXmlReaderContext* = 0)
+    {
+        return KoFilter::OK;
+    }
+
+    bool isDocument() { return QUALIFIED_NAME_IS(document); }
+    bool isP() { return QUALIFIED_NAME_IS(p); }
+    bool isR() { return QUALIFIED_NAME_IS(r); }
+    bool isT() { return QUALIFIED_NAME_IS(t); }
+};
+
+const char document[] =
+    "<w:document xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\">"
+    "<w:p/><w:r/><w:t>x</w:t></w:document>";
+
+}
+
+void TestMsooXmlReader::testNameAfterAdvancingThroughBaseClass()
+{
+    QByteArray data(document);
+    QBuffer buffer(&data);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    KoOdfWriters writers;
+    NameReader reader(&writers);
+    reader.setDevice(&buffer);
+    // the way e.g. ComplexShapeHandler advances a reader
+    QXmlStreamReader *base = &reader;
+
+    QVERIFY(base->readNextStartElement());
+    QVERIFY(reader.isDocument());
+    QVERIFY(base->readNextStartElement());
+    QVERIFY(reader.isP());
+    QVERIFY(!reader.isDocument());
+
+    // the end of the empty element has the same name
+    base->readNext();
+    QVERIFY(reader.isEndElement());
+    QVERIFY(reader.isP());
+
+    base->readNext();
+    QVERIFY(reader.isStartElement());
+    QVERIFY(reader.isR());
+    QVERIFY(!reader.isP());
+
+    base->readNext();
+    QVERIFY(reader.isEndElement());
+    QVERIFY(reader.isR());
+
+    base->readNext();
+    QVERIFY(reader.isT());
+    QCOMPARE(base->readElementText(), QString("x"));
+    QVERIFY(reader.isEndElement());
+    QVERIFY(reader.isT());
+
+    base->readNext();
+    QVERIFY(reader.isEndElement());
+    QVERIFY(reader.isDocument());
+    QVERIFY(!reader.isT());
+}
+
+void TestMsooXmlReader::testNameAfterDeviceChange()
+{
+    QByteArray data(document);
+    QBuffer buffer(&data);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    // the same offsets, other names
+    QByteArray otherData(data);
+    otherData.replace("w:p/", "w:r/");
+    QBuffer otherBuffer(&otherData);
+    QVERIFY(otherBuffer.open(QIODevice::ReadOnly));
+
+    KoOdfWriters writers;
+    NameReader reader(&writers);
+    QXmlStreamReader *base = &reader;
+    base->setDevice(&buffer);
+    QVERIFY(base->readNextStartElement());
+    QVERIFY(base->readNextStartElement());
+    QVERIFY(reader.isP());
+
+    base->setDevice(&otherBuffer);
+    QVERIFY(base->readNextStartElement());
+    QVERIFY(base->readNextStartElement());
+    QVERIFY(reader.isR());
+    QVERIFY(!reader.isP());
+}
+
+QTEST_GUILESS_MAIN(TestMsooXmlReader)
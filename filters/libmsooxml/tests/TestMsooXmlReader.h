@@ -0,0 +1,33 @@
+/*
+ * This file is part of Office 2007 Filters for Calligra
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * version 2.1 as published by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ */
+
+#ifndef TESTMSOOXMLREADER_H
+#define TESTMSOOXMLREADER_H
+
+#include <QObject>
+
+class TestMsooXmlReader : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testNameAfterAdvancingThroughBaseClass();
+    void testNameAfterDeviceChange();
+};
+
+#endif // TESTMSOOXMLREADER_H
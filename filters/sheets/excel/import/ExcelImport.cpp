@@ -837,13 +837,12 @@ void ExcelImport::Private::processRow(Sheet* is, unsigned rowIndex, Calligra::Sh
     os->rowFormats()->setHidden(rowIndex+1, rowIndex+1, !row->visible());
     // TODO default cell style
 
-    // find the column of the rightmost cell (if any)
-    const int lastCol = row->sheet()->maxCellsInRow(rowIndex);
-    for (int i = 0; i <= lastCol; ++i) {
-        Cell* cell = is->cell(i, rowIndex, false);
-        if (!cell) continue;
-        processCell(cell, Calligra::Sheets::Cell(os, i+1, rowIndex+1));
+    foreach (Cell* cell, is->cellsInRow(rowIndex)) {
+        processCell(cell, Calligra::Sheets::Cell(os, cell->column()+1, rowIndex+1));
     }
+    // Nothing reads the cells of a converted row again, releasing them right
+    // away keeps the Swinder cells and the converted ones from peaking together.
+    is->releaseCells(rowIndex);
 
     addProgress(1);
 }
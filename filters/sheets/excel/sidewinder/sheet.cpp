@@ -28,6 +28,7 @@
 
 #include <PointStorage.h>
 
+#include <algorithm>
 #include <iostream>
 #include <map>
 #include <QPoint>
@@ -52,8 +53,8 @@ public:
     Workbook* workbook;
     QString name;
 
-    // hash to store cell, FIXME replace with quad-tree
-    QHash<unsigned, Cell*> cells;
+    // cells of each row, ordered by column
+    QHash<unsigned, QVector<Cell*> > cells;
     unsigned maxRow;
     unsigned maxColumn;
     QHash<unsigned, unsigned> maxCellsInRow;
@@ -146,7 +147,9 @@ void Sheet::clear()
     }
     qDeleteAll(d->sheetDrawObjects);
     // delete all cells
-    qDeleteAll(d->cells);
+    foreach (const QVector<Cell*>& cells, d->cells) {
+        qDeleteAll(cells);
+    }
     d->cells.clear();
     // delete all columns
     qDeleteAll(d->columns);
@@ -191,33 +194,61 @@ void Sheet::setName(const QString& name)
     d->name = name;
 }
 
+static bool cellColumnLessThan(const Cell* cell, unsigned column)
+{
+    return cell->column() < column;
+}
+
 Cell* Sheet::cell(unsigned columnIndex, unsigned rowIndex, bool autoCreate)
 {
-    const unsigned hashed = (rowIndex + 1) * maximalColumnCount + columnIndex + 1;
-    Cell* c = d->cells[ hashed ];
+    QHash<unsigned, QVector<Cell*> >::iterator row = d->cells.find(rowIndex);
+    if (row == d->cells.end()) {
+        if (!autoCreate) return 0;
+        row = d->cells.insert(rowIndex, QVector<Cell*>());
+    }
+
+    // records come in column order, so new cells are usually appended
+    QVector<Cell*>& cells = row.value();
+    QVector<Cell*>::iterator it = cells.end();
+    if (!cells.isEmpty() && cells.last()->column() >= columnIndex) {
+        it = std::lower_bound(cells.begin(), cells.end(), columnIndex, cellColumnLessThan);
+        if ((*it)->column() == columnIndex) return *it;
+    }
 
     // create cell if necessary
-    if (!c && autoCreate) {
-        c = new Cell(this, columnIndex, rowIndex);
-        d->cells[ hashed ] = c;
+    if (!autoCreate) return 0;
+    Cell* c = new Cell(this, columnIndex, rowIndex);
+    cells.insert(it, c);
 
-        // force creating the column and row
-        this->column(columnIndex, true);
-        this->row(rowIndex, true);
+    // force creating the column and row
+    this->column(columnIndex, true);
+    this->row(rowIndex, true);
 
-        if (rowIndex > d->maxRow) d->maxRow = rowIndex;
-        if (columnIndex > d->maxColumn) d->maxColumn = columnIndex;
+    if (rowIndex > d->maxRow) d->maxRow = rowIndex;
+    if (columnIndex > d->maxColumn) d->maxColumn = columnIndex;
 
-        if(!d->maxCellsInRow.contains(rowIndex) || columnIndex > d->maxCellsInRow[rowIndex])
-            d->maxCellsInRow[rowIndex] = columnIndex;
-    }
+    if(!d->maxCellsInRow.contains(rowIndex) || columnIndex > d->maxCellsInRow[rowIndex])
+        d->maxCellsInRow[rowIndex] = columnIndex;
 
     return c;
 }
 
+QVector<Cell*> Sheet::cellsInRow(unsigned rowIndex) const
+{
+    return d->cells.value(rowIndex);
+}
+
+void Sheet::releaseCells(unsigned rowIndex)
+{
+    QHash<unsigned, QVector<Cell*> >::iterator row = d->cells.find(rowIndex);
+    if (row == d->cells.end()) return;
+    qDeleteAll(row.value());
+    d->cells.erase(row);
+}
+
 Column* Sheet::column(unsigned index, bool autoCreate)
 {
-    Column* c = d->columns[ index ];
+    Column* c = d->columns.value(index);
 
     // create column if necessary
     if (!c && autoCreate) {
@@ -231,7 +262,7 @@ Column* Sheet::column(unsigned index, bool autoCreate)
 
 Row* Sheet::row(unsigned index, bool autoCreate)
 {
-    Row* r = d->rows[ index ];
+    Row* r = d->rows.value(index);
 
     // create row if necessary
     if (!r && autoCreate) {
@@ -636,19 +667,23 @@ bool Sheet::isRightToLeft() const
 void Sheet::dumpStats()
 {
     int ndValue = 0, ndFormula = 0, ndFormat = 0, ndColumnSpan = 0, ndRowSpan = 0, ndCovered = 0, ndColumnRepeat = 0, ndHyperlink = 0, ndNote = 0, ndPictures = 0, ndCharts = 0;
-    foreach (Cell* c, d->cells) {
-        if (c->value() != Value()) ndValue++;
-        if (!c->formula().isEmpty()) ndFormula++;
-        if (c->format() != Format()) ndFormat++;
-        if (c->columnSpan() != 1) ndColumnSpan++;
-        if (c->rowSpan() != 1) ndRowSpan++;
-        if (c->isCovered()) ndCovered++;
-        if (c->columnRepeat() != 1) ndColumnRepeat++;
-        if (c->hasHyperlink()) ndHyperlink++;
-        if (!c->note().isEmpty()) ndNote++;
-        if (c->charts().size()) ndCharts++;
+    int ndCells = 0;
+    foreach (const QVector<Cell*>& cells, d->cells) {
+        ndCells += cells.size();
+        foreach (Cell* c, cells) {
+            if (c->value() != Value()) ndValue++;
+            if (!c->formula().isEmpty()) ndFormula++;
+            if (c->format() != Format()) ndFormat++;
+            if (c->columnSpan() != 1) ndColumnSpan++;
+            if (c->rowSpan() != 1) ndRowSpan++;
+            if (c->isCovered()) ndCovered++;
+            if (c->columnRepeat() != 1) ndColumnRepeat++;
+            if (c->hasHyperlink()) ndHyperlink++;
+            if (!c->note().isEmpty()) ndNote++;
+            if (c->charts().size()) ndCharts++;
+        }
     }
-    printf("    rows: %d\n  cols: %d\n  cells: %d\n", d->rows.size(), d->columns.size(), d->cells.size());
+    printf("    rows: %d\n  cols: %d\n  cells: %d\n", d->rows.size(), d->columns.size(), ndCells);
     printf("       values: %d\n       formulas: %d\n       formats: %d\n       colspans: %d\n       rowspans: %d\n       covered: %d\n       colrepeat: %d\n       hyperlink: %d\n       note: %d\n       pics: %d\n       charts: %d\n", ndValue, ndFormula, ndFormat, ndColumnSpan, ndRowSpan, ndCovered, ndColumnRepeat, ndHyperlink, ndNote, ndPictures, ndCharts);
 }
 #endif
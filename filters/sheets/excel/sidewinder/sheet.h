@@ -24,6 +24,7 @@
 #include "cell.h"
 #include <QString>
 #include <QImage>
+#include <QVector>
 #include <generated/simpleParser.h>
 
 #include "database/Filter.h"
@@ -65,6 +66,13 @@ public:
     // return NULL if no cell there _and_ autoCreate is false
     Cell* cell(unsigned column, unsigned row, bool autoCreate = true);
 
+    // return the cells of the specified row, ordered by column
+    QVector<Cell*> cellsInRow(unsigned row) const;
+
+    // delete the cells of the specified row, used by the import to
+    // release a row as soon as it has been converted
+    void releaseCells(unsigned row);
+
     Column* column(unsigned index, bool autoCreate = true);
 
     Row* row(unsigned index, bool autoCreate = true);
@@ -53,6 +53,7 @@
 #include <KoFilterChain.h>
 #include <KoPageLayout.h>
 #include <KoXmlWriter.h>
+#include <KoXmlReader.h>
 
 K_PLUGIN_FACTORY_WITH_JSON(XlsxImportFactory, "calligra_filter_xlsx2ods.json", registerPlugin<XlsxImport>();)
 
@@ -128,6 +129,10 @@ bool XlsxImport::acceptsDestinationMimeType(const QByteArray& mime) const
     return mime == "application/vnd.oasis.opendocument.spreadsheet";
 }
 
+// the workbook location XlsxXmlDocumentReader resolves the sheets against
+static const char WorkbookPath[] = "xl";
+static const char WorkbookFile[] = "workbook.xml";
+
 KoFilter::ConversionStatus XlsxImport::parseParts(KoOdfWriters *writers,
         MSOOXML::MsooXmlRelationships *relationships, QString& errorMessage)
 {
@@ -573,6 +578,9 @@ KoFilter::ConversionStatus XlsxImport::parseParts(KoOdfWriters *writers,
     QString spreadPath, spreadFile;
     MSOOXML::Utils::splitPathAndFile(spreadPathAndFile, &spreadPath, &spreadFile);
 
+    // the sheets are inflated while the styles and strings are parsed
+    prefetchWorkbookParts(relationships, spreadPathAndFile);
+
     MSOOXML::DrawingMLTheme themes;
     const QString spreadThemePathAndFile(relationships->targetForType(
         spreadPath, spreadFile,
@@ -633,7 +641,8 @@ KoFilter::ConversionStatus XlsxImport::parseParts(KoOdfWriters *writers,
 
     // 5. parse document
     {
-        XlsxXmlDocumentReaderContext context(*this, &themes, sharedStrings, comments, styles, *relationships, "workbook.xml", "xl");
+        XlsxXmlDocumentReaderContext context(*this, &themes, sharedStrings, comments, styles, *relationships,
+                                             WorkbookFile, WorkbookPath);
         XlsxXmlDocumentReader documentReader(writers);
         RETURN_IF_ERROR(loadAndParseDocument(d->mainDocumentContentType(), &documentReader, writers, errorMessage, &context))
     }
@@ -644,4 +653,31 @@ KoFilter::ConversionStatus XlsxImport::parseParts(KoOdfWriters *writers,
     return KoFilter::OK;
 }
 
+void XlsxImport::prefetchWorkbookParts(MSOOXML::MsooXmlRelationships *relationships,
+                                       const QString &spreadPathAndFile)
+{
+    // in the order parseParts() loads them
+    QStringList parts;
+    parts << QString(partNames(MSOOXML::ContentTypes::spreadsheetStyles).value(0))
+          << QString(partNames(MSOOXML::ContentTypes::spreadsheetSharedStrings).value(0));
+
+    // The workbook is small, reading it once more is cheap. Its sheets are
+    // loaded in the order of the sheets element by XlsxXmlDocumentReader.
+    KoXmlDocument workbook;
+    QString errorMessage;
+    if (loadAndParse(spreadPathAndFile, workbook, errorMessage) == KoFilter::OK) {
+        const KoXmlElement sheets(KoXml::namedItemNS(workbook.documentElement(),
+                                                     MSOOXML::Schemas::spreadsheetml, "sheets"));
+        KoXmlElement sheet;
+        forEachElement(sheet, sheets) {
+            const QString r_id(sheet.attributeNS(MSOOXML::Schemas::officeDocument::relationships, "id"));
+            // the same path XlsxXmlDocumentReader::read_sheet() loads the sheet from
+            parts << relationships->target(WorkbookPath, WorkbookFile, r_id);
+        }
+    }
+    parts.removeAll(QString());
+    qCDebug(lcXlsxImport) << "prefetching" << parts;
+    prefetchParts(parts);
+}
+
 #include "XlsxImport.moc"
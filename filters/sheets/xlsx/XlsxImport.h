@@ -47,6 +47,11 @@ protected:
 
     class Private;
     Private * const d;
+
+private:
+    //! Has the import inflate the styles, shared strings and worksheets in the background.
+    void prefetchWorkbookParts(MSOOXML::MsooXmlRelationships *relationships,
+                               const QString &spreadPathAndFile);
 };
 
 #endif
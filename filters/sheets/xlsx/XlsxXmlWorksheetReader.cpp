@@ -242,6 +242,8 @@ public:
     int drawingNumber;
     QHash<int, Cell*> sharedFormulas;
     QHash<QString, QString > savedStyles;
+    //! the automatic cell style of each xf index, for cells without conditional formatting
+    QHash<uint, QString> cellStyleNames;
 };
 
 XlsxXmlWorksheetReader::XlsxXmlWorksheetReader(KoOdfWriters *writers)
@@ -1408,7 +1410,7 @@ KoFilter::ConversionStatus XlsxXmlWorksheetReader::read_c()
             if (!ok || stringIndex < 0 || stringIndex >= m_context->sharedStrings->size()) {
                 return KoFilter::WrongFormat;
             }
-            QString sharedstring = m_context->sharedStrings->at(stringIndex);
+            const QString& sharedstring = m_context->sharedStrings->at(stringIndex);
             cell->text = sharedstring;
             cell->valueType = Cell::ConstString;
             m_value = sharedstring;
@@ -1483,29 +1485,39 @@ KoFilter::ConversionStatus XlsxXmlWorksheetReader::read_c()
             raiseUnexpectedAttributeValueError(s, "c@s");
             return KoFilter::WrongFormat;
         }
-        KoGenStyle cellStyle(KoGenStyle::TableCellAutoStyle, "table-cell");
-
-        if (charStyleName.isEmpty()) {
-            KoGenStyle* fontStyle = m_context->styles->fontStyle(cellFormat->fontId);
-            if (!fontStyle) {
-                qCWarning(lcXlsxImport) << "No font with ID:" << cellFormat->fontId;
-            } else {
-                KoGenStyle::copyPropertiesFromStyle(*fontStyle, cellStyle, KoGenStyle::TextType);
-            }
-        }
-        if (!cellFormat->setupCellStyle(m_context->styles, &cellStyle)) {
-            return KoFilter::WrongFormat;
-        }
-
-        if (!formattedStyle.isEmpty()) {
-            cellStyle.addAttribute( "style:data-style-name", formattedStyle );
-        }
-
+        QList<QMap<QString, QString> > maps;
         if (!m_context->conditionalStyles.isEmpty()) {
             QString positionLetter;
             int positionNumber;
             splitToRowAndColumn(r.toLatin1().constData(), 0, r.size(), positionLetter, positionNumber);
-            QList<QMap<QString, QString> > maps = m_context->conditionalStyleForPosition(positionLetter, positionNumber);
+            maps = m_context->conditionalStyleForPosition(positionLetter, positionNumber);
+        }
+
+        // Without style maps the style only depends on the xf index, so it is
+        // built and inserted once instead of for every cell
+        QString cellStyleName;
+        if (maps.isEmpty()) {
+            cellStyleName = d->cellStyleNames.value(styleId);
+        }
+        if (cellStyleName.isEmpty()) {
+            KoGenStyle cellStyle(KoGenStyle::TableCellAutoStyle, "table-cell");
+
+            if (charStyleName.isEmpty()) {
+                KoGenStyle* fontStyle = m_context->styles->fontStyle(cellFormat->fontId);
+                if (!fontStyle) {
+                    qCWarning(lcXlsxImport) << "No font with ID:" << cellFormat->fontId;
+                } else {
+                    KoGenStyle::copyPropertiesFromStyle(*fontStyle, cellStyle, KoGenStyle::TextType);
+                }
+            }
+            if (!cellFormat->setupCellStyle(m_context->styles, &cellStyle)) {
+                return KoFilter::WrongFormat;
+            }
+
+            if (!formattedStyle.isEmpty()) {
+                cellStyle.addAttribute( "style:data-style-name", formattedStyle );
+            }
+
             int index = maps.size();
             // Adding the lists in reversed priority order, as KoGenStyle when creating the style
             // adds last added first
@@ -1513,9 +1525,12 @@ KoFilter::ConversionStatus XlsxXmlWorksheetReader::read_c()
                 cellStyle.addStyleMap(maps.at(index - 1));
                 --index;
             }
-        }
 
-        const QString cellStyleName = mainStyles->insert( cellStyle, "ce" );
+            cellStyleName = mainStyles->insert( cellStyle, "ce" );
+            if (maps.isEmpty()) {
+                d->cellStyleNames.insert(styleId, cellStyleName);
+            }
+        }
         cell->styleName = cellStyleName;
     }
 
@@ -45,6 +45,7 @@
 #include <QTime>
 #include <QDir>
 #include <QBuffer>
+#include <QSet>
 #include <qmath.h>
 
 //#define DEBUG_PPTTOODP
@@ -852,17 +853,23 @@ PptToOdp::~PptToOdp()
 }
 
 QMap<quint16, QString>
-createBulletPictures(const PP9DocBinaryTagExtension* pp9, KoStore* store, KoXmlWriter* manifest)
+createBulletPictures(const PP9DocBinaryTagExtension* pp9, KoStore* store, KoXmlWriter* manifest,
+                     const QMap<QByteArray, QString>& pictureNames)
 {
     QMap<quint16, QString> ids;
     if (!pp9 || !pp9->blipCollectionContainer) {
         return ids;
     }
+    // pictures are named after their content, a bullet may use one saved before
+    QSet<QString> savedNames = pictureNames.values().toSet();
     foreach (const BlipEntityAtom& a, pp9->blipCollectionContainer->rgBlipEntityAtom) {
         PictureReference ref = savePicture(a.blip, store);
         if (ref.name.length() == 0) continue;
         ids[a.rh.recInstance] = "Pictures/" + ref.name;
-        manifest->addManifestEntry(ids[a.rh.recInstance], ref.mimetype);
+        if (!savedNames.contains(ref.name)) {
+            savedNames.insert(ref.name);
+            manifest->addManifestEntry(ids[a.rh.recInstance], ref.mimetype);
+        }
     }
     return ids;
 }
@@ -943,7 +950,7 @@ PptToOdp::doConversion(KoStore* storeout)
     pictureNames = createPictures(storeout, manifest, &p->pictures.anon1.rgfb);
     // read pictures from the PowerPoint Document structures
     bulletPictureNames = createBulletPictures(getPP<PP9DocBinaryTagExtension>(
-            p->documentContainer), storeout, manifest);
+            p->documentContainer), storeout, manifest, pictureNames);
     storeout->leaveDirectory();
     storeout->setCompressionEnabled(true);
 
@@ -602,6 +602,29 @@ KoFilter::ConversionStatus PptxXmlDocumentReader::read_sldMasterId()
     READ_EPILOGUE
 }
 
+void PptxXmlDocumentReader::prefetchSlides()
+{
+    QStringList slides;
+    while (!atEnd()) {
+        readNext();
+        if (isEndElement() && QUALIFIED_NAME_IS(sldIdLst)) {
+            break;
+        }
+        if (isStartElement() && name() == "sldId") {
+            const QString r_id(attributes().value("r:id").toString());
+            QString slidePath, slideFile;
+            MSOOXML::Utils::splitPathAndFile(
+                m_context->relationships->target(m_context->path, m_context->file, r_id),
+                &slidePath, &slideFile);
+            // the same path read_sldId() loads the slide from
+            slides.append(slidePath + '/' + slideFile);
+            skipCurrentElement();
+        }
+    }
+    debugPptx << "prefetching" << slides.count() << "slides";
+    m_context->import->prefetchParts(slides);
+}
+
 #undef CURRENT_EL
 #define CURRENT_EL sldIdLst
 //! p:sldIdLst handler (List of Slide IDs)
@@ -899,6 +922,10 @@ KoFilter::ConversionStatus PptxXmlDocumentReader::read_presentation()
             BREAK_IF_END_OF(CURRENT_EL)
             if (isStartElement()) {
                 TRY_READ_IF(defaultTextStyle)
+                else if (QUALIFIED_NAME_IS(sldIdLst)) {
+                    // inflate the slides while the masters are converted
+                    prefetchSlides();
+                }
                 SKIP_UNKNOWN
             }
         }
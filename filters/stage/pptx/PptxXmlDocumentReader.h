@@ -79,6 +79,9 @@ protected:
     // Locates slide layout information for given slide. Caches the result.
     PptxSlideProperties* slideLayoutProperties(const QString& slidePath, const QString& slideFile);
 
+    // Collects the slides of the current sldIdLst element and has the import prefetch them.
+    void prefetchSlides();
+
     KoOdfWriters *m_writers;
     PptxXmlDocumentReaderContext* m_context;
 
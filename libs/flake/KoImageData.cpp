@@ -252,7 +252,10 @@ void KoImageData::setImage(const QString &url, KoStore *store, KoImageCollection
             KoStoreDevice device(store);
             const bool lossy = url.endsWith(".jpg", Qt::CaseInsensitive) || url.endsWith(".gif", Qt::CaseInsensitive);
             if (!lossy && device.size() < MAX_MEMORY_IMAGESIZE) {
-                QByteArray data = device.readAll();
+                // avoid copying the bytes when the store can hand them out directly
+                QByteArray data = store->mappedData();
+                if (data.isNull())
+                    data = device.readAll();
                 if (d->image.loadFromData(data)) {
                     QCryptographicHash md5(QCryptographicHash::Md5);
                     md5.addData(data);
@@ -103,6 +103,200 @@ void KoShapeManager::Private::paintGroup(KoShapeGroup *group, QPainter &painter,
     }
 }
 
+QImage KoShapeManager::Private::renderFilterEffects(KoShape *shape, const KoViewConverter &converter, KoShapePaintingContext &paintContext,
+                                                   bool antialiasing, QPointF *offset)
+{
+    // There are filter effects, then we need to prerender the shape on an image, to filter it
+    QRectF shapeBound(QPointF(), shape->size());
+    // First step, compute the rectangle used for the image
+    QRectF clipRegion = shape->filterEffectStack()->clipRectForBoundingRect(shapeBound);
+    // convert clip region to view coordinates
+    QRectF zoomedClipRegion = converter.documentToView(clipRegion);
+    // determine the offset of the clipping rect from the shapes origin
+    QPointF clippingOffset = zoomedClipRegion.topLeft();
+
+    // Initialize the buffer image
+    QImage sourceGraphic(zoomedClipRegion.size().toSize(), QImage::Format_ARGB32_Premultiplied);
+    sourceGraphic.fill(qRgba(0,0,0,0));
+
+    QHash<QString, QImage> imageBuffers;
+
+    QSet<QString> requiredStdInputs = shape->filterEffectStack()->requiredStandarsInputs();
+
+    if (requiredStdInputs.contains("SourceGraphic") || requiredStdInputs.contains("SourceAlpha")) {
+        // Init the buffer painter
+        QPainter imagePainter(&sourceGraphic);
+        imagePainter.translate(-1.0f*clippingOffset);
+        imagePainter.setPen(Qt::NoPen);
+        imagePainter.setBrush(Qt::NoBrush);
+        imagePainter.setRenderHint(QPainter::Antialiasing, antialiasing);
+
+        // Paint the shape on the image
+        KoShapeGroup *group = dynamic_cast<KoShapeGroup*>(shape);
+        if (group) {
+            // the childrens matrix contains the groups matrix as well
+            // so we have to compensate for that before painting the children
+            imagePainter.setTransform(group->absoluteTransformation(&converter).inverted(), true);
+            paintGroup(group, imagePainter, converter, paintContext);
+        } else {
+            imagePainter.save();
+            shape->paint(imagePainter, converter, paintContext);
+            imagePainter.restore();
+            if (shape->stroke()) {
+                imagePainter.save();
+                shape->stroke()->paint(shape, imagePainter, converter);
+                imagePainter.restore();
+            }
+            imagePainter.end();
+        }
+    }
+    if (requiredStdInputs.contains("SourceAlpha")) {
+        QImage sourceAlpha = sourceGraphic;
+        sourceAlpha.fill(qRgba(0,0,0,255));
+        sourceAlpha.setAlphaChannel(sourceGraphic.alphaChannel());
+        imageBuffers.insert("SourceAlpha", sourceAlpha);
+    }
+    if (requiredStdInputs.contains("FillPaint")) {
+        QImage fillPaint = sourceGraphic;
+        if (shape->background()) {
+            QPainter fillPainter(&fillPaint);
+            QPainterPath fillPath;
+            fillPath.addRect(fillPaint.rect().adjusted(-1,-1,1,1));
+            shape->background()->paint(fillPainter, converter, paintContext, fillPath);
+        } else {
+            fillPaint.fill(qRgba(0,0,0,0));
+        }
+        imageBuffers.insert("FillPaint", fillPaint);
+    }
+
+    imageBuffers.insert("SourceGraphic", sourceGraphic);
+    imageBuffers.insert(QString(), sourceGraphic);
+
+    KoFilterEffectRenderContext renderContext(converter);
+    renderContext.setShapeBoundingBox(shapeBound);
+
+    QImage result;
+    QList<KoFilterEffect*> filterEffects = shape->filterEffectStack()->filterEffects();
+    // Filter
+    foreach (KoFilterEffect *filterEffect, filterEffects) {
+        QRectF filterRegion = filterEffect->filterRectForBoundingRect(shapeBound);
+        filterRegion = converter.documentToView(filterRegion);
+        QRect subRegion = filterRegion.translated(-clippingOffset).toRect();
+        // set current filter region
+        renderContext.setFilterRegion(subRegion & sourceGraphic.rect());
+
+        if (filterEffect->maximalInputCount() <= 1) {
+            QList<QString> inputs = filterEffect->inputs();
+            QString input = inputs.count() ? inputs.first() : QString();
+            // get input image from image buffers and apply the filter effect
+            QImage image = imageBuffers.value(input);
+            if (!image.isNull()) {
+                result = filterEffect->processImage(imageBuffers.value(input), renderContext);
+            }
+        } else {
+            QVector<QImage> inputImages;
+            foreach(const QString &input, filterEffect->inputs()) {
+                QImage image = imageBuffers.value(input);
+                if (!image.isNull())
+                    inputImages.append(imageBuffers.value(input));
+            }
+            // apply the filter effect
+            if (filterEffect->inputs().count() == inputImages.count())
+                result = filterEffect->processImages(inputImages, renderContext);
+        }
+        // store result of effect
+        imageBuffers.insert(filterEffect->output(), result);
+    }
+
+    *offset = clippingOffset;
+    return imageBuffers.value(filterEffects.last()->output());
+}
+
+KoShapeManager::Private::RasterCache::RasterCache(int budget)
+    : m_cache(budget)
+{
+}
+
+QTransform KoShapeManager::Private::RasterCache::linearPart(const KoShape *shape)
+{
+    // moving a shape doesn't change its rendering, scaling or rotating it does
+    const QTransform m = shape->absoluteTransformation(0);
+    return QTransform(m.m11(), m.m12(), m.m21(), m.m22(), 0, 0);
+}
+
+const QImage *KoShapeManager::Private::RasterCache::find(const KoShape *shape, Kind kind, const KoViewConverter &converter,
+                                                         bool antialiasing, QPointF *offset)
+{
+    Entry *entry = m_cache.object(Key(shape, kind));
+    if (!entry)
+        return 0;
+
+    qreal zoomX, zoomY;
+    converter.zoom(&zoomX, &zoomY);
+    if (entry->zoomX != zoomX || entry->zoomY != zoomY || entry->antialiasing != antialiasing
+            || entry->transformation != linearPart(shape)) {
+        m_cache.remove(Key(shape, kind));
+        m_documentRects.remove(Key(shape, kind));
+        return 0;
+    }
+    *offset = entry->offset;
+    return &entry->image;
+}
+
+void KoShapeManager::Private::RasterCache::insert(const KoShape *shape, Kind kind, const KoViewConverter &converter, bool antialiasing,
+                                                  const QImage &image, const QPointF &offset, const QRectF &documentRect)
+{
+    Entry *entry = new Entry;
+    entry->image = image;
+    entry->offset = offset;
+    converter.zoom(&entry->zoomX, &entry->zoomY);
+    entry->transformation = linearPart(shape);
+    entry->antialiasing = antialiasing;
+    // images bigger than the budget are simply not cached
+    if (!m_cache.insert(Key(shape, kind), entry, image.byteCount() / 1024 + 1)) {
+        m_documentRects.remove(Key(shape, kind));
+        return;
+    }
+    m_documentRects.insert(Key(shape, kind), documentRect);
+    // forget the entries the cache evicted to make room
+    if (m_documentRects.count() > m_cache.count()) {
+        QHash<Key, QRectF>::Iterator it = m_documentRects.begin();
+        while (it != m_documentRects.end()) {
+            if (m_cache.contains(it.key()))
+                ++it;
+            else
+                it = m_documentRects.erase(it);
+        }
+    }
+}
+
+void KoShapeManager::Private::RasterCache::invalidate(const KoShape *shape)
+{
+    if (m_documentRects.isEmpty())
+        return;
+    // containers render their children into their filter effects and shadows
+    for (const KoShape *s = shape; s; s = s->parent()) {
+        m_cache.remove(Key(s, FilterEffects));
+        m_cache.remove(Key(s, Shadow));
+        m_documentRects.remove(Key(s, FilterEffects));
+        m_documentRects.remove(Key(s, Shadow));
+    }
+}
+
+void KoShapeManager::Private::RasterCache::invalidate(const QRectF &documentRect)
+{
+    // m_cache.object() would move every entry it is asked for to the front of the LRU order
+    QHash<Key, QRectF>::Iterator it = m_documentRects.begin();
+    while (it != m_documentRects.end()) {
+        if (it.value().intersects(documentRect)) {
+            m_cache.remove(it.key());
+            it = m_documentRects.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 KoShapeManager::KoShapeManager(KoCanvasBase *canvas, const QList<KoShape *> &shapes)
         : d(new Private(this, canvas))
 {
@@ -192,6 +386,7 @@ void KoShapeManager::remove(KoShape *shape)
 
     shape->update();
     shape->priv()->removeShapeManager(this);
+    d->rasterCache.invalidate(shape);
     d->selection->deselect(shape);
     d->aggregate4update.remove(shape);
     d->tree.remove(shape);
@@ -301,10 +496,19 @@ void KoShapeManager::paintShape(KoShape *shape, QPainter &painter, const KoViewC
         painter.setOpacity(1.0-transparency);
     }
 
-    if (shape->shadow()) {
-        painter.save();
-        shape->shadow()->paint(shape, painter, converter);
-        painter.restore();
+    const bool antialiasing = painter.testRenderHint(QPainter::Antialiasing);
+
+    if (shape->shadow() && shape->shadow()->isVisible()) {
+        QPointF unused;
+        const QImage *shadow = d->rasterCache.find(shape, Private::RasterCache::Shadow, converter, antialiasing, &unused);
+        if (!shadow) {
+            const QImage image = shape->shadow()->renderImage(shape, converter, antialiasing);
+            d->rasterCache.insert(shape, Private::RasterCache::Shadow, converter, antialiasing,
+                                  image, QPointF(), shape->boundingRect());
+            shape->shadow()->paintImage(shape, painter, converter, image);
+        } else {
+            shape->shadow()->paintImage(shape, painter, converter, *shadow);
+        }
     }
     if (!shape->filterEffectStack() || shape->filterEffectStack()->isEmpty()) {
         painter.save();
@@ -316,113 +520,20 @@ void KoShapeManager::paintShape(KoShape *shape, QPainter &painter, const KoViewC
             painter.restore();
         }
     } else {
-        // There are filter effects, then we need to prerender the shape on an image, to filter it
-        QRectF shapeBound(QPointF(), shape->size());
-        // First step, compute the rectangle used for the image
-        QRectF clipRegion = shape->filterEffectStack()->clipRectForBoundingRect(shapeBound);
-        // convert clip region to view coordinates
-        QRectF zoomedClipRegion = converter.documentToView(clipRegion);
-        // determine the offset of the clipping rect from the shapes origin
-        QPointF clippingOffset = zoomedClipRegion.topLeft();
-
-        // Initialize the buffer image
-        QImage sourceGraphic(zoomedClipRegion.size().toSize(), QImage::Format_ARGB32_Premultiplied);
-        sourceGraphic.fill(qRgba(0,0,0,0));
-
-        QHash<QString, QImage> imageBuffers;
-
-        QSet<QString> requiredStdInputs = shape->filterEffectStack()->requiredStandarsInputs();
-
-        if (requiredStdInputs.contains("SourceGraphic") || requiredStdInputs.contains("SourceAlpha")) {
-            // Init the buffer painter
-            QPainter imagePainter(&sourceGraphic);
-            imagePainter.translate(-1.0f*clippingOffset);
-            imagePainter.setPen(Qt::NoPen);
-            imagePainter.setBrush(Qt::NoBrush);
-            imagePainter.setRenderHint(QPainter::Antialiasing, painter.testRenderHint(QPainter::Antialiasing));
-
-            // Paint the shape on the image
-            KoShapeGroup *group = dynamic_cast<KoShapeGroup*>(shape);
-            if (group) {
-                // the childrens matrix contains the groups matrix as well
-                // so we have to compensate for that before painting the children
-                imagePainter.setTransform(group->absoluteTransformation(&converter).inverted(), true);
-                d->paintGroup(group, imagePainter, converter, paintContext);
-            } else {
-                imagePainter.save();
-                shape->paint(imagePainter, converter, paintContext);
-                imagePainter.restore();
-                if (shape->stroke()) {
-                    imagePainter.save();
-                    shape->stroke()->paint(shape, imagePainter, converter);
-                    imagePainter.restore();
-                }
-                imagePainter.end();
-            }
-        }
-        if (requiredStdInputs.contains("SourceAlpha")) {
-            QImage sourceAlpha = sourceGraphic;
-            sourceAlpha.fill(qRgba(0,0,0,255));
-            sourceAlpha.setAlphaChannel(sourceGraphic.alphaChannel());
-            imageBuffers.insert("SourceAlpha", sourceAlpha);
-        }
-        if (requiredStdInputs.contains("FillPaint")) {
-            QImage fillPaint = sourceGraphic;
-            if (shape->background()) {
-                QPainter fillPainter(&fillPaint);
-                QPainterPath fillPath;
-                fillPath.addRect(fillPaint.rect().adjusted(-1,-1,1,1));
-                shape->background()->paint(fillPainter, converter, paintContext, fillPath);
-            } else {
-                fillPaint.fill(qRgba(0,0,0,0));
-            }
-            imageBuffers.insert("FillPaint", fillPaint);
-        }
-
-        imageBuffers.insert("SourceGraphic", sourceGraphic);
-        imageBuffers.insert(QString(), sourceGraphic);
-
-        KoFilterEffectRenderContext renderContext(converter);
-        renderContext.setShapeBoundingBox(shapeBound);
-
+        QPointF clippingOffset;
+        const QImage *cached = d->rasterCache.find(shape, Private::RasterCache::FilterEffects, converter, antialiasing, &clippingOffset);
         QImage result;
-        QList<KoFilterEffect*> filterEffects = shape->filterEffectStack()->filterEffects();
-        // Filter
-        foreach (KoFilterEffect *filterEffect, filterEffects) {
-            QRectF filterRegion = filterEffect->filterRectForBoundingRect(shapeBound);
-            filterRegion = converter.documentToView(filterRegion);
-            QRect subRegion = filterRegion.translated(-clippingOffset).toRect();
-            // set current filter region
-            renderContext.setFilterRegion(subRegion & sourceGraphic.rect());
-
-            if (filterEffect->maximalInputCount() <= 1) {
-                QList<QString> inputs = filterEffect->inputs();
-                QString input = inputs.count() ? inputs.first() : QString();
-                // get input image from image buffers and apply the filter effect
-                QImage image = imageBuffers.value(input);
-                if (!image.isNull()) {
-                    result = filterEffect->processImage(imageBuffers.value(input), renderContext);
-                }
-            } else {
-                QVector<QImage> inputImages;
-                foreach(const QString &input, filterEffect->inputs()) {
-                    QImage image = imageBuffers.value(input);
-                    if (!image.isNull())
-                        inputImages.append(imageBuffers.value(input));
-                }
-                // apply the filter effect
-                if (filterEffect->inputs().count() == inputImages.count())
-                    result = filterEffect->processImages(inputImages, renderContext);
-            }
-            // store result of effect
-            imageBuffers.insert(filterEffect->output(), result);
+        if (!cached) {
+            result = d->renderFilterEffects(shape, converter, paintContext, antialiasing, &clippingOffset);
+            const QRectF clipRect = shape->filterEffectStack()->clipRectForBoundingRect(QRectF(QPointF(), shape->size()));
+            d->rasterCache.insert(shape, Private::RasterCache::FilterEffects, converter, antialiasing,
+                                  result, clippingOffset, shape->absoluteTransformation(0).mapRect(clipRect));
+            cached = &result;
         }
 
-        KoFilterEffect *lastEffect = filterEffects.last();
-
         // Paint the result
         painter.save();
-        painter.drawImage(clippingOffset, imageBuffers.value(lastEffect->output()));
+        painter.drawImage(clippingOffset, *cached);
         painter.restore();
     }
 }
@@ -499,6 +610,11 @@ QList<KoShape *> KoShapeManager::shapesAt(const QRectF &rect, bool omitHiddenSha
 
 void KoShapeManager::update(QRectF &rect, const KoShape *shape, bool selectionHandles)
 {
+    if (shape) {
+        d->rasterCache.invalidate(shape);
+    } else {
+        d->rasterCache.invalidate(rect);
+    }
     d->canvas->updateCanvas(rect);
     if (selectionHandles && d->selection->isSelected(shape)) {
         if (d->canvas->toolProxy())
@@ -512,6 +628,7 @@ void KoShapeManager::notifyShapeChanged(KoShape *shape)
     if (d->aggregate4update.contains(shape) || d->additionalShapes.contains(shape)) {
         return;
     }
+    d->rasterCache.invalidate(shape);
     const bool wasEmpty = d->aggregate4update.isEmpty();
     d->aggregate4update.insert(shape);
     d->shapeIndexesBeforeUpdate.insert(shape, shape->zIndex());
@@ -43,6 +43,8 @@
 #include "KoClipPath.h"
 #include "KoShapePaintingContext.h"
 
+#include <QCache>
+#include <QHash>
 #include <QPainter>
 #include <QTimer>
 #include <FlakeDebug.h>
@@ -55,6 +57,7 @@ public:
           canvas(c),
           tree(4, 2),
           strategy(new KoShapeManagerPaintingStrategy(shapeManager)),
+          rasterCache(64 * 1024),
           q(shapeManager)
     {
     }
@@ -77,6 +80,57 @@ public:
      */
     void paintGroup(KoShapeGroup *group, QPainter &painter, const KoViewConverter &converter, KoShapePaintingContext &paintContext);
 
+    /**
+     * Renders the shape, or the group with its children, and runs its filter effect stack on it.
+     * @param offset set to where the result has to be painted, in view coordinates relative to the shape
+     */
+    QImage renderFilterEffects(KoShape *shape, const KoViewConverter &converter, KoShapePaintingContext &paintContext,
+                               bool antialiasing, QPointF *offset);
+
+    /**
+     * Caches the rasterized output of filter effects and shadows per shape,
+     * so they are not rendered again on every paint, e.g. while scrolling.
+     * An entry is only used for the zoom, shape scale/rotation and antialiasing
+     * it was rendered with. Entries are dropped when the shape or one of its
+     * children changes; the least recently used ones go first when the memory
+     * budget is exceeded.
+     */
+    class RasterCache
+    {
+    public:
+        enum Kind { FilterEffects, Shadow };
+
+        /// @param budget the memory budget in KiB
+        explicit RasterCache(int budget);
+
+        /// @return the cached image or 0, @p offset is set to where it has to be painted
+        const QImage *find(const KoShape *shape, Kind kind, const KoViewConverter &converter, bool antialiasing, QPointF *offset);
+        /// @param documentRect the area covered by the image, in document coordinates
+        void insert(const KoShape *shape, Kind kind, const KoViewConverter &converter, bool antialiasing,
+                    const QImage &image, const QPointF &offset, const QRectF &documentRect);
+        /// Drops the entries of @p shape and of the containers it is part of
+        void invalidate(const KoShape *shape);
+        /// Drops the entries covering @p documentRect
+        void invalidate(const QRectF &documentRect);
+
+    private:
+        struct Entry {
+            QImage image;
+            QPointF offset;
+            qreal zoomX;
+            qreal zoomY;
+            QTransform transformation;
+            bool antialiasing;
+        };
+        typedef QPair<const KoShape *, int> Key;
+
+        static QTransform linearPart(const KoShape *shape);
+
+        QCache<Key, Entry> m_cache;
+        /// the area covered by each entry, kept outside the cache so looking it up does not touch the LRU order
+        QHash<Key, QRectF> m_documentRects;
+    };
+
     class DetectCollision
     {
     public:
@@ -117,6 +171,7 @@ public:
     QSet<KoShape *> aggregate4update;
     QHash<KoShape*, int> shapeIndexesBeforeUpdate;
     KoShapeManagerPaintingStrategy *strategy;
+    RasterCache rasterCache;
     KoShapeManager *q;
 };
 
@@ -232,6 +232,12 @@ void KoShapeShadow::paint(KoShape *shape, QPainter &painter, const KoViewConvert
     if (! d->visible)
         return;
 
+    const QImage image = renderImage(shape, converter, painter.testRenderHint(QPainter::Antialiasing));
+    paintImage(shape, painter, converter, image);
+}
+
+QImage KoShapeShadow::renderImage(KoShape *shape, const KoViewConverter &converter, bool antialiasing) const
+{
     // So the approach we are taking here is to draw into a buffer image the size of boundingRect
     // We offset by the shadow offset at the time we draw into the buffer
     // Then we filter the image and draw it at the position of the bounding rect on canvas
@@ -247,7 +253,7 @@ void KoShapeShadow::paint(KoShape *shape, QPainter &painter, const KoViewConvert
     QPainter imagePainter(&sourceGraphic);
     imagePainter.setPen(Qt::NoPen);
     imagePainter.setBrush(Qt::NoBrush);
-    imagePainter.setRenderHint(QPainter::Antialiasing, painter.testRenderHint(QPainter::Antialiasing));
+    imagePainter.setRenderHint(QPainter::Antialiasing, antialiasing);
     // Since our imagebuffer and the canvas don't align we need to offset our drawings
     imagePainter.translate(-1.0f*converter.documentToView(shadowRect.topLeft()));
 
@@ -268,12 +274,19 @@ void KoShapeShadow::paint(KoShape *shape, QPainter &painter, const KoViewConvert
     // Blur the shadow (well the entire buffer)
     d->blurShadow(sourceGraphic, converter.documentToViewX(d->blur), d->color);
 
+    return sourceGraphic;
+}
+
+void KoShapeShadow::paintImage(KoShape *shape, QPainter &painter, const KoViewConverter &converter, const QImage &image) const
+{
+    QRectF zoomedClipRegion = converter.documentToView(shape->boundingRect());
+
     // Paint the result
     painter.save();
     // The painter is initialized for us with canvas transform 'plus' shape transform
     // we are only interested in the canvas transform so 'subtract' the shape transform part
     painter.setTransform(shape->absoluteTransformation(&converter).inverted() * painter.transform());
-    painter.drawImage(zoomedClipRegion.topLeft(), sourceGraphic);
+    painter.drawImage(zoomedClipRegion.topLeft(), image);
     painter.restore();
 }
 
@@ -31,6 +31,7 @@ class KoShapeSavingContext;
 class QPainter;
 class QPointF;
 class QColor;
+class QImage;
 class KoViewConverter;
 struct KoInsets;
 
@@ -58,6 +59,25 @@ public:
      */
     void paint(KoShape *shape, QPainter &painter, const KoViewConverter &converter);
 
+    /**
+     * Renders the blurred shadow of the shape into an image in view coordinates.
+     * paint() is renderImage() followed by paintImage(); callers that want to
+     * keep the image around, e.g. to cache it, can use them separately.
+     * @param shape the shape to render the shadow of
+     * @param converter to convert between internal and view coordinates.
+     * @param antialiasing whether to antialias the shadow outline
+     */
+    QImage renderImage(KoShape *shape, const KoViewConverter &converter, bool antialiasing) const;
+
+    /**
+     * Paints an image created by renderImage() for the same shape and zoom.
+     * @param shape the shape to paint around
+     * @param painter the painter to paint shadows to canvas
+     * @param converter to convert between internal and view coordinates.
+     * @param image the rendered shadow
+     */
+    void paintImage(KoShape *shape, QPainter &painter, const KoViewConverter &converter, const QImage &image) const;
+
     /**
      * Sets the shadow offset from the topleft corner of the shape
      * @param offset the shadow offset
@@ -23,6 +23,8 @@
 #include "KoShapeContainer.h"
 #include "KoShapeManager.h"
 #include "KoShapePaintingContext.h"
+#include "KoFilterEffect.h"
+#include "KoFilterEffectStack.h"
 
 #include <MockShapes.h>
 
@@ -251,4 +253,73 @@ void TestShapePainting::testPaintOrder()
     delete root;
 }
 
+void TestShapePainting::testRasterCacheOrder()
+{
+    // the shape manager keeps the filter effect output of shapes in a cache
+    // with a budget of 64 MiB; this checks that an update of an area covering
+    // none of the cached images neither drops them nor changes which one is
+    // evicted first.
+
+    class PassThroughEffect : public KoFilterEffect {
+    public:
+        PassThroughEffect() : KoFilterEffect("PassThroughEffect", "PassThroughEffect") {
+            setRequiredInputCount(1); // the source graphic
+        }
+    };
+
+    // with the default clip rect each shape is rendered into a 2100 x 2100
+    // image of about 17 MiB, so the cache holds three of them
+    QList<MockShape*> shapes;
+    for (int i = 0; i < 4; ++i) {
+        MockShape *shape = new MockShape();
+        shape->setSize(QSizeF(1750, 1750));
+        shape->setPosition(QPointF(i * 2500, 0));
+        KoFilterEffectStack *stack = new KoFilterEffectStack();
+        stack->appendFilterEffect(new PassThroughEffect());
+        shape->setFilterEffectStack(stack);
+        shapes.append(shape);
+    }
+
+    MockCanvas canvas;
+    KoShapeManager manager(&canvas);
+    foreach (MockShape *shape, shapes)
+        manager.addShape(shape);
+
+    QImage image(100, 100, QImage::Format_ARGB32_Premultiplied);
+    QPainter painter(&image);
+    KoViewConverter vc;
+    KoShapePaintingContext paintContext;
+
+    // rendering the filter effects paints the shape, a cached result does not
+    for (int i = 0; i < 3; ++i)
+        manager.paintShape(shapes[i], painter, vc, paintContext);
+    for (int i = 0; i < 3; ++i)
+        manager.paintShape(shapes[i], painter, vc, paintContext);
+    QCOMPARE(shapes[0]->paintedCount, 1);
+    QCOMPARE(shapes[1]->paintedCount, 1);
+    QCOMPARE(shapes[2]->paintedCount, 1);
+
+    QRectF elsewhere(0, 10000, 10, 10);
+    manager.update(elsewhere);
+
+    // the least recently used image is the one of the first shape
+    manager.paintShape(shapes[3], painter, vc, paintContext);
+    QCOMPARE(shapes[3]->paintedCount, 1);
+    manager.paintShape(shapes[2], painter, vc, paintContext);
+    manager.paintShape(shapes[1], painter, vc, paintContext);
+    QCOMPARE(shapes[2]->paintedCount, 1);
+    QCOMPARE(shapes[1]->paintedCount, 1);
+    manager.paintShape(shapes[0], painter, vc, paintContext);
+    QCOMPARE(shapes[0]->paintedCount, 2);
+
+    // an update of the area of a cached image drops it
+    QRectF covered(2600, 100, 10, 10);
+    manager.update(covered);
+    manager.paintShape(shapes[1], painter, vc, paintContext);
+    QCOMPARE(shapes[1]->paintedCount, 2);
+
+    painter.end();
+    qDeleteAll(shapes);
+}
+
 QTEST_MAIN(TestShapePainting)
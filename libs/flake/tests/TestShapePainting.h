@@ -30,6 +30,7 @@ private Q_SLOTS:
     void testPaintShape();
     void testPaintHiddenShape();
     void testPaintOrder();
+    void testRasterCacheOrder();
 };
 
 #endif
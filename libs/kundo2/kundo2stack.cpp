@@ -405,6 +405,30 @@ bool KUndo2Command::isMerged()
     return !m_mergeCommandsVector.isEmpty();
 }
 
+/*!
+    Returns an estimate of the memory in bytes this command keeps for undoing
+    and redoing, including its child commands and the commands merged into it.
+
+    Used by KUndo2QStack to keep the stack within its memoryLimit. The stack
+    asks for the cost when the command is pushed and once more when the next
+    command is pushed, so children added in between are counted. Commands
+    that store large amounts of undo data should reimplement this function
+    and add the size of that data to the value returned here.
+
+    \sa KUndo2QStack::setMemoryLimit()
+*/
+qint64 KUndo2Command::memoryCost() const
+{
+    qint64 cost = sizeof(KUndo2Command) + sizeof(KUndo2CommandPrivate);
+    foreach (const KUndo2Command *child, d->child_list) {
+        cost += child->memoryCost();
+    }
+    foreach (const KUndo2Command *merged, m_mergeCommandsVector) {
+        cost += merged->memoryCost();
+    }
+    return cost;
+}
+
 KUndo2CommandExtraData* KUndo2Command::extraData() const
 {
     return d->extraData.data();
@@ -566,7 +590,7 @@ void KUndo2QStack::purgeRedoState()
     bool cleanStateChanged = false;
 
     while (m_index < m_command_list.size()) {
-        delete m_command_list.takeLast();
+        delete forgetMemoryCost(m_command_list.takeLast());
         redoStateChanged = true;
     }
 
@@ -586,21 +610,38 @@ void KUndo2QStack::purgeRedoState()
 }
 
 /*! \internal
-    If the number of commands on the stack exceedes the undo limit, deletes commands from
-    the bottom of the stack.
+    If the number of commands on the stack exceedes the undo limit, or the commands
+    need more memory than the memory limit, deletes commands from the bottom of the
+    stack. The most recent command is always kept.
+
+    The memory of the commands is kept as a running total. Only the most recent
+    command is counted again here, as commands may still grow after they were pushed.
 
     Returns true if commands were deleted.
 */
 
 bool KUndo2QStack::checkUndoLimit()
 {
-    if (m_undo_limit <= 0 || !m_macro_stack.isEmpty() || m_undo_limit >= m_command_list.count())
+    if (!m_macro_stack.isEmpty() || m_command_list.isEmpty())
         return false;
 
-    int del_count = m_command_list.count() - m_undo_limit;
+    int del_count = 0;
+    if (m_undo_limit > 0 && m_undo_limit < m_command_list.count())
+        del_count = m_command_list.count() - m_undo_limit;
 
     for (int i = 0; i < del_count; ++i)
-        delete m_command_list.takeFirst();
+        delete forgetMemoryCost(m_command_list.takeFirst());
+
+    if (m_memory_limit > 0) {
+        updateMemoryCost(m_command_list.last());
+        while (m_memory_cost > m_memory_limit && m_command_list.count() > 1) {
+            delete forgetMemoryCost(m_command_list.takeFirst());
+            ++del_count;
+        }
+    }
+
+    if (del_count == 0)
+        return false;
 
     m_index -= del_count;
     if (m_clean_index != -1) {
@@ -612,6 +653,32 @@ bool KUndo2QStack::checkUndoLimit()
     return true;
 }
 
+/*! \internal
+    Counts the memoryCost() of \a cmd, a command on the stack, again.
+*/
+
+void KUndo2QStack::updateMemoryCost(KUndo2Command *cmd)
+{
+    if (m_memory_limit <= 0)
+        return;
+
+    const qint64 cost = cmd->memoryCost();
+    m_memory_cost += cost - cmd->d->stackMemoryCost;
+    cmd->d->stackMemoryCost = cost;
+}
+
+/*! \internal
+    Removes the memory counted for \a cmd, which is taken from the stack, and
+    returns \a cmd.
+*/
+
+KUndo2Command *KUndo2QStack::forgetMemoryCost(KUndo2Command *cmd)
+{
+    m_memory_cost -= cmd->d->stackMemoryCost;
+    cmd->d->stackMemoryCost = 0;
+    return cmd;
+}
+
 /*!
     Constructs an empty undo stack with the parent \a parent. The
     stack will initially be in the clean state. If \a parent is a
@@ -621,7 +688,7 @@ bool KUndo2QStack::checkUndoLimit()
 */
 
 KUndo2QStack::KUndo2QStack(QObject *parent)
-    : QObject(parent), m_index(0), m_clean_index(0), m_group(0), m_undo_limit(0), m_useCumulativeUndoRedo(false), m_lastMergedSetCount(0), m_lastMergedIndex(0)
+    : QObject(parent), m_index(0), m_clean_index(0), m_group(0), m_undo_limit(0), m_memory_limit(0), m_memory_cost(0), m_useCumulativeUndoRedo(false), m_lastMergedSetCount(0), m_lastMergedIndex(0)
 {
     setTimeT1(5);
     setTimeT2(1);
@@ -673,6 +740,7 @@ void KUndo2QStack::clear()
     m_macro_stack.clear();
     qDeleteAll(m_command_list);
     m_command_list.clear();
+    m_memory_cost = 0;
 
     m_index = 0;
     m_clean_index = 0;
@@ -727,7 +795,7 @@ bool KUndo2QStack::push(KUndo2Command *cmd)
         if (m_index > 0)
             cur = m_command_list.at(m_index - 1);
         while (m_index < m_command_list.size())
-            delete m_command_list.takeLast();
+            delete forgetMemoryCost(m_command_list.takeLast());
         if (m_clean_index > m_index)
             m_clean_index = -1; // we've deleted the clean state
     }
@@ -763,7 +831,8 @@ bool KUndo2QStack::push(KUndo2Command *cmd)
             KUndo2Command* toMerge = m_command_list.at(m_lastMergedIndex);
             if (toMerge && m_command_list.size() >= m_lastMergedIndex + 1 && m_command_list.at(m_lastMergedIndex + 1)) {
                 if(toMerge->timedMergeWith(m_command_list.at(m_lastMergedIndex + 1))){
-                    m_command_list.removeAt(m_lastMergedIndex + 1);
+                    forgetMemoryCost(m_command_list.takeAt(m_lastMergedIndex + 1));
+                    updateMemoryCost(toMerge);
                 }
                 m_lastMergedSetCount--;
                 m_lastMergedIndex = m_command_list.indexOf(toMerge);       
@@ -786,6 +855,8 @@ bool KUndo2QStack::push(KUndo2Command *cmd)
                             if(lastcmd->timedMergeWith(curr)){
                                 if (m_command_list.contains(curr)) {
                                     m_command_list.removeOne(curr);
+                                    forgetMemoryCost(curr);
+                                    updateMemoryCost(lastcmd);
                                 }
                              }
                         } else {
@@ -796,6 +867,8 @@ bool KUndo2QStack::push(KUndo2Command *cmd)
                             if(lastcmd->timedMergeWith(curr)){
                                 if (m_command_list.contains(curr)){
                                     m_command_list.removeOne(curr);
+                                    forgetMemoryCost(curr);
+                                    updateMemoryCost(lastcmd);
                                 }
                             }
                         } else {
@@ -812,6 +885,9 @@ bool KUndo2QStack::push(KUndo2Command *cmd)
         delete cmd;
         cmd = 0;
         if (!macro) {
+            // the merged command grew, which may take the stack over its memory limit
+            if (checkUndoLimit())
+                m_lastMergedIndex = m_index - m_strokesN;
             emit indexChanged(m_index);
             emit canUndoChanged(canUndo());
             emit undoTextChanged(undoText());
@@ -822,6 +898,10 @@ bool KUndo2QStack::push(KUndo2Command *cmd)
         if (macro) {
             m_macro_stack.last()->d->child_list.append(cmd);
         } else {
+            // commands may still grow after they were pushed, e.g. text edit
+            // commands get their children added while the user is typing
+            if (cur)
+                updateMemoryCost(cur);
             m_command_list.append(cmd);
             if(checkUndoLimit())
             {
@@ -1157,9 +1237,11 @@ void KUndo2QStack::beginMacro(const KUndo2MagicString &text)
 
     if (m_macro_stack.isEmpty()) {
         while (m_index < m_command_list.size())
-            delete m_command_list.takeLast();
+            delete forgetMemoryCost(m_command_list.takeLast());
         if (m_clean_index > m_index)
             m_clean_index = -1; // we've deleted the clean state
+        if (m_index > 0)
+            updateMemoryCost(m_command_list.at(m_index - 1));
         m_command_list.append(cmd);
     } else {
         m_macro_stack.last()->d->child_list.append(cmd);
@@ -1263,6 +1345,33 @@ int KUndo2QStack::undoLimit() const
     return m_undo_limit;
 }
 
+/*!
+    \property KUndo2QStack::memoryLimit
+    \brief the maximum memory in bytes the commands on this stack may use.
+
+    When the commands on a stack together report a larger KUndo2Command::memoryCost()
+    than the stack's memoryLimit, commands are deleted from the bottom of the stack
+    until the rest fits. The most recent command is always kept, even if it alone
+    exceeds the limit. The default value is 0, which means that there is no limit.
+
+    Like undoLimit, this property may only be set when the undo stack is empty.
+*/
+
+void KUndo2QStack::setMemoryLimit(qint64 bytes)
+{
+    if (!m_command_list.isEmpty()) {
+        qWarning("KUndo2QStack::setMemoryLimit(): a memory limit can only be set when the stack is empty");
+        return;
+    }
+
+    m_memory_limit = bytes;
+}
+
+qint64 KUndo2QStack::memoryLimit() const
+{
+    return m_memory_limit;
+}
+
 /*!
     \property KUndo2QStack::active
     \brief the active status of this stack.
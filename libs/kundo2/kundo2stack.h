@@ -137,6 +137,8 @@ public:
      */
     void addCommand(KUndo2Command *command);
 
+    virtual qint64 memoryCost() const;
+
 private:
     Q_DISABLE_COPY(KUndo2Command)
     friend class KUndo2QStack;
@@ -160,6 +162,7 @@ class KUNDO2_EXPORT KUndo2QStack : public QObject
 //    Q_DECLARE_PRIVATE(KUndo2QStack)
     Q_PROPERTY(bool active READ isActive WRITE setActive)
     Q_PROPERTY(int undoLimit READ undoLimit WRITE setUndoLimit)
+    Q_PROPERTY(qint64 memoryLimit READ memoryLimit WRITE setMemoryLimit)
 
 public:
     explicit KUndo2QStack(QObject *parent = 0);
@@ -193,6 +196,9 @@ public:
     void setUndoLimit(int limit);
     int undoLimit() const;
 
+    void setMemoryLimit(qint64 bytes);
+    qint64 memoryLimit() const;
+
     const KUndo2Command *command(int index) const;
 
     void setUseCumulativeUndoRedo(bool value);
@@ -233,6 +239,8 @@ private:
     int m_clean_index;
     KUndo2Group *m_group;
     int m_undo_limit;
+    qint64 m_memory_limit;
+    qint64 m_memory_cost; // of the commands on the stack, as last counted
     bool m_useCumulativeUndoRedo;
     double m_timeT1;
     double m_timeT2;
@@ -243,6 +251,8 @@ private:
     // also from QUndoStackPrivate
     void setIndex(int idx, bool clean);
     bool checkUndoLimit();
+    void updateMemoryCost(KUndo2Command *cmd);
+    KUndo2Command *forgetMemoryCost(KUndo2Command *cmd);
 
     Q_DISABLE_COPY(KUndo2QStack)
     friend class KUndo2Group;
@@ -64,11 +64,12 @@ class KUndo2Command;
 class KUndo2CommandPrivate
 {
 public:
-    KUndo2CommandPrivate() : id(-1) {}
+    KUndo2CommandPrivate() : id(-1), stackMemoryCost(0) {}
     QList<KUndo2Command*> child_list;
     QString actionText;
     KUndo2MagicString text;
     int id;
+    qint64 stackMemoryCost; // the memoryCost() the stack counted for this command
 
     QScopedPointer<KUndo2CommandExtraData> extraData;
 };
@@ -0,0 +1,150 @@
+/* This file is part of the KDE project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "TestKUndo2Stack.h"
+
+#include <kundo2qstack.h>
+
+#include <QTest>
+
+/// a command keeping @p cost bytes, which merges with others of the same id
+class CostCommand : public KUndo2Command
+{
+public:
+    CostCommand(qint64 cost, int id = -1)
+        : m_cost(cost)
+        , m_id(id)
+    {
+    }
+
+    int id() const { return m_id; }
+
+    bool mergeWith(const KUndo2Command *other)
+    {
+        m_cost += static_cast<const CostCommand*>(other)->m_cost;
+        return true;
+    }
+
+    qint64 memoryCost() const { return m_cost; }
+
+    qint64 m_cost;
+    int m_id;
+};
+
+void TestKUndo2Stack::testMemoryLimitOnPush()
+{
+    KUndo2QStack stack;
+    stack.setMemoryLimit(1000);
+
+    stack.push(new CostCommand(400));
+    stack.push(new CostCommand(400));
+    QCOMPARE(stack.count(), 2);
+
+    // 1200 bytes, the oldest command has to go
+    stack.push(new CostCommand(400));
+    QCOMPARE(stack.count(), 2);
+    QCOMPARE(stack.index(), 2);
+
+    stack.push(new CostCommand(100));
+    QCOMPARE(stack.count(), 3);
+    QCOMPARE(stack.index(), 3);
+}
+
+void TestKUndo2Stack::testMemoryLimitOnMerge()
+{
+    KUndo2QStack stack;
+    stack.setMemoryLimit(1000);
+
+    stack.push(new CostCommand(300));
+    stack.push(new CostCommand(300, 1));
+    QCOMPARE(stack.count(), 2);
+
+    // merged into the second command, which then takes 600 bytes
+    stack.push(new CostCommand(300, 1));
+    QCOMPARE(stack.count(), 2);
+
+    // 1200 bytes after this merge, so the first command has to go
+    stack.push(new CostCommand(300, 1));
+    QCOMPARE(stack.count(), 1);
+    QCOMPARE(stack.index(), 1);
+    QCOMPARE(static_cast<const CostCommand*>(stack.command(0))->m_cost, qint64(900));
+}
+
+void TestKUndo2Stack::testMemoryLimitKeepsLastCommand()
+{
+    KUndo2QStack stack;
+    stack.setMemoryLimit(1000);
+
+    stack.push(new CostCommand(100));
+    stack.push(new CostCommand(5000));
+    QCOMPARE(stack.count(), 1);
+    QCOMPARE(stack.index(), 1);
+    QVERIFY(stack.canUndo());
+
+    // the big command is counted, so the next one pushes it out
+    stack.push(new CostCommand(100));
+    QCOMPARE(stack.count(), 1);
+    QCOMPARE(stack.command(0)->memoryCost(), qint64(100));
+}
+
+void TestKUndo2Stack::testGrowingCommand()
+{
+    KUndo2QStack stack;
+    stack.setMemoryLimit(1000);
+
+    stack.push(new CostCommand(100));
+    CostCommand *growing = new CostCommand(100);
+    stack.push(growing);
+    QCOMPARE(stack.count(), 2);
+
+    // like a text command getting its children while the user types
+    growing->m_cost = 700;
+    stack.push(new CostCommand(300));
+    QCOMPARE(stack.count(), 2);
+    QCOMPARE(stack.command(0), growing);
+
+    // the undone commands are dropped from the count too
+    stack.undo();
+    stack.push(new CostCommand(200));
+    QCOMPARE(stack.count(), 2);
+    QCOMPARE(stack.command(0), growing);
+
+    stack.clear();
+    stack.push(new CostCommand(600));
+    stack.push(new CostCommand(300));
+    QCOMPARE(stack.count(), 2);
+}
+
+void TestKUndo2Stack::testUndoLimitAndMemoryLimit()
+{
+    KUndo2QStack stack;
+    stack.setUndoLimit(3);
+    stack.setMemoryLimit(1000);
+
+    for (int i = 0; i < 5; ++i) {
+        stack.push(new CostCommand(100));
+    }
+    QCOMPARE(stack.count(), 3);
+
+    // the undo limit drops one command, the memory limit another one
+    stack.push(new CostCommand(900));
+    QCOMPARE(stack.count(), 2);
+    QCOMPARE(stack.index(), 2);
+}
+
+QTEST_MAIN(TestKUndo2Stack)
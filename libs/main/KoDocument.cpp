@@ -69,6 +69,8 @@
 #include <QFileInfo>
 #include <QPainter>
 #include <QTimer>
+#include <QRunnable>
+#include <QThreadPool>
 #ifndef QT_NO_DBUS
 #include <KJobWidgets>
 #include <QDBusConnection>
@@ -131,6 +133,36 @@ public:
 }
 
 
+namespace {
+
+/**
+ * Finishes an autosave. The document content is already serialized when the
+ * store is handed over: finished entries were written to the temporary file
+ * on the GUI thread, the rest is pending in the store. Finalizing only
+ * compresses and writes those and commits the file, without touching the
+ * document. The store is used by one thread at a time, the GUI thread up to
+ * the hand-over through the pool and this job after it.
+ */
+class AutoSaveFinalizer : public QRunnable
+{
+public:
+    AutoSaveFinalizer(KoStore *store, KoDocument *document)
+        : m_store(store), m_document(document) {}
+
+    virtual void run() {
+        const bool ok = m_store->finalize();
+        delete m_store;
+        // the document waits for this job before it is destroyed
+        QMetaObject::invokeMethod(m_document, "slotAutoSaveFinished", Qt::QueuedConnection, Q_ARG(bool, ok));
+    }
+
+private:
+    KoStore *m_store;
+    KoDocument *m_document;
+};
+
+}
+
 //static
 QString KoDocument::newObjectName()
 {
@@ -157,6 +189,8 @@ public:
         password(QString()),
         modifiedAfterAutosave(false),
         autosaving(false),
+        autoSavePending(false),
+        finalizeInBackground(false),
         shouldCheckAutoSaveFile(true),
         autoErrorHandlingEnabled(true),
         backupFile(true),
@@ -178,6 +212,9 @@ public:
         m_bTemp = false;
         m_bAutoDetectedMime = false;
 
+        // autosaves are written one after the other
+        autoSavePool.setMaxThreadCount(1);
+
         confirmNonNativeSave[0] = true;
         confirmNonNativeSave[1] = true;
         if (QLocale().measurementSystem() == QLocale::ImperialSystem) {
@@ -217,6 +254,9 @@ public:
     int autoSaveDelay; // in seconds, 0 to disable.
     bool modifiedAfterAutosave;
     bool autosaving;
+    bool autoSavePending; // an autosave is still being written in the background
+    bool finalizeInBackground; // saveNativeFormatODF() hands the store to autoSavePool
+    QThreadPool autoSavePool;
     bool shouldCheckAutoSaveFile; // usually true
     bool autoErrorHandlingEnabled; // usually true
     bool backupFile;
@@ -459,6 +499,8 @@ KoDocument::KoDocument(KoPart *parent, KUndo2Stack *undoStack)
 
     KConfigGroup cfgGrp(d->parentPart->componentData().config(), "Undo");
     d->undoStack->setUndoLimit(cfgGrp.readEntry("UndoLimit", 1000));
+    // in MiB, 0 keeps the history no matter how much memory it takes
+    d->undoStack->setMemoryLimit(qint64(cfgGrp.readEntry("UndoMemoryLimit", 0)) * 1024 * 1024);
 
     connect(d->undoStack, SIGNAL(indexChanged(int)), this, SLOT(slotUndoStackIndexChanged(int)));
 
@@ -466,6 +508,7 @@ KoDocument::KoDocument(KoPart *parent, KUndo2Stack *undoStack)
 
 KoDocument::~KoDocument()
 {
+    d->autoSavePool.waitForDone();
     d->autoSaveTimer.disconnect(this);
     d->autoSaveTimer.stop();
     d->parentPart->deleteLater();
@@ -710,7 +753,7 @@ bool KoDocument::isAutoErrorHandlingEnabled() const
 
 void KoDocument::slotAutoSave()
 {
-    if (d->modified && d->modifiedAfterAutosave && !d->isLoading) {
+    if (d->modified && d->modifiedAfterAutosave && !d->isLoading && !d->autoSavePending) {
         // Give a warning when trying to autosave an encrypted file when no password is known (should not happen)
         if (d->specialOutputFlag == SaveEncrypted && d->password.isNull()) {
             // That advice should also fix this error from occurring again
@@ -719,7 +762,10 @@ void KoDocument::slotAutoSave()
             connect(this, SIGNAL(sigProgress(int)), d->parentPart->currentMainwindow(), SLOT(slotProgress(int)));
             emit statusBarMessage(i18n("Autosaving..."));
             d->autosaving = true;
+            // only the serialization has to block the user, the file is written in the background
+            d->finalizeInBackground = true;
             bool ret = saveNativeFormat(autoSaveFile(localFilePath()));
+            d->finalizeInBackground = false;
             setModified(true);
             if (ret) {
                 d->modifiedAfterAutosave = false;
@@ -735,6 +781,21 @@ void KoDocument::slotAutoSave()
     }
 }
 
+void KoDocument::slotAutoSaveFinished(bool success)
+{
+    d->autoSavePending = false;
+    if (!success) {
+        // try again with the next interval
+        if (d->modified) {
+            d->modifiedAfterAutosave = true;
+            setAutoSave(d->autoSaveDelay);
+        }
+        if (!d->disregardAutosaveFailure) {
+            emit statusBarMessage(i18n("Error during autosave! Partition full?"));
+        }
+    }
+}
+
 void KoDocument::setReadWrite(bool readwrite)
 {
     d->readwrite = readwrite;
@@ -821,6 +882,9 @@ bool KoDocument::saveNativeFormat(const QString & file)
     KoStore *store = KoStore::createStore(file, KoStore::Write, mimeType, backend);
     if (d->specialOutputFlag == SaveEncrypted && !d->password.isNull())
         store->setPassword(d->password);
+    // only the zip store can be finalized on another thread, see AutoSaveFinalizer
+    if (backend != KoStore::Auto)
+        d->finalizeInBackground = false;
     if (store->bad()) {
         d->lastErrorMessage = i18n("Could not create the file for saving");   // more details needed?
         delete store;
@@ -937,6 +1001,12 @@ bool KoDocument::saveNativeFormatODF(KoStore *store, const QByteArray &mimeType)
     if (store->isEncrypted() && !d->isExporting)
         d->password = store->password();
 
+    if (d->finalizeInBackground) {
+        d->autoSavePending = true;
+        d->autoSavePool.start(new AutoSaveFinalizer(store, this));
+        return true;
+    }
+
     delete store;
 
     return true;
@@ -2228,6 +2298,9 @@ bool KoDocument::isLoading() const
 
 void KoDocument::removeAutoSaveFiles()
 {
+    // don't let a pending autosave write the file again
+    d->autoSavePool.waitForDone();
+
     // Eliminate any auto-save file
     QString asf = autoSaveFile(localFilePath());   // the one in the current dir
     if (QFile::exists(asf))
@@ -764,6 +764,9 @@ private Q_SLOTS:
 
     void slotAutoSave();
 
+    /// Called when an autosave finished writing in the background
+    void slotAutoSaveFinished(bool success);
+
     /// Called by the undo stack when undo or redo is called
     void slotUndoStackIndexChanged(int idx);
 
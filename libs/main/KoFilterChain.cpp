@@ -31,6 +31,7 @@ Boston, MA 02110-1301, USA.
 #include "KoFilterChainLink.h"
 #include "KoFilterVertex.h"
 
+#include <QBuffer>
 #include <QMetaMethod>
 #include <QTemporaryFile>
 #include <QMimeDatabase>
@@ -47,8 +48,9 @@ using namespace CalligraFilter;
 KoFilterChain::KoFilterChain(const KoFilterManager* manager) :
         m_manager(manager), m_state(Beginning), m_inputStorage(0),
         m_inputStorageDevice(0), m_outputStorage(0), m_outputStorageDevice(0),
-        m_inputDocument(0), m_outputDocument(0), m_inputTempFile(0),
-        m_outputTempFile(0), m_inputQueried(Nil), m_outputQueried(Nil), d(0)
+        m_inputDocument(0), m_outputDocument(0), m_inputBuffer(0),
+        m_outputBuffer(0), m_inputTempFile(0), m_outputTempFile(0),
+        m_inputQueried(Nil), m_outputQueried(Nil), d(0)
 {
 }
 
@@ -127,8 +129,12 @@ QString KoFilterChain::inputFile()
         else
             inputFileHelper(filterManagerKoDocument(), filterManagerImportFile());
     } else
-        if (m_inputFile.isEmpty())
-            inputFileHelper(m_inputDocument, QString());
+        if (m_inputFile.isEmpty()) {
+            if (m_inputBuffer)
+                inputFileHelper(m_inputBuffer->data());
+            else
+                inputFileHelper(m_inputDocument, QString());
+        }
 
     return m_inputFile;
 }
@@ -169,13 +175,27 @@ KoStoreDevice* KoFilterChain::storageFile(const QString& name, KoStore::Mode mod
     else if (m_outputQueried == Storage && mode == KoStore::Write &&
              m_outputStorage && m_outputStorage->mode() == KoStore::Write)
         return storageNewStreamHelper(&m_outputStorage, &m_outputStorageDevice, name);
-    else if (m_inputQueried == Nil && mode == KoStore::Read)
+    else if (m_inputQueried == Nil && mode == KoStore::Read) {
+        if (m_inputBuffer)
+            return storageHelper(m_inputBuffer, name, KoStore::Read,
+                                 &m_inputStorage, &m_inputStorageDevice);
         return storageHelper(inputFile(), name, KoStore::Read,
                              &m_inputStorage, &m_inputStorageDevice);
-    else if (m_outputQueried == Nil && mode == KoStore::Write)
+    } else if (m_outputQueried == Nil && mode == KoStore::Write) {
+        // Between two filters the storage is kept in memory
+        if (!(m_state & End) && !filterManagerParentChain()) {
+            m_outputBuffer = new QBuffer;
+            KoStoreDevice* device = storageHelper(m_outputBuffer, name, KoStore::Write,
+                                                  &m_outputStorage, &m_outputStorageDevice);
+            if (!m_outputStorage) {
+                delete m_outputBuffer;
+                m_outputBuffer = 0;
+            }
+            return device;
+        }
         return storageHelper(outputFile(), name, KoStore::Write,
                              &m_outputStorage, &m_outputStorageDevice);
-    else {
+    } else {
         warnFilter << "Oooops, how did we get here? You already asked for a"
         << " different source/destination?" << endl;
         return 0;
@@ -287,24 +307,20 @@ void KoFilterChain::manageIO()
         delete m_inputStorage;
         m_inputStorage = 0;
     }
+    delete m_inputBuffer;
+    m_inputBuffer = 0;
     delete m_inputTempFile;  // autodelete
     m_inputTempFile = 0;
     m_inputFile.clear();
 
-    if (!m_outputFile.isEmpty()) {
-        if (m_outputTempFile == 0) {
-            m_inputTempFile = new QTemporaryFile;
-            m_inputTempFile->setAutoRemove(true);
-            m_inputTempFile->setFileName(m_outputFile);
-        }
-        else {
+    if (!m_outputFile.isEmpty() || m_outputBuffer) {
+        if (!m_outputFile.isEmpty()) {
+            m_inputFile = m_outputFile;
+            m_outputFile.clear();
+            // removed with the input, unless it is not a temporary file
             m_inputTempFile = m_outputTempFile;
             m_outputTempFile = 0;
         }
-        m_inputFile = m_outputFile;
-        m_outputFile.clear();
-        m_inputTempFile = m_outputTempFile;
-        m_outputTempFile = 0;
 
         delete m_outputStorageDevice;
         m_outputStorageDevice = 0;
@@ -316,6 +332,13 @@ void KoFilterChain::manageIO()
                 delete m_outputStorage;
             m_outputStorage = 0;
         }
+
+        // Only now, with the storage finalized, the data is complete
+        if (m_outputBuffer) {
+            m_outputBuffer->close();
+            m_inputBuffer = m_outputBuffer;
+            m_outputBuffer = 0;
+        }
     }
 
     if (m_inputDocument != filterManagerKoDocument())
@@ -398,6 +421,27 @@ void KoFilterChain::inputFileHelper(KoDocument* document, const QString& alterna
         m_inputFile = alternativeFile;
 }
 
+void KoFilterChain::inputFileHelper(const QByteArray& data)
+{
+    // The previous filter wrote to memory, but this one wants a file
+    if (!createTempFile(&m_inputTempFile)) {
+        delete m_inputTempFile;
+        m_inputTempFile = 0;
+        m_inputFile.clear();
+        return;
+    }
+    m_inputFile = m_inputTempFile->fileName();
+    const bool written = m_inputTempFile->write(data) == data.size();
+    // Closing keeps the file, but avoids a second handle on it, see above
+    m_inputTempFile->close();
+    if (!written) {
+        errorFilter << "Couldn't write the temporary file" << m_inputFile << endl;
+        delete m_inputTempFile;
+        m_inputTempFile = 0;
+        m_inputFile.clear();
+    }
+}
+
 void KoFilterChain::outputFileHelper(bool autoDelete)
 {
     if (!createTempFile(&m_outputTempFile, autoDelete)) {
@@ -445,7 +489,27 @@ KoStoreDevice* KoFilterChain::storageHelper(const QString& file, const QString&
     }
 
     storageInit(file, mode, storage);
+    return storageOpenedHelper(streamName, mode, storage, device);
+}
 
+KoStoreDevice* KoFilterChain::storageHelper(QIODevice* io, const QString& streamName,
+        KoStore::Mode mode, KoStore** storage,
+        KoStoreDevice** device)
+{
+    if (*storage) {
+        debugFilter << "Uh-oh, we forgot to clean up...";
+        return 0;
+    }
+
+    storageInit(io, mode, storage);
+    return storageOpenedHelper(streamName, mode, storage, device);
+}
+
+KoStoreDevice* KoFilterChain::storageOpenedHelper(const QString& streamName, KoStore::Mode mode,
+        KoStore** storage, KoStoreDevice** device)
+{
+    if (!*storage)
+        return 0;
     if ((*storage)->bad())
         return storageCleanupHelper(storage);
 
@@ -461,6 +525,19 @@ KoStoreDevice* KoFilterChain::storageHelper(const QString& file, const QString&
 }
 
 void KoFilterChain::storageInit(const QString& file, KoStore::Mode mode, KoStore** storage)
+{
+    *storage = KoStore::createStore(file, mode, storageAppIdentification(mode));
+}
+
+void KoFilterChain::storageInit(QIODevice* io, KoStore::Mode mode, KoStore** storage)
+{
+    *storage = KoStore::createStore(io, mode, storageAppIdentification(mode));
+    // The data never leaves memory, deflating it would only cost time
+    if (*storage && mode == KoStore::Write)
+        (*storage)->setCompressionEnabled(false);
+}
+
+QByteArray KoFilterChain::storageAppIdentification(KoStore::Mode mode) const
 {
     QByteArray appIdentification("");
     if (mode == KoStore::Write) {
@@ -472,7 +549,7 @@ void KoFilterChain::storageInit(const QString& file, KoStore::Mode mode, KoStore
         // "abuses" this method.
         appIdentification = m_chainLinks.current()->to();
     }
-    *storage = KoStore::createStore(file, mode, appIdentification);
+    return appIdentification;
 }
 
 KoStoreDevice* KoFilterChain::storageCreateFirstStream(const QString& streamName, KoStore** storage,
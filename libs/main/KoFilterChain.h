@@ -30,9 +30,12 @@ Boston, MA 02110-1301, USA.
 #include "komain_export.h"
 #include "KoFilterChainLinkList.h"
 
+class QBuffer;
+class QIODevice;
 class QTemporaryFile;
 class KoFilterManager;
 class KoDocument;
+class FilterChainIOTest;
 
 
 namespace CalligraFilter
@@ -58,6 +61,7 @@ class KOMAIN_EXPORT KoFilterChain : public QSharedData
     // add chain links.
     friend class Graph;
     friend class KoFilterManager;
+    friend class ::FilterChainIOTest; // runs the links by hand
 
 public:
     typedef QExplicitlySharedDataPointer<KoFilterChain> Ptr;
@@ -161,11 +165,18 @@ private:
     bool createTempFile(QTemporaryFile** tempFile, bool autoDelete = true);
 
     void inputFileHelper(KoDocument* document, const QString& alternativeFile);
+    void inputFileHelper(const QByteArray& data);
     void outputFileHelper(bool autoDelete);
     KoStoreDevice* storageNewStreamHelper(KoStore** storage, KoStoreDevice** device, const QString& name);
     KoStoreDevice* storageHelper(const QString& file, const QString& streamName,
                                  KoStore::Mode mode, KoStore** storage, KoStoreDevice** device);
+    KoStoreDevice* storageHelper(QIODevice* io, const QString& streamName,
+                                 KoStore::Mode mode, KoStore** storage, KoStoreDevice** device);
+    KoStoreDevice* storageOpenedHelper(const QString& streamName, KoStore::Mode mode,
+                                       KoStore** storage, KoStoreDevice** device);
     void storageInit(const QString& file, KoStore::Mode mode, KoStore** storage);
+    void storageInit(QIODevice* io, KoStore::Mode mode, KoStore** storage);
+    QByteArray storageAppIdentification(KoStore::Mode mode) const;
     KoStoreDevice* storageCreateFirstStream(const QString& streamName, KoStore** storage, KoStoreDevice** device);
     KoStoreDevice* storageCleanupHelper(KoStore** storage);
 
@@ -198,6 +209,9 @@ private:
     KoDocument* m_inputDocument;      // ...or even documents?
     KoDocument* m_outputDocument;
 
+    QBuffer* m_inputBuffer;           // ...or memory, between two chain links?
+    QBuffer* m_outputBuffer;
+
     QTemporaryFile* m_inputTempFile;
     QTemporaryFile* m_outputTempFile;
 
@@ -19,6 +19,8 @@ Boston, MA 02110-1301, USA.
 #ifndef KOFILTERCHAINLINKLIST_H
 #define KOFILTERCHAINLINKLIST_H
 
+#include "komain_export.h"
+
 #include <QList>
 
 namespace CalligraFilter {
@@ -26,7 +28,7 @@ namespace CalligraFilter {
     class ChainLink;
 
 
-    class ChainLinkList
+    class KOMAIN_TEST_EXPORT ChainLinkList
     {
     public:
         ChainLinkList();
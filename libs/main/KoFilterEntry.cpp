@@ -29,6 +29,8 @@ Boston, MA 02110-1301, USA.
 
 #include <kpluginfactory.h>
 #include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
 
 #include <limits.h> // UINT_MAX
 
@@ -60,8 +62,29 @@ QString KoFilterEntry::fileName() const
     return m_loader->fileName();
 }
 
+namespace {
+// The entries kept while a KoFilterEntryCache exists
+struct FilterEntryCache
+{
+    FilterEntryCache() : users(0) {}
+
+    QMutex mutex;
+    int users;
+    QList<KoFilterEntry::Ptr> entries;
+};
+}
+
+Q_GLOBAL_STATIC(FilterEntryCache, s_filterEntryCache)
+
 QList<KoFilterEntry::Ptr> KoFilterEntry::query()
 {
+    QMutexLocker locker(&s_filterEntryCache->mutex);
+    if (s_filterEntryCache->users > 0 && !s_filterEntryCache->entries.isEmpty()) {
+        return s_filterEntryCache->entries;
+    }
+    // Loading the plugins may take a while, don't block the other callers
+    locker.unlock();
+
     QList<KoFilterEntry::Ptr> lst;
 
     QList<QPluginLoader *> offers = KoPluginLoader::pluginLoaders(QStringLiteral("calligra/formatfilters"));
@@ -78,9 +101,27 @@ QList<KoFilterEntry::Ptr> KoFilterEntry::query()
         it++;
     }
 
+    locker.relock();
+    if (s_filterEntryCache->users > 0) {
+        s_filterEntryCache->entries = lst;
+    }
     return lst;
 }
 
+KoFilterEntryCache::KoFilterEntryCache()
+{
+    QMutexLocker locker(&s_filterEntryCache->mutex);
+    ++s_filterEntryCache->users;
+}
+
+KoFilterEntryCache::~KoFilterEntryCache()
+{
+    QMutexLocker locker(&s_filterEntryCache->mutex);
+    if (--s_filterEntryCache->users == 0) {
+        s_filterEntryCache->entries.clear();
+    }
+}
+
 KoFilter* KoFilterEntry::createFilter(KoFilterChain* chain, QObject* parent)
 {
     KLibFactory *factory = qobject_cast<KLibFactory *>(m_loader->instance());
@@ -86,6 +86,7 @@ public:
 
     /**
      *  This function will query KDED to find all available filters.
+     *  The result is only cached while a KoFilterEntryCache exists.
      */
     static QList<KoFilterEntry::Ptr> query();
 
@@ -94,4 +95,22 @@ private:
     QPluginLoader * const m_loader;
 };
 
+/**
+ * While an instance exists, KoFilterEntry::query() scans the filter plugins
+ * only once and returns the same entries from then on. Processes converting
+ * one document after the other, like the workers of calligraconverter, keep
+ * one around; filters installed meanwhile are seen once the last instance
+ * is deleted.
+ */
+class KOMAIN_EXPORT KoFilterEntryCache
+{
+public:
+    KoFilterEntryCache();
+    ~KoFilterEntryCache();
+
+private:
+    KoFilterEntryCache(const KoFilterEntryCache&);
+    KoFilterEntryCache& operator=(const KoFilterEntryCache&);
+};
+
 #endif
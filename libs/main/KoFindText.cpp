@@ -31,6 +31,9 @@
 #include <QApplication>
 #include <QAbstractTextDocumentLayout>
 
+#include <algorithm>
+#include <climits>
+
 #include <MainDebug.h>
 #include <klocalizedstring.h>
 
@@ -79,7 +82,6 @@ void KoFindText::findImplementation(const QString &pattern, QList<KoFindMatch> &
         flags |= QTextDocument::FindWholeWords;
     }
 
-    int start = 0;
     bool findInSelection = false;
 
     if(d->documents.size() == 0) {
@@ -87,46 +89,79 @@ void KoFindText::findImplementation(const QString &pattern, QList<KoFindMatch> &
         return;
     }
 
+    // typing more characters only narrows the blocks the previous pattern was found in
+    const Qt::CaseSensitivity sensitivity = flags & QTextDocument::FindCaseSensitively ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    const bool narrow = !d->lastPattern.isEmpty() && flags == d->lastFlags && pattern.contains(d->lastPattern, sensitivity);
+    if (!narrow) {
+        d->lastCandidates.clear();
+    }
+
+    quint64 signature[KoFindTextIndex::SignatureWords];
+    KoFindTextIndex::signature(pattern, signature);
+
     bool before = opts->option("fromCursor")->value().toBool() && !d->currentCursor.isNull();
     QList<KoFindMatch> matchBefore;
     foreach(QTextDocument* document, d->documents) {
-        QTextCursor cursor = document->find(pattern, start, flags);
-        cursor.setKeepPositionOnInsert(true);
+        KoFindTextIndex *index = d->index(document);
+        const bool narrowDocument = narrow && d->lastCandidates.contains(document);
+        const QVector<int> candidates = d->lastCandidates.value(document);
+        const int count = narrowDocument ? candidates.count() : index->blocks.count();
+        QVector<int> found;
 
         QVector<QAbstractTextDocumentLayout::Selection> selections;
-        while(!cursor.isNull()) {
-            if(findInSelection && d->selectionEnd <= cursor.position()) {
-                break;
+        for (int i = 0; i < count && !pattern.isEmpty(); ++i) {
+            const int blockIndex = narrowDocument ? candidates.at(i) : i;
+            const KoFindTextIndex::Block &block = index->blocks.at(blockIndex);
+            if (!KoFindTextIndex::mayContain(block, signature)) {
+                continue;
             }
 
-            if (before && document == d->currentCursor.document() && d->currentCursor < cursor) {
-                before = false;
+            bool occurs = false;
+            int offset = KoFindTextIndex::indexIn(block.text, pattern, 0, flags, &occurs);
+            if (occurs) {
+                found.append(blockIndex);
             }
-
-            QAbstractTextDocumentLayout::Selection selection;
-            selection.cursor = cursor;
-            selection.format = d->highlightFormat;
-            selections.append(selection);
-
-            KoFindMatch match;
-            match.setContainer(QVariant::fromValue(document));
-            match.setLocation(QVariant::fromValue(cursor));
-            if (before) {
-                matchBefore.append(match);
+            while (offset >= 0) {
+                QTextCursor cursor(document);
+                cursor.setPosition(block.position + offset);
+                cursor.setPosition(block.position + offset + pattern.length(), QTextCursor::KeepAnchor);
+                cursor.setKeepPositionOnInsert(true);
+
+                if(findInSelection && d->selectionEnd <= cursor.position()) {
+                    break;
+                }
+
+                if (before && document == d->currentCursor.document() && d->currentCursor < cursor) {
+                    before = false;
+                }
+
+                QAbstractTextDocumentLayout::Selection selection;
+                selection.cursor = cursor;
+                selection.format = d->highlightFormat;
+                selections.append(selection);
+
+                KoFindMatch match;
+                match.setContainer(QVariant::fromValue(document));
+                match.setLocation(QVariant::fromValue(cursor));
+                if (before) {
+                    matchBefore.append(match);
+                }
+                else {
+                    matchList.append(match);
+                }
+
+                offset = KoFindTextIndex::indexIn(block.text, pattern, offset + pattern.length(), flags, &occurs);
             }
-            else {
-                matchList.append(match);
-            }
-
-            cursor = document->find(pattern, cursor, flags);
-            cursor.setKeepPositionOnInsert(true);
         }
+        d->lastCandidates.insert(document, found);
         if (before && document == d->currentCursor.document()) {
             before = false;
         }
         d->selections.insert(document, selections);
     }
     matchList.append(matchBefore);
+    d->lastPattern = pattern;
+    d->lastFlags = flags;
 
     if (hasMatches()) {
         setCurrentMatch(0);
@@ -216,6 +251,13 @@ void KoFindText::setCurrentCursor(const QTextCursor &cursor)
 void KoFindText::setDocuments(const QList<QTextDocument*> &documents)
 {
     clearMatches();
+    foreach(QTextDocument *document, d->indexes.keys()) {
+        if (!documents.contains(document)) {
+            d->dropIndex(document);
+        }
+    }
+    d->lastPattern.clear();
+    d->lastCandidates.clear();
     d->documents = documents;
     d->updateDocumentList();
 }
@@ -258,11 +300,136 @@ void KoFindText::Private::updateDocumentList()
 
 void KoFindText::Private::documentDestroyed(QObject *document)
 {
-    QTextDocument* doc = qobject_cast<QTextDocument*>(document);
+    // the QTextDocument part is already destroyed here, only use the pointer value
+    QTextDocument* doc = static_cast<QTextDocument*>(document);
     if(doc) {
         selections.remove(doc);
         documents.removeOne(doc);
+        lastCandidates.remove(doc);
+        delete indexes.take(doc);
+    }
+}
+
+KoFindTextIndex *KoFindText::Private::index(QTextDocument *document)
+{
+    KoFindTextIndex *index = indexes.value(document);
+    if (!index) {
+        index = new KoFindTextIndex(document);
+        index->connection = QObject::connect(document, &QTextDocument::contentsChange, q,
+            [this, document](int position, int charsRemoved, int charsAdded) {
+                KoFindTextIndex *index = indexes.value(document);
+                if (index) {
+                    index->contentsChanged(position, charsRemoved, charsAdded);
+                    // block indexes of the previous search are no longer valid
+                    lastCandidates.remove(document);
+                }
+            });
+        indexes.insert(document, index);
+    }
+    return index;
+}
+
+void KoFindText::Private::dropIndex(QTextDocument *document)
+{
+    KoFindTextIndex *index = indexes.take(document);
+    if (index) {
+        QObject::disconnect(index->connection);
+        delete index;
+    }
+    lastCandidates.remove(document);
+}
+
+KoFindTextIndex::KoFindTextIndex(QTextDocument *document)
+    : document(document)
+{
+    insertBlocks(0, 0, document->characterCount());
+}
+
+void KoFindTextIndex::contentsChanged(int position, int charsRemoved, int charsAdded)
+{
+    // blocks starting in the changed range are gone, the one before it changed
+    QVector<Block>::iterator it = std::upper_bound(blocks.begin(), blocks.end(), position,
+        [](int position, const Block &block) { return position < block.position; });
+    const int first = it == blocks.begin() ? 0 : it - blocks.begin() - 1;
+    it = std::upper_bound(blocks.begin(), blocks.end(), position + charsRemoved,
+        [](int position, const Block &block) { return position < block.position; });
+    const int last = it - blocks.begin();
+
+    const int from = first < blocks.count() ? qMin(blocks.at(first).position, position) : 0;
+    blocks.remove(first, last - first);
+
+    const int delta = charsAdded - charsRemoved;
+    for (int i = first; i < blocks.count(); ++i) {
+        blocks[i].position += delta;
+    }
+
+    insertBlocks(first, from, position + charsAdded);
+}
+
+void KoFindTextIndex::insertBlocks(int index, int from, int to)
+{
+    const int end = index < blocks.count() ? blocks.at(index).position : INT_MAX;
+    QVector<Block> added;
+    for (QTextBlock block = document->findBlock(from); block.isValid() && block.position() <= to && block.position() < end; block = block.next()) {
+        Block entry;
+        entry.position = block.position();
+        entry.text = block.text();
+        entry.text.replace(QChar::Nbsp, QLatin1Char(' '));
+        signature(entry.text, entry.signature);
+        added.append(entry);
+    }
+    if (index == blocks.count()) {
+        blocks += added;
+    } else if (!added.isEmpty()) {
+        blocks.insert(index, added.count(), Block());
+        std::copy(added.constBegin(), added.constEnd(), blocks.begin() + index);
+    }
+}
+
+void KoFindTextIndex::signature(const QString &text, quint64 *signature)
+{
+    std::fill(signature, signature + SignatureWords, 0);
+    const int bits = SignatureWords * 64;
+    for (int i = 1; i < text.length(); ++i) {
+        // surrogates are folded in pairs when comparing, leave them out so they never exclude a block
+        if (text.at(i - 1).isSurrogate() || text.at(i).isSurrogate()) {
+            continue;
+        }
+        const uint hash = (text.at(i - 1).toCaseFolded().unicode() * 31 + text.at(i).toCaseFolded().unicode()) % bits;
+        signature[hash / 64] |= Q_UINT64_C(1) << (hash % 64);
+    }
+}
+
+bool KoFindTextIndex::mayContain(const Block &block, const quint64 *signature)
+{
+    for (int i = 0; i < SignatureWords; ++i) {
+        if ((block.signature[i] & signature[i]) != signature[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int KoFindTextIndex::indexIn(const QString &text, const QString &pattern, int offset, QTextDocument::FindFlags flags, bool *occurs)
+{
+    const Qt::CaseSensitivity sensitivity = flags & QTextDocument::FindCaseSensitively ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    while (offset >= 0 && offset <= text.length()) {
+        const int start = text.indexOf(pattern, offset, sensitivity);
+        if (start == -1) {
+            return -1;
+        }
+        *occurs = true;
+        if (flags & QTextDocument::FindWholeWords) {
+            const int end = start + pattern.length();
+            if ((start != 0 && text.at(start - 1).isLetterOrNumber())
+                    || (end != text.length() && text.at(end).isLetterOrNumber())) {
+                offset = end + 1;
+                continue;
+            }
+        }
+        return start;
     }
+    return -1;
 }
 
 void KoFindText::Private::updateCurrentMatch(int position)
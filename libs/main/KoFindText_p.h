@@ -43,10 +43,57 @@
 #include "KoFindOption.h"
 #include "KoDocument.h"
 
+/**
+ * Search index of a single QTextDocument.
+ *
+ * Keeps the text of every block together with a signature of the character
+ * pairs in it, so blocks that cannot contain a pattern are skipped without
+ * asking the document for their text. The index is kept up to date from
+ * QTextDocument::contentsChange, only re-reading the blocks that changed.
+ */
+class KoFindTextIndex
+{
+public:
+    enum { SignatureWords = 4 };
+
+    struct Block {
+        int position;
+        QString text;
+        quint64 signature[SignatureWords];
+    };
+
+    explicit KoFindTextIndex(QTextDocument *document);
+
+    /// Update the index after the document changed, the arguments are those of contentsChange
+    void contentsChanged(int position, int charsRemoved, int charsAdded);
+
+    /// Fill the signature of the given text, the result is the same regardless of case
+    static void signature(const QString &text, quint64 *signature);
+    /// Returns if a block can contain text that has the given signature
+    static bool mayContain(const Block &block, const quint64 *signature);
+
+    /**
+     * Find the pattern in a block text starting at offset, the same way as
+     * QTextDocument::find() does.
+     *
+     * @param occurs set to true if the pattern occurs in the text at all,
+     *      also if it is rejected because it is not a whole word.
+     */
+    static int indexIn(const QString &text, const QString &pattern, int offset, QTextDocument::FindFlags flags, bool *occurs);
+
+    QTextDocument *document;
+    QVector<Block> blocks;
+    QMetaObject::Connection connection;
+
+private:
+    void insertBlocks(int index, int from, int to);
+};
+
 class Q_DECL_HIDDEN KoFindText::Private
 {
 public:
-    Private(KoFindText* qq) : q(qq), selectionStart(-1), selectionEnd(-1) { }
+    Private(KoFindText* qq) : q(qq), selectionStart(-1), selectionEnd(-1), lastFlags(0) { }
+    ~Private() { qDeleteAll(indexes); }
 
     void updateSelections();
     void updateDocumentList();
@@ -54,6 +101,10 @@ public:
     void updateCurrentMatch(int position);
     static void initializeFormats();
 
+    /// Returns the search index of the document, building it on first use
+    KoFindTextIndex *index(QTextDocument *document);
+    void dropIndex(QTextDocument *document);
+
     KoFindText *q;
 
     QList<QTextDocument*> documents;
@@ -72,6 +123,13 @@ public:
     static bool formatsInitialized;
 
     QPair<QTextDocument*, int> currentMatch;
+
+    QHash<QTextDocument*, KoFindTextIndex*> indexes;
+    // Blocks that contained the previous pattern. When typing extends the
+    // pattern only those need to be searched again.
+    QString lastPattern;
+    QTextDocument::FindFlags lastFlags;
+    QHash<QTextDocument*, QVector<int> > lastCandidates;
 };
 
 #endif
@@ -0,0 +1,179 @@
+/* This file is part of the KDE project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "autosavetest.h"
+
+#include <KoComponentData.h>
+#include <KoDocument.h>
+#include <KoOdfWriteStore.h>
+#include <KoPart.h>
+#include <KoStore.h>
+#include <KoXmlWriter.h>
+
+#include <KAboutData>
+
+#include <QDir>
+#include <QFile>
+#include <QTest>
+#include <QUrl>
+
+static const char odtMimeType[] = "application/vnd.oasis.opendocument.text";
+
+namespace
+{
+
+class AutoSaveTestPart : public KoPart
+{
+public:
+    AutoSaveTestPart()
+        : KoPart(KoComponentData(KAboutData(QStringLiteral("autosavetest"), QStringLiteral("AutoSaveTest"), QStringLiteral("0.1"))), 0)
+    {
+    }
+    virtual KoView *createViewInstance(KoDocument *, QWidget *) { return 0; }
+    virtual KoMainWindow *createMainWindow() { return 0; }
+};
+
+/// A document holding a single paragraph
+class AutoSaveTestDocument : public KoDocument
+{
+public:
+    explicit AutoSaveTestDocument(const QString &text)
+        : KoDocument(new AutoSaveTestPart)
+        , m_text(text)
+    {
+        documentPart()->setDocument(this);
+        setOutputMimeType(odtMimeType);
+    }
+
+    virtual QByteArray nativeFormatMimeType() const { return odtMimeType; }
+    virtual QByteArray nativeOasisMimeType() const { return odtMimeType; }
+    virtual QStringList extraNativeMimeTypes() const { return QStringList(); }
+    virtual void paintContent(QPainter &, const QRect &) {}
+    virtual bool loadXML(const KoXmlDocument &, KoStore *) { return false; }
+    virtual bool loadOdf(KoOdfReadStore &) { return false; }
+
+    virtual bool saveOdf(SavingContext &documentContext)
+    {
+        KoXmlWriter *contentWriter = documentContext.odfStore.contentWriter();
+        if (!contentWriter)
+            return false;
+        KoXmlWriter *bodyWriter = documentContext.odfStore.bodyWriter();
+        bodyWriter->startElement("office:body");
+        bodyWriter->startElement("office:text");
+        bodyWriter->startElement("text:p");
+        bodyWriter->addTextNode(m_text);
+        bodyWriter->endElement();
+        bodyWriter->endElement();
+        bodyWriter->endElement();
+        if (!documentContext.odfStore.closeContentWriter())
+            return false;
+        documentContext.odfStore.manifestWriter()->addManifestEntry("content.xml", "text/xml");
+        return true;
+    }
+
+    QString autoSaveFileName() const
+    {
+        return autoSaveFile(localFilePath());
+    }
+
+    /// Starts an autosave the way the autosave timer does
+    bool autoSave()
+    {
+        setModified(true);
+        return QMetaObject::invokeMethod(this, "slotAutoSave", Qt::DirectConnection);
+    }
+
+private:
+    QString m_text;
+};
+
+QByteArray readContent(const QString &fileName)
+{
+    QByteArray content;
+    if (!QFile::exists(fileName))
+        return content;
+    KoStore *store = KoStore::createStore(fileName, KoStore::Read);
+    if (store && !store->bad() && store->open("content.xml")) {
+        content = store->read(store->size());
+        store->close();
+    }
+    delete store;
+    return content;
+}
+
+}
+
+void AutoSaveTest::initTestCase()
+{
+    QVERIFY(m_tempDir.isValid());
+}
+
+QString AutoSaveTest::documentPath(const QString &name) const
+{
+    // the autosave file is put next to the directory of the document
+    const QString dir = m_tempDir.path() + QLatin1Char('/') + name;
+    QDir().mkpath(dir);
+    return dir + QLatin1String("/document.odt");
+}
+
+void AutoSaveTest::testAutoSaveWrittenInBackground()
+{
+    AutoSaveTestDocument document(QStringLiteral("autosaved paragraph"));
+    document.setUrl(QUrl::fromLocalFile(documentPath(QStringLiteral("background"))));
+    const QString autoSaveFile = document.autoSaveFileName();
+    QVERIFY(!QFile::exists(autoSaveFile));
+
+    QVERIFY(document.autoSave());
+    // the file is complete once it shows up, it is committed by renaming
+    QTRY_VERIFY(readContent(autoSaveFile).contains("autosaved paragraph"));
+    QVERIFY(document.isModified());
+
+    document.removeAutoSaveFiles();
+    QVERIFY(!QFile::exists(autoSaveFile));
+}
+
+void AutoSaveTest::testRemoveAutoSaveFilesWaits()
+{
+    AutoSaveTestDocument document(QStringLiteral("removed paragraph"));
+    document.setUrl(QUrl::fromLocalFile(documentPath(QStringLiteral("remove"))));
+    const QString autoSaveFile = document.autoSaveFileName();
+
+    QVERIFY(document.autoSave());
+    // must not be undone by the autosave still being written
+    document.removeAutoSaveFiles();
+    QVERIFY(!QFile::exists(autoSaveFile));
+    QTest::qWait(100);
+    QVERIFY(!QFile::exists(autoSaveFile));
+}
+
+void AutoSaveTest::testDeleteDocumentWaits()
+{
+    AutoSaveTestDocument *document = new AutoSaveTestDocument(QStringLiteral("last paragraph"));
+    document->setUrl(QUrl::fromLocalFile(documentPath(QStringLiteral("delete"))));
+    const QString autoSaveFile = document->autoSaveFileName();
+
+    QVERIFY(document->autoSave());
+    delete document;
+    // the autosave was finished before the document went away, and the
+    // result posted to it is dropped
+    QVERIFY(readContent(autoSaveFile).contains("last paragraph"));
+    QTest::qWait(100);
+    QFile::remove(autoSaveFile);
+}
+
+QTEST_MAIN(AutoSaveTest)
@@ -0,0 +1,119 @@
+/* This file is part of the KDE project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "filterchainiotest.h"
+
+#include <KoFilterChain.h>
+#include <KoFilterManager.h>
+#include <KoStore.h>
+
+#include <QBuffer>
+#include <QFile>
+#include <QTest>
+
+static const char odtMimeType[] = "application/vnd.oasis.opendocument.text";
+
+void FilterChainIOTest::initTestCase()
+{
+    QVERIFY(m_tempDir.isValid());
+
+    m_content = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<office:document-content>";
+    for (int i = 0; i < 1000; ++i) {
+        m_content += "<text:p>Paragraph " + QByteArray::number(i) + "</text:p>";
+    }
+    m_content += "</office:document-content>\n";
+}
+
+// Does what invokeChain() does around the first of two filters, which
+// writes m_content to a storage
+void FilterChainIOTest::runFirstLink(KoFilterChain *chain)
+{
+    chain->m_chainLinks.first();
+    chain->m_state = KoFilterChain::Beginning;
+    KoStoreDevice *device = chain->storageFile("content.xml", KoStore::Write);
+    QVERIFY(device);
+    QCOMPARE(device->write(m_content), qint64(m_content.size()));
+
+    chain->m_state = KoFilterChain::Middle;
+    chain->manageIO();
+    chain->m_chainLinks.next();
+    chain->m_state = KoFilterChain::End;
+}
+
+void FilterChainIOTest::testStorageKeptInMemory()
+{
+    KoFilterManager manager(m_tempDir.path() + QLatin1String("/input.test"));
+    KoFilterChain::Ptr chain(new KoFilterChain(&manager));
+    chain->appendChainLink(KoFilterEntry::Ptr(), "application/x-test", odtMimeType);
+    chain->appendChainLink(KoFilterEntry::Ptr(), odtMimeType, "text/plain");
+
+    runFirstLink(chain.data());
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+
+    // handed over in memory, without a temporary file
+    QVERIFY(chain->m_inputBuffer);
+    QVERIFY(chain->m_inputFile.isEmpty());
+    QVERIFY(!chain->m_inputTempFile);
+    // stored, not deflated
+    QVERIFY(chain->m_inputBuffer->data().contains(m_content));
+
+    KoStoreDevice *device = chain->storageFile("content.xml", KoStore::Read);
+    QVERIFY(device);
+    QCOMPARE(device->readAll(), m_content);
+
+    chain->manageIO();
+    QVERIFY(!chain->m_inputBuffer);
+}
+
+void FilterChainIOTest::testStorageWrittenToInputFile()
+{
+    KoFilterManager manager(m_tempDir.path() + QLatin1String("/input.test"));
+    KoFilterChain::Ptr chain(new KoFilterChain(&manager));
+    chain->appendChainLink(KoFilterEntry::Ptr(), "application/x-test", odtMimeType);
+    chain->appendChainLink(KoFilterEntry::Ptr(), odtMimeType, "text/plain");
+
+    runFirstLink(chain.data());
+    if (QTest::currentTestFailed()) {
+        return;
+    }
+    QVERIFY(chain->m_inputBuffer);
+
+    // the second filter wants a file name, so the buffer is written out
+    const QString fileName = chain->inputFile();
+    QVERIFY(!fileName.isEmpty());
+    QVERIFY(QFile::exists(fileName));
+    QCOMPARE(chain->inputFile(), fileName);
+
+    KoStore *store = KoStore::createStore(fileName, KoStore::Read);
+    QVERIFY(store);
+    QVERIFY(!store->bad());
+    QVERIFY(store->open("content.xml"));
+    QCOMPARE(store->read(store->size()), m_content);
+    QVERIFY(store->close());
+    delete store;
+
+    // the temporary file goes with the input of the link
+    chain->manageIO();
+    QVERIFY(!chain->m_inputBuffer);
+    QVERIFY(chain->m_inputFile.isEmpty());
+    QVERIFY(!QFile::exists(fileName));
+}
+
+QTEST_GUILESS_MAIN(FilterChainIOTest)
@@ -0,0 +1,134 @@
+/* This file is part of the KDE project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "testfindtext.h"
+
+#include <QTextDocument>
+#include <QTextCursor>
+#include <QTest>
+
+#include "KoFindText.h"
+#include "KoFindOptionSet.h"
+
+// the matches QTextDocument::find() gives for all documents
+static QList<QPair<int, int> > expectedMatches(const QList<QTextDocument*> &documents, const QString &pattern, QTextDocument::FindFlags flags)
+{
+    QList<QPair<int, int> > result;
+    foreach (QTextDocument *document, documents) {
+        QTextCursor cursor = document->find(pattern, 0, flags);
+        while (!cursor.isNull()) {
+            result.append(qMakePair(cursor.selectionStart(), cursor.selectionEnd()));
+            cursor = document->find(pattern, cursor, flags);
+        }
+    }
+    return result;
+}
+
+static QList<QPair<int, int> > foundMatches(KoFindText &finder, const QString &pattern)
+{
+    finder.find(pattern);
+    QList<QPair<int, int> > result;
+    foreach (const KoFindMatch &match, finder.matches()) {
+        QTextCursor cursor = match.location().value<QTextCursor>();
+        result.append(qMakePair(cursor.selectionStart(), cursor.selectionEnd()));
+    }
+    return result;
+}
+
+static KoFindText *createFinder(const QList<QTextDocument*> &documents, QObject *parent)
+{
+    KoFindText *finder = new KoFindText(parent);
+    finder->options()->setOptionValue("fromCursor", false);
+    finder->setDocuments(documents);
+    return finder;
+}
+
+void TestFindText::testFindAsYouType()
+{
+    QTextDocument doc1;
+    QTextDocument doc2;
+    QTextCursor cursor(&doc1);
+    for (int i = 0; i < 200; ++i) {
+        cursor.insertText(QString("Paragraph %1 of the quick brown fox, quite quiet.").arg(i));
+        cursor.insertBlock();
+    }
+    doc2.setPlainText("Quick\nquicker than the quickest\n\nno match here");
+
+    QList<QTextDocument*> documents;
+    documents << &doc1 << &doc2;
+    KoFindText *finder = createFinder(documents, this);
+
+    const QStringList typed = QStringList() << "q" << "qu" << "qui" << "quic" << "quick" << "quicke" << "quick" << "qx" << "";
+    foreach (const QString &pattern, typed) {
+        QCOMPARE(foundMatches(*finder, pattern), expectedMatches(documents, pattern, 0));
+    }
+    QCOMPARE(foundMatches(*finder, "quick").count(), 203);
+    delete finder;
+}
+
+void TestFindText::testEditedDocument()
+{
+    QTextDocument doc;
+    doc.setPlainText("one two three\nfour five six\nseven eight nine");
+    QList<QTextDocument*> documents;
+    documents << &doc;
+    KoFindText *finder = createFinder(documents, this);
+
+    QCOMPARE(foundMatches(*finder, "e"), expectedMatches(documents, "e", 0));
+
+    QTextCursor cursor(&doc);
+    cursor.setPosition(5);
+    cursor.insertText("eleven\ntwelve ");
+    QCOMPARE(foundMatches(*finder, "e"), expectedMatches(documents, "e", 0));
+    QCOMPARE(foundMatches(*finder, "el"), expectedMatches(documents, "el", 0));
+
+    // join two paragraphs
+    cursor.movePosition(QTextCursor::NextBlock);
+    cursor.movePosition(QTextCursor::EndOfBlock);
+    cursor.deleteChar();
+    QCOMPARE(foundMatches(*finder, "ve"), expectedMatches(documents, "ve", 0));
+    QCOMPARE(foundMatches(*finder, "vef"), expectedMatches(documents, "vef", 0));
+
+    doc.setPlainText("replaced\ncontent");
+    QCOMPARE(foundMatches(*finder, "e"), expectedMatches(documents, "e", 0));
+    QCOMPARE(foundMatches(*finder, "ten"), expectedMatches(documents, "ten", 0));
+    delete finder;
+}
+
+void TestFindText::testOptions()
+{
+    QTextDocument doc;
+    doc.setPlainText(QString("Word words sword WORD word") + QChar(QChar::Nbsp) + "word");
+    QList<QTextDocument*> documents;
+    documents << &doc;
+    KoFindText *finder = createFinder(documents, this);
+
+    QCOMPARE(foundMatches(*finder, "word"), expectedMatches(documents, "word", 0));
+
+    finder->options()->setOptionValue("caseSensitive", true);
+    QCOMPARE(foundMatches(*finder, "Word"), expectedMatches(documents, "Word", QTextDocument::FindCaseSensitively));
+
+    finder->options()->setOptionValue("caseSensitive", false);
+    finder->options()->setOptionValue("wholeWords", true);
+    QCOMPARE(foundMatches(*finder, "wor"), expectedMatches(documents, "wor", QTextDocument::FindWholeWords));
+    QCOMPARE(foundMatches(*finder, "word"), expectedMatches(documents, "word", QTextDocument::FindWholeWords));
+    QCOMPARE(foundMatches(*finder, "word word"), expectedMatches(documents, "word word", QTextDocument::FindWholeWords));
+    delete finder;
+}
+
+QTEST_MAIN(TestFindText)
@@ -22,6 +22,7 @@
 #include "KoEncryptedStore.h"
 #include "KoEncryptionChecker.h"
 #include "KoStore_p.h"
+#include "KoMappedArchive.h"
 #include "KoXmlReader.h"
 #include <KoXmlNS.h>
 
@@ -73,6 +74,7 @@ KoEncryptedStore::KoEncryptedStore(const QString & filename, Mode mode,
                                    const QByteArray & appIdentification, bool writeMimetype)
   : KoStore(mode, writeMimetype)
   , m_filename(filename)
+  , m_mappedArchive(0)
   , m_tempFile(0)
   , m_bPasswordUsed(false)
   , m_bPasswordDeclined(false)
@@ -90,6 +92,7 @@ KoEncryptedStore::KoEncryptedStore(const QString & filename, Mode mode,
 KoEncryptedStore::KoEncryptedStore(QIODevice *dev, Mode mode, const QByteArray & appIdentification,
                                    bool writeMimetype)
     : KoStore(mode, writeMimetype)
+    , m_mappedArchive(0)
     , m_tempFile(0)
     , m_bPasswordUsed(false)
     , m_bPasswordDeclined(false)
@@ -108,6 +111,7 @@ KoEncryptedStore::KoEncryptedStore(QWidget* window, const QUrl &url, const QStri
                                    const QByteArray & appIdentification, bool writeMimetype)
     : KoStore(mode, writeMimetype)
     , m_filename(url.url())
+    , m_mappedArchive(0)
     , m_tempFile(0)
     , m_bPasswordUsed(false)
     , m_bPasswordDeclined(false)
@@ -166,6 +170,9 @@ void KoEncryptedStore::init(const QByteArray & appIdentification)
         if (!d->good) {
             return;
         }
+        if (!d->localFileName.isEmpty()) {
+            m_mappedArchive = new KoMappedArchive(d->localFileName);
+        }
 
         // Read the manifest-file, so we can get the data we'll need to decrypt the other files in the store
         const KArchiveEntry* manifestArchiveEntry = m_pZip->directory()->entry(MANIFEST_FILE);
@@ -459,6 +466,7 @@ KoEncryptedStore::~KoEncryptedStore()
     }
 
     delete m_pZip;
+    delete m_mappedArchive;
 
     if (d->fileMode == KoStorePrivate::RemoteWrite) {
         KIO::NetAccess::upload(d->localFileName, d->url, d->window);
@@ -514,9 +522,14 @@ bool KoEncryptedStore::openRead(const QString& name)
     const KZipFileEntry* fileZipEntry = static_cast<const KZipFileEntry*>(fileArchiveEntry);
 
     delete d->stream;
-    d->stream = fileZipEntry->createDevice();
+    const bool encrypted = m_encryptionData.contains(name);
+    // never hand out a view on encrypted bytes
+    d->stream = m_mappedArchive ? m_mappedArchive->createDevice(fileZipEntry, encrypted ? 0 : &d->mappedData) : 0;
+    if (!d->stream) {
+        d->stream = fileZipEntry->createDevice();
+    }
     d->size = fileZipEntry->size();
-    if (m_encryptionData.contains(name)) {
+    if (encrypted) {
         // This file is encrypted, do some decryption first
         if (m_bPasswordDeclined) {
             // The user has already declined to give a password
@@ -35,6 +35,7 @@ class QIODevice;
 class QWidget;
 class QUrl;
 class KZip;
+class KoMappedArchive;
 class KArchiveDirectory;
 class QTemporaryFile;
 struct KoEncryptedStore_EncryptionData;
@@ -118,6 +119,8 @@ protected:
     QString m_filename;
     QByteArray m_manifestBuffer;
     KZip *m_pZip;
+    /// In "Read" mode on a local file, the archive mapped into memory
+    KoMappedArchive *m_mappedArchive;
     QTemporaryFile *m_tempFile;
     bool m_bPasswordUsed;
     bool m_bPasswordDeclined;
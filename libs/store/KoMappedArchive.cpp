@@ -0,0 +1,205 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+
+#include "KoMappedArchive.h"
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QFile>
+
+#include <kzip.h>
+#include <StoreDebug.h>
+
+#include <zlib.h>
+#include <limits>
+#include <string.h>
+
+namespace {
+
+/**
+ * Read-only device that inflates a raw deflate stream directly from memory
+ * into the buffers passed to read().
+ * Seeking backwards restarts decompression from the start of the entry.
+ */
+class InflateDevice : public QIODevice
+{
+public:
+    InflateDevice(const uchar *data, qint64 compressedSize, qint64 size)
+        : m_data(data),
+          m_compressedSize(compressedSize),
+          m_size(size),
+          m_consumed(0),
+          m_inflated(0),
+          m_streamEnd(false)
+    {
+        memset(&m_zStream, 0, sizeof(m_zStream));
+        m_good = inflateInit2(&m_zStream, -MAX_WBITS) == Z_OK;
+        open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    }
+
+    ~InflateDevice()
+    {
+        if (m_good)
+            inflateEnd(&m_zStream);
+    }
+
+    virtual qint64 size() const {
+        return m_size;
+    }
+
+    virtual bool seek(qint64 pos) {
+        if (pos < 0 || pos > m_size)
+            return false;
+        return QIODevice::seek(pos);
+    }
+
+    virtual bool atEnd() const {
+        return pos() >= m_size;
+    }
+
+protected:
+    virtual qint64 readData(char *data, qint64 maxlen);
+
+    virtual qint64 writeData(const char *, qint64) {
+        return -1;
+    }
+
+private:
+    qint64 inflateInto(char *data, qint64 maxlen);
+
+    const uchar *m_data;
+    const qint64 m_compressedSize;
+    const qint64 m_size;
+    qint64 m_consumed; ///< compressed bytes handed to zlib so far
+    qint64 m_inflated; ///< uncompressed bytes produced so far
+    bool m_streamEnd;
+    bool m_good;
+    z_stream m_zStream;
+};
+
+qint64 InflateDevice::readData(char *data, qint64 maxlen)
+{
+    if (!m_good)
+        return -1;
+
+    const qint64 wanted = pos();
+    if (wanted < m_inflated) {
+        if (inflateReset(&m_zStream) != Z_OK)
+            return -1;
+        m_zStream.avail_in = 0;
+        m_consumed = 0;
+        m_inflated = 0;
+        m_streamEnd = false;
+    }
+    char skipBuffer[8192];
+    while (m_inflated < wanted) {
+        if (inflateInto(skipBuffer, qMin<qint64>(sizeof(skipBuffer), wanted - m_inflated)) <= 0)
+            return -1;
+    }
+
+    return inflateInto(data, qMin(maxlen, m_size - wanted));
+}
+
+qint64 InflateDevice::inflateInto(char *data, qint64 maxlen)
+{
+    // zlib counts in uInt, so feed it in chunks that always fit
+    const qint64 maxChunk = 1 << 30;
+    qint64 produced = 0;
+    while (produced < maxlen && !m_streamEnd) {
+        if (m_zStream.avail_in == 0) {
+            const qint64 remaining = m_compressedSize - m_consumed;
+            if (remaining <= 0)
+                break; // truncated entry, return what we have
+            const uInt chunk = uInt(qMin(remaining, maxChunk));
+            m_zStream.next_in = const_cast<Bytef *>(m_data + m_consumed);
+            m_zStream.avail_in = chunk;
+            m_consumed += chunk;
+        }
+        const uInt available = uInt(qMin(maxlen - produced, maxChunk));
+        m_zStream.next_out = reinterpret_cast<Bytef *>(data + produced);
+        m_zStream.avail_out = available;
+        const int ret = inflate(&m_zStream, Z_NO_FLUSH);
+        produced += available - m_zStream.avail_out;
+        if (ret == Z_STREAM_END) {
+            m_streamEnd = true;
+        } else if (ret != Z_OK) {
+            setErrorString(QString::fromLatin1(m_zStream.msg ? m_zStream.msg : "inflate failed"));
+            warnStore << "Error inflating zip entry:" << errorString();
+            m_inflated += produced;
+            return produced > 0 ? produced : -1;
+        }
+    }
+    m_inflated += produced;
+    return produced;
+}
+
+}
+
+KoMappedArchive::KoMappedArchive(const QString &fileName)
+    : m_file(new QFile(fileName)),
+      m_data(0),
+      m_size(0)
+{
+    if (m_file->open(QIODevice::ReadOnly) && m_file->size() > 0) {
+        m_size = m_file->size();
+        m_data = m_file->map(0, m_size);
+    }
+    if (!m_data) {
+        // not fatal, the stores fall back to KZip's devices
+        debugStore << "Could not map" << fileName << "into memory";
+        m_size = 0;
+        delete m_file;
+        m_file = 0;
+    }
+}
+
+KoMappedArchive::~KoMappedArchive()
+{
+    delete m_file; // unmaps
+}
+
+bool KoMappedArchive::isValid() const
+{
+    return m_data != 0;
+}
+
+QIODevice *KoMappedArchive::createDevice(const KZipFileEntry *entry, QByteArray *mappedData) const
+{
+    if (!m_data || entry->position() < 0 || entry->compressedSize() < 0
+            || entry->position() + entry->compressedSize() > m_size) {
+        return 0;
+    }
+    const uchar *data = m_data + entry->position();
+
+    if (entry->encoding() == 0 && entry->compressedSize() == entry->size()
+            && entry->size() <= std::numeric_limits<int>::max()) {
+        // stored entry: serve the mapped bytes as they are
+        const QByteArray view = QByteArray::fromRawData(reinterpret_cast<const char *>(data), entry->size());
+        if (mappedData)
+            *mappedData = view;
+        QBuffer *buffer = new QBuffer;
+        buffer->setData(view);
+        buffer->open(QIODevice::ReadOnly);
+        return buffer;
+    }
+    if (entry->encoding() == 8) {
+        return new InflateDevice(data, entry->compressedSize(), entry->size());
+    }
+    return 0;
+}
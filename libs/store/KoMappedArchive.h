@@ -0,0 +1,65 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+
+#ifndef KOMAPPEDARCHIVE_H
+#define KOMAPPEDARCHIVE_H
+
+#include <QtGlobal>
+
+class KZipFileEntry;
+class QByteArray;
+class QFile;
+class QIODevice;
+class QString;
+
+/**
+ * Read-only memory mapping of a local ZIP file, used by the ZIP based stores
+ * to serve entries without going through KZip's devices.
+ *
+ * Stored (uncompressed) entries are exposed as QByteArray::fromRawData views
+ * on the mapping, deflated entries are inflated straight from the mapping
+ * into the buffers passed to QIODevice::read().
+ */
+class KoMappedArchive
+{
+public:
+    explicit KoMappedArchive(const QString &fileName);
+    ~KoMappedArchive();
+
+    /// @return true if the file could be mapped
+    bool isValid() const;
+
+    /**
+     * Create a read-only device for @p entry.
+     * @param mappedData set to a zero-copy view on the entry if it is stored
+     * @return the device, or 0 if the entry cannot be served from the mapping
+     * (unknown compression method, entry outside of the file...), in which case
+     * KZipFileEntry::createDevice() has to be used
+     */
+    QIODevice *createDevice(const KZipFileEntry *entry, QByteArray *mappedData) const;
+
+private:
+    QFile *m_file;
+    const uchar *m_data;
+    qint64 m_size;
+
+    Q_DISABLE_COPY(KoMappedArchive)
+};
+
+#endif
@@ -270,6 +270,7 @@ bool KoStore::close()
 
     delete d->stream;
     d->stream = 0;
+    d->mappedData.clear();
     d->isOpen = false;
     return ret;
 }
@@ -284,6 +285,14 @@ QIODevice* KoStore::device() const
     return d->stream;
 }
 
+QByteArray KoStore::mappedData() const
+{
+    Q_D(const KoStore);
+    if (!d->isOpen || d->mode != Read)
+        return QByteArray();
+    return d->mappedData;
+}
+
 QByteArray KoStore::read(qint64 max)
 {
     Q_D(KoStore);
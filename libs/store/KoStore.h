@@ -141,6 +141,18 @@ public:
      */
     QIODevice *device() const;
 
+    /**
+     * Get the contents of the currently opened file without copying them,
+     * if the backend can provide that (e.g. an uncompressed entry of a ZIP
+     * store that was memory-mapped for reading).
+     * The returned array wraps memory owned by the store: it stays valid
+     * only until the store is destroyed, and must be deep-copied if it
+     * has to outlive it.
+     * You need to call @ref open first, and @ref close afterwards.
+     * @return the raw data, or a null QByteArray if not available
+     */
+    QByteArray mappedData() const;
+
     /**
      * Read data from the currently opened file. You can also use the streams
      * for this.
@@ -98,6 +98,9 @@ public:
     /// The stream for the current read or write operation
     QIODevice *stream;
 
+    /// Zero-copy view on the current file, if the backend provides one (read mode only)
+    QByteArray mappedData;
+
     bool isOpen;
     /// Must be set by the constructor.
     bool good;
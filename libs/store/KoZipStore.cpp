@@ -20,9 +20,12 @@
 
 #include "KoZipStore.h"
 #include "KoStore_p.h"
+#include "KoMappedArchive.h"
+#include "KoZipWriter.h"
 
 #include <QBuffer>
 #include <QByteArray>
+#include <QSaveFile>
 
 #include <kzip.h>
 #include <StoreDebug.h>
@@ -41,17 +44,17 @@ KoZipStore::KoZipStore(const QString & _filename, Mode mode, const QByteArray &
 
     d->localFileName = _filename;
 
-    m_pZip = new KZip(_filename);
+    m_pZip = mode == Read ? new KZip(_filename) : 0;
 
-    init(appIdentification);   // open the zip file and init some vars
+    init(appIdentification, 0);   // open the zip file and init some vars
 }
 
 KoZipStore::KoZipStore(QIODevice *dev, Mode mode, const QByteArray & appIdentification,
                        bool writeMimetype)
   : KoStore(mode, writeMimetype)
 {
-    m_pZip = new KZip(dev);
-    init(appIdentification);
+    m_pZip = mode == Read ? new KZip(dev) : 0;
+    init(appIdentification, dev);
 }
 
 KoZipStore::KoZipStore(QWidget* window, const QUrl &_url, const QString & _filename, Mode mode,
@@ -76,8 +79,8 @@ KoZipStore::KoZipStore(QWidget* window, const QUrl &_url, const QString & _filen
         d->localFileName = QLatin1String("/tmp/kozip"); // ### FIXME with KTempFile
     }
 
-    m_pZip = new KZip(d->localFileName);
-    init(appIdentification);   // open the zip file and init some vars
+    m_pZip = mode == Read ? new KZip(d->localFileName) : 0;
+    init(appIdentification, 0);   // open the zip file and init some vars
 }
 
 KoZipStore::~KoZipStore()
@@ -87,6 +90,9 @@ KoZipStore::~KoZipStore()
     if (!d->finalized)
         finalize(); // ### no error checking when the app forgot to call finalize itself
     delete m_pZip;
+    delete m_mappedArchive;
+    delete m_writer;
+    delete m_saveFile;
 
     // Now we have still some job to do for remote files.
     if (d->fileMode == KoStorePrivate::RemoteRead) {
@@ -97,53 +103,76 @@ KoZipStore::~KoZipStore()
     }
 }
 
-void KoZipStore::init(const QByteArray& appIdentification)
+void KoZipStore::init(const QByteArray& appIdentification, QIODevice *dev)
 {
     Q_D(KoStore);
 
     m_currentDir = 0;
-    d->good = m_pZip->open(d->mode == Write ? QIODevice::WriteOnly : QIODevice::ReadOnly);
-
-    if (!d->good)
-        return;
+    m_mappedArchive = 0;
+    m_writer = 0;
+    m_saveFile = 0;
+    m_device = dev;
 
     if (d->mode == Write) {
         //debugStore <<"KoZipStore::init writing mimetype" << appIdentification;
 
-        m_pZip->setCompression(KZip::NoCompression);
-        m_pZip->setExtraField(KZip::NoExtraField);
+        // KZip compresses on the calling thread, KoZipWriter uses all cores
+        if (!dev) {
+            m_saveFile = new QSaveFile(d->localFileName);
+            dev = m_saveFile;
+        }
+        m_writer = new KoZipWriter(dev);
+        d->good = m_writer->open();
+        if (!d->good)
+            return;
 
-        // Write identification
+        // Write identification, uncompressed and first in the archive
         if (d->writeMimetype) {
-            (void)m_pZip->writeFile(QLatin1String("mimetype"), appIdentification);
+            m_writer->setCompressionEnabled(false);
+            (void)(m_writer->prepareWriting(QLatin1String("mimetype"))
+                   && m_writer->writeData(appIdentification.constData(), appIdentification.size())
+                   && m_writer->finishWriting());
+            m_writer->setCompressionEnabled(true);
         }
-
-        m_pZip->setCompression(KZip::DeflateCompression);
-        // We don't need the extra field in Calligra - so we leave it as "no extra field".
+        // We don't need the extra field in Calligra - so KoZipWriter never writes one.
     } else {
-        d->good = m_pZip->directory() != 0;
+        d->good = m_pZip->open(QIODevice::ReadOnly) && m_pZip->directory() != 0;
+        if (d->good && !d->localFileName.isEmpty()) {
+            m_mappedArchive = new KoMappedArchive(d->localFileName);
+        }
     }
 }
 
 void KoZipStore::setCompressionEnabled(bool e)
 {
-    if (e) {
-        m_pZip->setCompression(KZip::DeflateCompression);
-    } else {
-        m_pZip->setCompression(KZip::NoCompression);        
+    if (m_writer) {
+        m_writer->setCompressionEnabled(e);
     }
 }
 
 bool KoZipStore::doFinalize()
 {
-    return m_pZip->close();
+    if (!m_writer) {
+        return m_pZip->close();
+    }
+
+    bool ok = m_writer->close();
+    if (m_saveFile) {
+        if (!ok) {
+            m_saveFile->cancelWriting();
+        }
+        ok = m_saveFile->commit() && ok;
+    } else {
+        m_device->close();
+    }
+    return ok;
 }
 
 bool KoZipStore::openWrite(const QString& name)
 {
     Q_D(KoStore);
     d->stream = 0; // Don't use!
-    return m_pZip->prepareWriting(name, "", "" /*m_pZip->rootDir()->user(), m_pZip->rootDir()->group()*/, 0);
+    return m_writer->prepareWriting(name);
 }
 
 bool KoZipStore::openRead(const QString& name)
@@ -160,7 +189,10 @@ bool KoZipStore::openRead(const QString& name)
     // Must cast to KZipFileEntry, not only KArchiveFile, because device() isn't virtual!
     const KZipFileEntry * f = static_cast<const KZipFileEntry *>(entry);
     delete d->stream;
-    d->stream = f->createDevice();
+    d->stream = m_mappedArchive ? m_mappedArchive->createDevice(f, &d->mappedData) : 0;
+    if (!d->stream) {
+        d->stream = f->createDevice();
+    }
     d->size = f->size();
     return true;
 }
@@ -181,7 +213,7 @@ qint64 KoZipStore::write(const char* _data, qint64 _len)
     }
 
     d->size += _len;
-    if (m_pZip->writeData(_data, _len))     // writeData returns a bool!
+    if (m_writer->writeData(_data, _len))     // writeData returns a bool!
         return _len;
     return 0;
 }
@@ -189,6 +221,9 @@ qint64 KoZipStore::write(const char* _data, qint64 _len)
 QStringList KoZipStore::directoryList() const
 {
     QStringList retval;
+    if (!m_pZip) {
+        return retval;
+    }
     const KArchiveDirectory *directory = m_pZip->directory();
     foreach(const QString &name, directory->entries()) {
         const KArchiveEntry* fileArchiveEntry = m_pZip->directory()->entry(name);
@@ -203,7 +238,7 @@ bool KoZipStore::closeWrite()
 {
     Q_D(KoStore);
     debugStore << "Wrote file" << d->fileName << " into ZIP archive. size" << d->size;
-    return m_pZip->finishWriting(d->size);
+    return m_writer->finishWriting();
 }
 
 bool KoZipStore::enterRelativeDirectory(const QString& dirName)
@@ -226,10 +261,14 @@ bool KoZipStore::enterRelativeDirectory(const QString& dirName)
 
 bool KoZipStore::enterAbsoluteDirectory(const QString& path)
 {
+    Q_D(KoStore);
     if (path.isEmpty()) {
         m_currentDir = 0;
         return true;
     }
+    if (d->mode == Write) {
+        return true;
+    }
     m_currentDir = dynamic_cast<const KArchiveDirectory*>(m_pZip->directory()->entry(path));
     Q_ASSERT(m_currentDir);
     return m_currentDir != 0;
@@ -237,6 +276,10 @@ bool KoZipStore::enterAbsoluteDirectory(const QString& path)
 
 bool KoZipStore::fileExists(const QString& absPath) const
 {
+    Q_D(const KoStore);
+    if (d->mode == Write) {
+        return d->filesList.contains(absPath);
+    }
     const KArchiveEntry *entry = m_pZip->directory()->entry(absPath);
     return entry && entry->isFile();
 }
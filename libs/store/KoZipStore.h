@@ -24,6 +24,9 @@
 
 class KZip;
 class KArchiveDirectory;
+class KoMappedArchive;
+class KoZipWriter;
+class QSaveFile;
 class QUrl;
 
 class KoZipStore : public KoStore
@@ -47,7 +50,7 @@ public:
     virtual QStringList directoryList() const;
 
 protected:
-    void init(const QByteArray& appIdentification);
+    void init(const QByteArray& appIdentification, QIODevice *dev);
     virtual bool doFinalize();
     virtual bool openWrite(const QString& name);
     virtual bool openRead(const QString& name);
@@ -61,9 +64,19 @@ protected:
 
 private:
 
-    /// The archive
+    /// The archive, in "Read" mode
     KZip * m_pZip;
 
+    /// In "Write" mode, compresses the entries in parallel
+    KoZipWriter *m_writer;
+    /// In "Write" mode on a file, the file being written
+    QSaveFile *m_saveFile;
+    /// In "Write" mode on a device, the device being written
+    QIODevice *m_device;
+
+    /// In "Read" mode on a local file, the archive mapped into memory
+    KoMappedArchive *m_mappedArchive;
+
     /** In "Read" mode this pointer is pointing to the
     current directory in the archive to speed up the verification process */
     const KArchiveDirectory* m_currentDir;
@@ -0,0 +1,471 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#include "KoZipWriter.h"
+
+#include <QDateTime>
+#include <QIODevice>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include <StoreDebug.h>
+
+#include <zlib.h>
+#include <string.h>
+
+namespace {
+
+/// The largest entry and archive without zip64
+const quint64 MaxZipSize = 0xffffffffULL;
+/// Deflate's window, the amount of history a block needs to compress as well as a continuous stream
+const int DictionarySize = 32 * 1024;
+
+void putUInt16(QByteArray &buffer, quint16 value)
+{
+    buffer.append(char(value & 0xff));
+    buffer.append(char((value >> 8) & 0xff));
+}
+
+void putUInt32(QByteArray &buffer, quint32 value)
+{
+    putUInt16(buffer, value & 0xffff);
+    putUInt16(buffer, value >> 16);
+}
+
+}
+
+const int KoZipWriter::BlockSize;
+const qint64 KoZipWriter::MaxPendingBytes;
+
+struct KoZipWriter::Block
+{
+    // input, read-only once the job runs, preceded by the dictionary
+    QByteArray input;
+    int offset;
+    int length;
+    bool deflate;
+    bool last;
+
+    // output, valid once done is set
+    QByteArray output;
+    quint32 crc;
+    bool ok;
+    bool done;
+};
+
+struct KoZipWriter::Entry
+{
+    Entry() : deflate(true), dosTime(0), dosDate(0), flags(0), size(0), finished(false),
+        headerWritten(false), headerOffset(0), written(0), crc(0), compressedSize(0) {}
+    ~Entry() { qDeleteAll(blocks); }
+
+    QByteArray name;
+    bool deflate;
+    quint16 dosTime;
+    quint16 dosDate;
+    quint16 flags;
+    quint64 size;
+    QByteArray buffer; //!< data not handed to a block yet, less than BlockSize
+    QByteArray dictionary; //!< the end of the data handed to the last block
+    QList<Block *> blocks; //!< the written ones are deleted and set to 0
+    bool finished; //!< all blocks are queued
+
+    // written so far
+    bool headerWritten;
+    quint64 headerOffset;
+    int written; //!< blocks
+    quint32 crc;
+    quint64 compressedSize;
+};
+
+class KoZipWriter::BlockJob : public QRunnable
+{
+public:
+    BlockJob(KoZipWriter *writer, Block *block) : m_writer(writer), m_block(block) {}
+
+    virtual void run();
+
+private:
+    KoZipWriter *m_writer;
+    Block *m_block;
+};
+
+void KoZipWriter::BlockJob::run()
+{
+    Block *b = m_block;
+    const Bytef *input = reinterpret_cast<const Bytef *>(b->input.constData()) + b->offset;
+    b->crc = crc32(crc32(0L, Z_NULL, 0), input, b->length);
+    b->ok = true;
+
+    if (b->deflate) {
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        b->ok = deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+        if (b->ok && b->offset > 0) {
+            const int dictionary = qMin(b->offset, DictionarySize);
+            b->ok = deflateSetDictionary(&zs, input - dictionary, dictionary) == Z_OK;
+        }
+        if (b->ok) {
+            // a sync flush ends the block on a byte boundary without marking it final,
+            // so the next block's output can simply be appended
+            const int flushMode = b->last ? Z_FINISH : Z_SYNC_FLUSH;
+            b->output.resize(deflateBound(&zs, b->length) + 16);
+            zs.next_in = const_cast<Bytef *>(input);
+            zs.avail_in = b->length;
+            int ret;
+            forever {
+                zs.next_out = reinterpret_cast<Bytef *>(b->output.data()) + zs.total_out;
+                zs.avail_out = b->output.size() - zs.total_out;
+                ret = deflate(&zs, flushMode);
+                if (ret != Z_OK || zs.avail_out != 0)
+                    break;
+                b->output.resize(b->output.size() * 2);
+            }
+            b->ok = b->last ? ret == Z_STREAM_END : (ret == Z_OK && zs.avail_in == 0);
+            b->output.resize(zs.total_out);
+            deflateEnd(&zs);
+        }
+    } else {
+        b->output = b->input.mid(b->offset, b->length);
+    }
+
+    m_writer->blockDone(b);
+}
+
+KoZipWriter::KoZipWriter(QIODevice *device)
+    : m_device(device),
+      m_pool(new QThreadPool),
+      m_compress(true),
+      m_good(false),
+      m_current(0),
+      m_pendingBytes(0),
+      m_offset(0),
+      m_entryCount(0)
+{
+    m_pool->setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+}
+
+KoZipWriter::~KoZipWriter()
+{
+    m_pool->waitForDone();
+    delete m_pool;
+    qDeleteAll(m_entries);
+}
+
+bool KoZipWriter::open()
+{
+    m_good = m_device->isOpen() || m_device->open(QIODevice::WriteOnly);
+    if (!m_good) {
+        warnStore << "Could not open device for writing:" << m_device->errorString();
+    }
+    return m_good;
+}
+
+void KoZipWriter::setCompressionEnabled(bool enabled)
+{
+    m_compress = enabled;
+}
+
+bool KoZipWriter::prepareWriting(const QString &name)
+{
+    if (!m_good)
+        return false;
+    if (m_current) {
+        warnStore << "prepareWriting called while" << m_current->name << "is not finished";
+        return false;
+    }
+
+    m_current = new Entry;
+    m_current->name = name.toUtf8();
+    m_current->deflate = m_compress;
+    // names with non-ASCII characters get the UTF-8 flag
+    bool ascii = true;
+    for (int i = 0; i < m_current->name.size() && ascii; ++i) {
+        ascii = uchar(m_current->name.at(i)) < 0x80;
+    }
+    m_current->flags = ascii ? 0 : 0x0800;
+    // the sizes follow the data when the header cannot be patched
+    if (m_device->isSequential()) {
+        m_current->flags |= 0x0008;
+    }
+
+    const QDateTime now = QDateTime::currentDateTime();
+    const QTime time = now.time();
+    const QDate date = now.date();
+    m_current->dosTime = (time.hour() << 11) | (time.minute() << 5) | (time.second() >> 1);
+    m_current->dosDate = ((date.year() - 1980) << 9) | (date.month() << 5) | date.day();
+    m_entries.append(m_current);
+    return true;
+}
+
+bool KoZipWriter::writeData(const char *data, qint64 length)
+{
+    if (!m_current)
+        return false;
+    if (m_current->size + length > MaxZipSize) {
+        warnStore << "Entry" << m_current->name << "is too big, zip64 is not supported";
+        return false;
+    }
+    m_current->size += length;
+    while (length > 0) {
+        const int chunk = int(qMin(qint64(BlockSize - m_current->buffer.size()), length));
+        m_current->buffer.append(data, chunk);
+        data += chunk;
+        length -= chunk;
+        if (m_current->buffer.size() == BlockSize) {
+            enqueue(m_current, false);
+            if (!flush(MaxPendingBytes))
+                return false;
+        }
+    }
+    return true;
+}
+
+bool KoZipWriter::finishWriting()
+{
+    if (!m_current)
+        return false;
+    Entry *entry = m_current;
+    m_current = 0;
+    enqueue(entry, true);
+    entry->finished = true;
+    return flush(MaxPendingBytes);
+}
+
+void KoZipWriter::enqueue(Entry *entry, bool last)
+{
+    Block *block = new Block;
+    block->input = entry->dictionary + entry->buffer;
+    block->offset = entry->dictionary.size();
+    block->length = entry->buffer.size();
+    block->deflate = entry->deflate;
+    block->last = last;
+    block->crc = 0;
+    block->ok = false;
+    block->done = false;
+    entry->blocks.append(block);
+
+    if (entry->deflate) {
+        entry->dictionary = entry->buffer.right(DictionarySize);
+    }
+    entry->buffer.clear();
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_pendingBytes += block->input.size();
+    }
+    m_pool->start(new BlockJob(this, block));
+}
+
+void KoZipWriter::blockDone(Block *block)
+{
+    QMutexLocker locker(&m_mutex);
+    m_pendingBytes += block->output.size() - block->input.size();
+    block->input.clear();
+    block->done = true;
+    m_blockDone.wakeAll();
+}
+
+qint64 KoZipWriter::pendingBytes()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_pendingBytes;
+}
+
+void KoZipWriter::waitFor(Block *block)
+{
+    QMutexLocker locker(&m_mutex);
+    while (!block->done) {
+        m_blockDone.wait(&m_mutex);
+    }
+}
+
+bool KoZipWriter::isDone(Block *block)
+{
+    QMutexLocker locker(&m_mutex);
+    return block->done;
+}
+
+bool KoZipWriter::flush(qint64 maxPendingBytes)
+{
+    while (!m_entries.isEmpty()) {
+        Entry *entry = m_entries.first();
+        if (!entry->headerWritten && !writeLocalHeader(entry))
+            return false;
+        while (entry->written < entry->blocks.count()) {
+            Block *block = entry->blocks.at(entry->written);
+            if (!isDone(block)) {
+                if (maxPendingBytes >= 0 && pendingBytes() <= maxPendingBytes)
+                    return true;
+                waitFor(block);
+            }
+            if (!writeBlock(entry, block))
+                return false;
+            entry->blocks[entry->written++] = 0;
+            delete block;
+        }
+        if (!entry->finished)
+            return true;
+        m_entries.removeFirst();
+        const bool ok = finishEntry(entry);
+        delete entry;
+        if (!ok)
+            return false;
+    }
+    return true;
+}
+
+bool KoZipWriter::writeLocalHeader(Entry *entry)
+{
+    if (m_offset > MaxZipSize) {
+        warnStore << "Archive too big, zip64 is not supported";
+        m_good = false;
+        return false;
+    }
+    entry->headerOffset = m_offset;
+    entry->headerWritten = true;
+
+    // crc and sizes are filled in by finishEntry()
+    QByteArray header;
+    putUInt32(header, 0x04034b50);
+    putUInt16(header, (entry->deflate || (entry->flags & 0x0008)) ? 20 : 10); // version needed
+    putUInt16(header, entry->flags);
+    putUInt16(header, entry->deflate ? 8 : 0); // method
+    putUInt16(header, entry->dosTime);
+    putUInt16(header, entry->dosDate);
+    putUInt32(header, 0); // crc
+    putUInt32(header, 0); // compressed size
+    putUInt32(header, 0); // size
+    putUInt16(header, entry->name.size());
+    putUInt16(header, 0); // no extra field
+    header.append(entry->name);
+    return writeToDevice(header);
+}
+
+bool KoZipWriter::writeBlock(Entry *entry, Block *block)
+{
+    if (!block->ok) {
+        warnStore << "Compressing" << entry->name << "failed";
+        m_good = false;
+        return false;
+    }
+    entry->crc = crc32_combine(entry->crc, block->crc, block->length);
+    entry->compressedSize += block->output.size();
+    if (entry->compressedSize > MaxZipSize) {
+        warnStore << "Entry" << entry->name << "is too big, zip64 is not supported";
+        m_good = false;
+        return false;
+    }
+    const bool ok = writeToDevice(block->output);
+    {
+        QMutexLocker locker(&m_mutex);
+        m_pendingBytes -= block->output.size();
+    }
+    return ok;
+}
+
+bool KoZipWriter::finishEntry(Entry *entry)
+{
+    const quint16 versionNeeded = (entry->deflate || (entry->flags & 0x0008)) ? 20 : 10;
+
+    QByteArray sizes;
+    putUInt32(sizes, entry->crc);
+    putUInt32(sizes, entry->compressedSize);
+    putUInt32(sizes, entry->size);
+    if (entry->flags & 0x0008) {
+        QByteArray descriptor;
+        putUInt32(descriptor, 0x08074b50);
+        descriptor.append(sizes);
+        if (!writeToDevice(descriptor))
+            return false;
+    } else {
+        // 14 is the offset of the crc in the local header
+        if (!m_device->seek(entry->headerOffset + 14) || m_device->write(sizes) != sizes.size()
+                || !m_device->seek(m_offset)) {
+            warnStore << "Writing to device failed:" << m_device->errorString();
+            m_good = false;
+            return false;
+        }
+    }
+
+    QByteArray &cd = m_centralDirectory;
+    putUInt32(cd, 0x02014b50);
+    putUInt16(cd, (3 << 8) | 20); // made by: unix, 2.0
+    putUInt16(cd, versionNeeded);
+    putUInt16(cd, entry->flags);
+    putUInt16(cd, entry->deflate ? 8 : 0); // method
+    putUInt16(cd, entry->dosTime);
+    putUInt16(cd, entry->dosDate);
+    cd.append(sizes);
+    putUInt16(cd, entry->name.size());
+    putUInt16(cd, 0); // extra field
+    putUInt16(cd, 0); // comment
+    putUInt16(cd, 0); // disk number
+    putUInt16(cd, 0); // internal attributes
+    putUInt32(cd, 0100644u << 16); // external attributes: regular file, rw-r--r--
+    putUInt32(cd, entry->headerOffset);
+    cd.append(entry->name);
+    ++m_entryCount;
+    return true;
+}
+
+bool KoZipWriter::writeToDevice(const QByteArray &data)
+{
+    if (m_device->write(data) != data.size()) {
+        warnStore << "Writing to device failed:" << m_device->errorString();
+        m_good = false;
+        return false;
+    }
+    m_offset += data.size();
+    return true;
+}
+
+bool KoZipWriter::close()
+{
+    if (m_current) {
+        warnStore << "Closing while" << m_current->name << "is not finished";
+        m_pool->waitForDone();
+        // the part written so far is not in the central directory
+        m_entries.removeOne(m_current);
+        delete m_current;
+        m_current = 0;
+    }
+    bool ok = m_good && flush(-1);
+
+    if (ok && (m_entryCount > 0xffff || m_offset > MaxZipSize
+               || m_offset + m_centralDirectory.size() > MaxZipSize)) {
+        warnStore << "Archive too big, zip64 is not supported";
+        ok = false;
+    }
+    if (ok) {
+        QByteArray end;
+        putUInt32(end, 0x06054b50);
+        putUInt16(end, 0); // this disk
+        putUInt16(end, 0); // disk with the central directory
+        putUInt16(end, m_entryCount);
+        putUInt16(end, m_entryCount);
+        putUInt32(end, m_centralDirectory.size());
+        putUInt32(end, m_offset);
+        putUInt16(end, 0); // comment
+        ok = writeToDevice(m_centralDirectory) && writeToDevice(end);
+    }
+    m_good = false;
+    return ok;
+}
@@ -0,0 +1,115 @@
+/* This file is part of the KDE project
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KOZIPWRITER_H
+#define KOZIPWRITER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QWaitCondition>
+
+class QIODevice;
+class QThreadPool;
+
+/**
+ * Writes a ZIP archive, deflating the entries on a thread pool.
+ *
+ * The data of an entry is cut into blocks, which are handed to the pool as
+ * soon as they are full, so they are compressed while the caller goes on
+ * producing the rest. The blocks are deflated independently (each primed
+ * with the previous 32 KiB as dictionary) and joined with sync flushes,
+ * the way pigz does, so one big content.xml also uses several cores.
+ * Entries are written to the device in the order they were added, which
+ * keeps an uncompressed "mimetype" written first in front.
+ *
+ * A block is written to the device as soon as it and the blocks before it
+ * are done, and the caller waits while more than MaxPendingBytes of blocks
+ * are queued, so big entries are streamed, stored ones too. The sizes and
+ * CRC of an entry are patched into its local header once it is finished;
+ * on a sequential device they follow the data in a data descriptor instead.
+ *
+ * No zip64 support: entries and archives are limited to 4 GiB.
+ */
+class KoZipWriter
+{
+public:
+    /// @p device is not owned, it is opened by open() if needed but never closed
+    explicit KoZipWriter(QIODevice *device);
+    ~KoZipWriter();
+
+    bool open();
+
+    /// Compression used for the entries started after this call
+    void setCompressionEnabled(bool enabled);
+
+    bool prepareWriting(const QString &name);
+    bool writeData(const char *data, qint64 length);
+    bool finishWriting();
+
+    /// Waits for all pending entries and writes the central directory.
+    bool close();
+
+    /// Blocks bigger than this are split, exposed for the tests
+    static const int BlockSize = 512 * 1024;
+    /// Memory held by queued blocks before the caller is throttled, exposed for the tests
+    static const qint64 MaxPendingBytes = 64 * 1024 * 1024;
+
+private:
+    struct Block;
+    struct Entry;
+    class BlockJob;
+
+    /// Hands the buffered data of @p entry to the pool as its next block
+    void enqueue(Entry *entry, bool last);
+    qint64 pendingBytes();
+    bool isDone(Block *block);
+    /**
+     * Writes the blocks that are done, in order, and the entries that are finished.
+     * Waits for the next block while more than @p maxPendingBytes are queued,
+     * a negative value waits for all of them.
+     */
+    bool flush(qint64 maxPendingBytes);
+    bool writeLocalHeader(Entry *entry);
+    bool writeBlock(Entry *entry, Block *block);
+    /// Completes the local header of @p entry and adds it to the central directory
+    bool finishEntry(Entry *entry);
+    void waitFor(Block *block);
+    void blockDone(Block *block);
+    bool writeToDevice(const QByteArray &data);
+
+    QIODevice *m_device;
+    QThreadPool *m_pool;
+    bool m_compress;
+    bool m_good;
+
+    Entry *m_current;
+    QList<Entry *> m_entries; //!< not completely written yet, in order, the current one last
+    qint64 m_pendingBytes; //!< input of the blocks being compressed and output not yet written, guarded by m_mutex
+
+    quint64 m_offset;
+    QByteArray m_centralDirectory;
+    int m_entryCount;
+
+    QMutex m_mutex;
+    QWaitCondition m_blockDone;
+
+    Q_DISABLE_COPY(KoZipWriter)
+};
+
+#endif
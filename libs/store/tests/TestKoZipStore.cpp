@@ -0,0 +1,273 @@
+/* This file is part of the KDE project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "TestKoZipStore.h"
+
+#include <KoStore.h>
+#include <KoZipWriter.h>
+
+#include <QBuffer>
+#include <QFile>
+#include <QTest>
+
+static const char mimeType[] = "application/vnd.oasis.opendocument.text";
+
+/// A buffer that cannot seek back, like a pipe or socket
+class SequentialBuffer : public QBuffer
+{
+public:
+    virtual bool isSequential() const { return true; }
+};
+
+void TestKoZipStore::initTestCase()
+{
+    QVERIFY(m_tempDir.isValid());
+    m_fileName = m_tempDir.path() + QLatin1String("/test.odt");
+
+    // compressible, but not trivially so
+    m_payload.reserve(256 * 1024);
+    for (int i = 0; m_payload.size() < 256 * 1024; ++i) {
+        m_payload += QByteArray::number(i * 7919 % 10007);
+        m_payload += ' ';
+    }
+
+    KoStore *store = KoStore::createStore(m_fileName, KoStore::Write, mimeType, KoStore::Zip);
+    QVERIFY(store);
+    QVERIFY(!store->bad());
+
+    store->setCompressionEnabled(false);
+    QVERIFY(store->open("Pictures/stored.bin"));
+    QCOMPARE(store->write(m_payload), qint64(m_payload.size()));
+    QVERIFY(store->close());
+
+    store->setCompressionEnabled(true);
+    QVERIFY(store->open("content.xml"));
+    QCOMPARE(store->write(m_payload), qint64(m_payload.size()));
+    QVERIFY(store->close());
+
+    QVERIFY(store->finalize());
+    delete store;
+}
+
+void TestKoZipStore::testMappedStoredEntry()
+{
+    KoStore *store = KoStore::createStore(m_fileName, KoStore::Read);
+    QVERIFY(store);
+    QVERIFY(!store->bad());
+
+    QVERIFY(store->open("Pictures/stored.bin"));
+    const QByteArray mapped = store->mappedData();
+    QVERIFY(!mapped.isNull());
+    QCOMPARE(mapped, m_payload);
+    QCOMPARE(store->read(store->size()), m_payload);
+    QVERIFY(store->close());
+    QVERIFY(store->mappedData().isNull());
+
+    delete store;
+}
+
+void TestKoZipStore::testInflatedEntry()
+{
+    KoStore *store = KoStore::createStore(m_fileName, KoStore::Read);
+    QVERIFY(store);
+
+    QVERIFY(store->open("content.xml"));
+    QVERIFY(store->mappedData().isNull());
+    QCOMPARE(store->size(), qint64(m_payload.size()));
+
+    // read in odd-sized pieces to exercise partial inflates
+    QByteArray result;
+    char buffer[1000];
+    qint64 read;
+    while ((read = store->read(buffer, sizeof(buffer))) > 0) {
+        result.append(buffer, read);
+    }
+    QCOMPARE(result, m_payload);
+    QVERIFY(store->atEnd());
+    QVERIFY(store->close());
+
+    delete store;
+}
+
+void TestKoZipStore::testInflatedEntrySeek()
+{
+    KoStore *store = KoStore::createStore(m_fileName, KoStore::Read);
+    QVERIFY(store);
+
+    QVERIFY(store->open("content.xml"));
+    QVERIFY(store->seek(100000));
+    QCOMPARE(store->read(64), m_payload.mid(100000, 64));
+    // backwards
+    QVERIFY(store->seek(10));
+    QCOMPARE(store->read(64), m_payload.mid(10, 64));
+    QVERIFY(store->close());
+
+    delete store;
+}
+
+void TestKoZipStore::testDeviceStoreHasNoMapping()
+{
+    QFile file(m_fileName);
+    KoStore *store = KoStore::createStore(&file, KoStore::Read);
+    QVERIFY(store);
+    QVERIFY(!store->bad());
+
+    QVERIFY(store->open("Pictures/stored.bin"));
+    QVERIFY(store->mappedData().isNull());
+    QCOMPARE(store->read(store->size()), m_payload);
+    QVERIFY(store->close());
+
+    delete store;
+}
+
+void TestKoZipStore::testMimetypeFirst()
+{
+    QFile file(m_fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray header = file.read(30 + 8 + sizeof(mimeType) - 1);
+
+    // local file header of a stored entry without extra field, as ODF requires
+    QCOMPARE(header.left(4), QByteArray("PK\x03\x04", 4));
+    QCOMPARE(int(uchar(header.at(8))), 0); // compression method
+    QCOMPARE(int(uchar(header.at(28))), 0); // extra field length
+    QCOMPARE(header.mid(30, 8), QByteArray("mimetype"));
+    QCOMPARE(header.mid(38), QByteArray(mimeType));
+}
+
+void TestKoZipStore::testParallelWriteRoundtrip()
+{
+    const QString fileName = m_tempDir.path() + QLatin1String("/parallel.odt");
+
+    // several entries, one of them spanning many compression blocks
+    QList<QByteArray> contents;
+    for (int i = 0; i < 20; ++i) {
+        contents << m_payload.left(i * 997);
+    }
+    QByteArray big;
+    while (big.size() < 5 * KoZipWriter::BlockSize + 123) {
+        big += m_payload;
+    }
+    contents << big;
+    // ends exactly on a block boundary
+    contents << big.left(2 * KoZipWriter::BlockSize);
+
+    KoStore *store = KoStore::createStore(fileName, KoStore::Write, mimeType, KoStore::Zip);
+    QVERIFY(store);
+    QVERIFY(!store->bad());
+    for (int i = 0; i < contents.count(); ++i) {
+        QVERIFY(store->open(QString("Pictures/%1.bin").arg(i)));
+        // in several writes
+        const QByteArray &data = contents.at(i);
+        for (int pos = 0; pos < data.size(); pos += 100000) {
+            QCOMPARE(store->write(data.mid(pos, 100000)), qint64(qMin(100000, data.size() - pos)));
+        }
+        QVERIFY(store->close());
+    }
+    QVERIFY(store->hasFile("Pictures/3.bin"));
+    QVERIFY(store->finalize());
+    delete store;
+
+    // read back through KZip's devices
+    QFile file(fileName);
+    store = KoStore::createStore(&file, KoStore::Read);
+    QVERIFY(store);
+    QVERIFY(!store->bad());
+    for (int i = 0; i < contents.count(); ++i) {
+        QVERIFY(store->open(QString("Pictures/%1.bin").arg(i)));
+        QCOMPARE(store->size(), qint64(contents.at(i).size()));
+        QCOMPARE(store->read(store->size()), contents.at(i));
+        QVERIFY(store->close());
+    }
+    delete store;
+}
+
+void TestKoZipStore::testLargeStoredEntryIsStreamed()
+{
+    QBuffer buffer;
+    KoStore *store = KoStore::createStore(&buffer, KoStore::Write, mimeType, KoStore::Zip);
+    QVERIFY(store);
+    QVERIFY(!store->bad());
+
+    // more than the writer may keep queued, so it has to write while the entry is open
+    store->setCompressionEnabled(false);
+    QVERIFY(store->open("Pictures/big.bin"));
+    qint64 size = 0;
+    while (size <= KoZipWriter::MaxPendingBytes + KoZipWriter::BlockSize) {
+        QCOMPARE(store->write(m_payload), qint64(m_payload.size()));
+        size += m_payload.size();
+    }
+    QVERIFY(buffer.size() > KoZipWriter::BlockSize);
+    QVERIFY(store->close());
+    QVERIFY(store->finalize());
+    delete store;
+
+    store = KoStore::createStore(&buffer, KoStore::Read);
+    QVERIFY(store);
+    QVERIFY(!store->bad());
+    QVERIFY(store->open("Pictures/big.bin"));
+    QCOMPARE(store->size(), size);
+    for (qint64 pos = 0; pos < size; pos += m_payload.size()) {
+        QCOMPARE(store->read(m_payload.size()), m_payload);
+    }
+    QVERIFY(store->close());
+    delete store;
+}
+
+void TestKoZipStore::testSequentialDevice()
+{
+    QByteArray big;
+    while (big.size() < 3 * KoZipWriter::BlockSize) {
+        big += m_payload;
+    }
+
+    SequentialBuffer output;
+    KoStore *store = KoStore::createStore(&output, KoStore::Write, mimeType, KoStore::Zip);
+    QVERIFY(store);
+    QVERIFY(!store->bad());
+    store->setCompressionEnabled(false);
+    QVERIFY(store->open("Pictures/stored.bin"));
+    QCOMPARE(store->write(m_payload), qint64(m_payload.size()));
+    QVERIFY(store->close());
+    store->setCompressionEnabled(true);
+    QVERIFY(store->open("content.xml"));
+    QCOMPARE(store->write(big), qint64(big.size()));
+    QVERIFY(store->close());
+    QVERIFY(store->finalize());
+    delete store;
+
+    // the sizes follow the data in data descriptors
+    const QByteArray data = output.data();
+    QCOMPARE(data.left(4), QByteArray("PK\x03\x04", 4));
+    QVERIFY(uchar(data.at(6)) & 0x08);
+    QVERIFY(data.contains(QByteArray("PK\x07\x08", 4)));
+
+    QBuffer input;
+    input.setData(data);
+    store = KoStore::createStore(&input, KoStore::Read);
+    QVERIFY(store);
+    QVERIFY(!store->bad());
+    QVERIFY(store->open("Pictures/stored.bin"));
+    QCOMPARE(store->read(store->size()), m_payload);
+    QVERIFY(store->close());
+    QVERIFY(store->open("content.xml"));
+    QCOMPARE(store->read(store->size()), big);
+    QVERIFY(store->close());
+    delete store;
+}
+
+QTEST_GUILESS_MAIN(TestKoZipStore)
@@ -100,6 +100,9 @@ void KoTextRange::setPositionOnlyMode(bool b)
 {
     Q_D(KoTextRange);
     d->positionOnlyMode = b;
+    if (d->manager) {
+        d->manager->textRangeMoved(this);
+    }
 }
 
 bool KoTextRange::hasRange() const
@@ -125,6 +128,9 @@ void KoTextRange::setRangeStart(int position)
     Q_D(KoTextRange);
     d->positionOnlyMode = true;
     d->cursor.setPosition(position);
+    if (d->manager) {
+        d->manager->textRangeMoved(this);
+    }
 }
 
 void KoTextRange::setRangeEnd(int position)
@@ -133,6 +139,9 @@ void KoTextRange::setRangeEnd(int position)
     d->positionOnlyMode = false;
     d->cursor.setPosition(d->cursor.selectionStart());
     d->cursor.setPosition(position, QTextCursor::KeepAnchor);
+    if (d->manager) {
+        d->manager->textRangeMoved(this);
+    }
 }
 
 QString KoTextRange::text() const
@@ -165,4 +174,7 @@ void KoTextRange::restore()
     Q_D(KoTextRange);
     d->cursor.setPosition(d->snapAnchor);
     d->cursor.setPosition(d->snapPos, QTextCursor::KeepAnchor);
+    if (d->manager) {
+        d->manager->textRangeMoved(this);
+    }
 }
@@ -24,6 +24,56 @@
 
 #include "TextDebug.h"
 
+#include <QTextDocument>
+
+#include <algorithm>
+
+namespace
+{
+
+bool startsBefore(const KoTextRange *range, int position)
+{
+    return range->rangeStart() < position;
+}
+
+bool endsBefore(const KoTextRange *range, int position)
+{
+    return range->rangeEnd() < position;
+}
+
+void collectTextRange(QHash<int, KoTextRange *> &ranges, KoTextRange *range, int first, int last, int matchFirst, int matchLast)
+{
+    if (!range->hasRange()) {
+        if (range->rangeStart() >= first && range->rangeStart() <= last) {
+            ranges.insertMulti(range->rangeStart(), range);
+        }
+    } else {
+        if (range->rangeStart() >= first && range->rangeStart() <= last) {
+            if (matchLast == -1 || range->rangeEnd() <= matchLast) {
+                if (range->rangeEnd() >= matchFirst) {
+                    ranges.insertMulti(range->rangeStart(), range);
+                }
+            }
+        }
+        if (range->rangeEnd() >= first && range->rangeEnd() <= last) {
+            if (matchLast == -1 || range->rangeStart() <= matchLast) {
+                if (range->rangeStart() >= matchFirst) {
+                    ranges.insertMulti(range->rangeEnd(), range);
+                }
+            }
+        }
+        if (range->rangeStart() >= first && range->rangeStart() <= last) {
+            if (matchLast == -1 || range->rangeEnd() >= matchLast) {
+                if (range->rangeEnd() >= matchFirst) {
+                    ranges.insert(range->rangeStart(), range);
+                }
+            }
+        }
+    }
+}
+
+}
+
 KoTextRangeManager::KoTextRangeManager(QObject *parent)
     : QObject(parent)
 {
@@ -50,6 +100,7 @@ void KoTextRangeManager::insert(KoTextRange *textRange)
     } else {
         textRange->setManager(this);
     }
+    invalidatePositionIndex(textRange->document());
 
     KoBookmark *bookmark = dynamic_cast<KoBookmark *>(textRange);
     if (bookmark) {
@@ -84,6 +135,14 @@ void KoTextRangeManager::remove(KoTextRange *textRange)
     m_textRanges.remove(textRange);
     m_deletedTextRanges.insert(textRange);
     textRange->snapshot();
+    invalidatePositionIndex(textRange->document());
+}
+
+void KoTextRangeManager::textRangeMoved(KoTextRange *range)
+{
+    if (m_textRanges.contains(range)) {
+        invalidatePositionIndex(range->document());
+    }
 }
 
 const KoBookmarkManager *KoTextRangeManager::bookmarkManager() const
@@ -105,37 +164,71 @@ QList<KoTextRange *> KoTextRangeManager::textRanges() const
 QHash<int, KoTextRange *> KoTextRangeManager::textRangesChangingWithin(const QTextDocument *doc, int first, int last, int matchFirst, int matchLast) const
 {
     QHash<int, KoTextRange *> ranges;
-    foreach (KoTextRange *range, m_textRanges) {
-        if (range->document() != doc) {
-            continue;
-        }
-        if (!range->hasRange()) {
-            if (range->rangeStart() >= first && range->rangeStart() <= last) {
-                ranges.insertMulti(range->rangeStart(), range);
-            }
-        } else {
-            if (range->rangeStart() >= first && range->rangeStart() <= last) {
-                if (matchLast == -1 || range->rangeEnd() <= matchLast) {
-                    if (range->rangeEnd() >= matchFirst) {
-                        ranges.insertMulti(range->rangeStart(), range);
-                    }
-                }
-            }
-            if (range->rangeEnd() >= first && range->rangeEnd() <= last) {
-                if (matchLast == -1 || range->rangeStart() <= matchLast) {
-                    if (range->rangeStart() >= matchFirst) {
-                        ranges.insertMulti(range->rangeEnd(), range);
-                    }
-                }
-            }
-            if (range->rangeStart() >= first && range->rangeStart() <= last) {
-                if (matchLast == -1 || range->rangeEnd() >= matchLast) {
-                    if (range->rangeEnd() >= matchFirst) {
-                        ranges.insert(range->rangeStart(), range);
-                    }
-                }
-            }
+    if (first > last) {
+        return ranges;
+    }
+
+    const PositionIndex &index = positionIndex(doc);
+
+    QVector<KoTextRange *>::const_iterator it = std::lower_bound(index.byStart.constBegin(), index.byStart.constEnd(), first, startsBefore);
+    for (; it != index.byStart.constEnd() && (*it)->rangeStart() <= last; ++it) {
+        collectTextRange(ranges, *it, first, last, matchFirst, matchLast);
+    }
+
+    // ranges starting within the interval have been collected above already
+    it = std::lower_bound(index.byEnd.constBegin(), index.byEnd.constEnd(), first, endsBefore);
+    for (; it != index.byEnd.constEnd() && (*it)->rangeEnd() <= last; ++it) {
+        if ((*it)->rangeStart() < first) {
+            collectTextRange(ranges, *it, first, last, matchFirst, matchLast);
         }
     }
     return ranges;
 }
+
+const KoTextRangeManager::PositionIndex &KoTextRangeManager::positionIndex(const QTextDocument *document) const
+{
+    QHash<const QTextDocument *, PositionIndex>::const_iterator it = m_positionIndexes.constFind(document);
+    if (it != m_positionIndexes.constEnd()) {
+        return it.value();
+    }
+
+    PositionIndex &index = m_positionIndexes[document];
+    foreach (KoTextRange *range, m_textRanges) {
+        if (range->document() == document) {
+            index.byStart.append(range);
+        }
+    }
+    index.byEnd = index.byStart;
+    std::sort(index.byStart.begin(), index.byStart.end(), [](const KoTextRange *a, const KoTextRange *b) {
+        return a->rangeStart() < b->rangeStart();
+    });
+    std::sort(index.byEnd.begin(), index.byEnd.end(), [](const KoTextRange *a, const KoTextRange *b) {
+        return a->rangeEnd() < b->rangeEnd();
+    });
+
+    if (document) {
+        connect(document, SIGNAL(destroyed(QObject*)), this, SLOT(documentDestroyed(QObject*)), Qt::UniqueConnection);
+        connect(document, SIGNAL(contentsChange(int,int,int)),
+                this, SLOT(documentContentsChanged(int,int,int)), Qt::UniqueConnection);
+    }
+    return index;
+}
+
+void KoTextRangeManager::invalidatePositionIndex(const QTextDocument *document)
+{
+    m_positionIndexes.remove(document);
+}
+
+void KoTextRangeManager::documentDestroyed(QObject *document)
+{
+    m_positionIndexes.remove(static_cast<QTextDocument *>(document));
+}
+
+void KoTextRangeManager::documentContentsChanged(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(position);
+    Q_UNUSED(charsRemoved);
+    if (charsAdded > 0) {
+        m_positionIndexes.remove(static_cast<QTextDocument *>(sender()));
+    }
+}
@@ -29,6 +29,7 @@
 #include <QMetaType>
 #include <QHash>
 #include <QSet>
+#include <QVector>
 
 
 /**
@@ -74,9 +75,39 @@ public:
      */
     QHash<int, KoTextRange *> textRangesChangingWithin(const QTextDocument *, int first, int last, int matchFirst, int matchLast) const;
 
+    /**
+     * Called by a text range whose positions were set directly, as opposed to
+     * being moved along by edits of its document.
+     * @param range the text range that moved
+     */
+    void textRangeMoved(KoTextRange *range);
+
+private Q_SLOTS:
+    void documentDestroyed(QObject *document);
+    void documentContentsChanged(int position, int charsRemoved, int charsAdded);
+
 private:
+    /**
+     * The text ranges of one document sorted by their start and by their end.
+     *
+     * Removing text moves all positions monotonically, so the order survives
+     * it. Inserting text does not: a selection range keeps only its cursor
+     * position on insert, so its anchor moves past point ranges sharing the
+     * insert position. Insertions, and ranges being added, removed or set to
+     * new positions, invalidate the index.
+     */
+    struct PositionIndex
+    {
+        QVector<KoTextRange *> byStart;
+        QVector<KoTextRange *> byEnd;
+    };
+
+    const PositionIndex &positionIndex(const QTextDocument *document) const;
+    void invalidatePositionIndex(const QTextDocument *document);
+
     QSet<KoTextRange *> m_textRanges;
     QSet<KoTextRange *> m_deletedTextRanges; // kept around for undo purposes
+    mutable QHash<const QTextDocument *, PositionIndex> m_positionIndexes;
 
     KoBookmarkManager m_bookmarkManager;
     KoAnnotationManager m_annotationManager;
@@ -63,6 +63,7 @@ DeleteCommand::DeleteCommand(DeleteMode mode,
     , m_shapeController(shapeController)
     , m_first(true)
     , m_mode(mode)
+    , m_deletedLength(0)
     , m_mergePossible(true)
 {
     setText(kundo2_i18n("Delete"));
@@ -481,6 +482,7 @@ void DeleteCommand::doDelete()
     }
 
     // Actual deletion of text
+    m_deletedLength = textEditor->selectionEnd() - textEditor->selectionStart();
     caret->deleteChar();
 
     if (m_mode != PreviousChar || !caretAtBeginOfBlock) {
@@ -547,6 +549,7 @@ bool DeleteCommand::mergeWith(const KUndo2Command *command)
 
     m_invalidInlineObjects += other->m_invalidInlineObjects;
     other->m_invalidInlineObjects.clear();
+    m_deletedLength += other->m_deletedLength;
 
     for (int i=0; i < command->childCount(); i++)
         new UndoTextCommand(const_cast<QTextDocument*>(textEditor->document()), this);
@@ -554,6 +557,11 @@ bool DeleteCommand::mergeWith(const KUndo2Command *command)
     return true;
 }
 
+qint64 DeleteCommand::memoryCost() const
+{
+    return KoTextCommandBase::memoryCost() + m_deletedLength * qint64(sizeof(QChar));
+}
+
 bool DeleteCommand::checkMerge(const KUndo2Command *command)
 {
     DeleteCommand *other = const_cast<DeleteCommand *>(static_cast<const DeleteCommand *>(command));
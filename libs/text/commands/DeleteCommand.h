@@ -54,6 +54,7 @@ public:
 
     virtual int id() const;
     virtual bool mergeWith(const KUndo2Command *command);
+    virtual qint64 memoryCost() const;
 
 private:
     friend class DeleteVisitor;
@@ -83,6 +84,7 @@ private:
     DeleteMode m_mode;
     int m_position;
     int m_length;
+    int m_deletedLength; // the document keeps these characters for undo
     QTextCharFormat m_format;
     bool m_mergePossible;
 
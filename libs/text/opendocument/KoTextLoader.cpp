@@ -150,6 +150,15 @@ public:
 
     QStringList rdfIdList;
 
+    // Formats produced by applying a character style on top of a given
+    // cursor format. Spans mostly repeat the same few combinations, so this
+    // saves merging the style properties again for every span.
+    struct AppliedCharacterStyle {
+        QTextCharFormat base;
+        QTextCharFormat result;
+    };
+    QHash<const KoCharacterStyle *, QVector<AppliedCharacterStyle> > appliedCharacterStyles;
+
     /// level is between 1 and 10
     void setCurrentList(KoList *currentList, int level);
     /// level is between 1 and 10
@@ -184,6 +193,7 @@ public:
     }
 
     KoList *list(const QTextDocument *document, KoListStyle *listStyle, bool mergeSimilarStyledList);
+    void applyCharacterStyle(const KoCharacterStyle *characterStyle, QTextCursor &cursor);
 };
 
 KoList *KoTextLoader::Private::list(const QTextDocument *document, KoListStyle *listStyle, bool mergeSimilarStyledList)
@@ -200,6 +210,33 @@ KoList *KoTextLoader::Private::list(const QTextDocument *document, KoListStyle *
     return newList;
 }
 
+void KoTextLoader::Private::applyCharacterStyle(const KoCharacterStyle *characterStyle, QTextCursor &cursor)
+{
+    // keep the list per style short, nested spans only produce a handful of bases
+    const int maxFormatsPerStyle = 16;
+
+    const QTextCharFormat base = cursor.charFormat();
+    QVector<AppliedCharacterStyle> &applied = appliedCharacterStyles[characterStyle];
+    foreach (const AppliedCharacterStyle &entry, applied) {
+        if (entry.base == base) {
+            cursor.setCharFormat(entry.result);
+            return;
+        }
+    }
+
+    // same as KoCharacterStyle::applyStyle(QTextCursor*), which also marks the style as used
+    AppliedCharacterStyle entry;
+    entry.base = base;
+    entry.result = base;
+    characterStyle->applyStyle(entry.result);
+    characterStyle->ensureMinimalProperties(entry.result);
+    if (applied.size() >= maxFormatsPerStyle) {
+        applied.remove(0);
+    }
+    applied.append(entry);
+    cursor.setCharFormat(entry.result);
+}
+
 void KoTextLoader::Private::setCurrentList(KoList *currentList, int level)
 {
     Q_ASSERT(level > 0 && level <= 10);
@@ -951,7 +988,7 @@ void KoTextLoader::loadSpan(const KoXmlElement &element, QTextCursor &cursor, bo
 
             KoCharacterStyle *characterStyle = d->textSharedData->characterStyle(styleName, d->stylesDotXml);
             if (characterStyle) {
-                characterStyle->applyStyle(&cursor);
+                d->applyCharacterStyle(characterStyle, cursor);
                 if (ts.firstChild().isNull()) {
                     // empty span so let's save the characterStyle for possible use at end of par
                     d->endCharStyle = characterStyle;
@@ -984,7 +1021,7 @@ void KoTextLoader::loadSpan(const KoXmlElement &element, QTextCursor &cursor, bo
             if (!styleName.isEmpty()) {
                 KoCharacterStyle *characterStyle = d->textSharedData->characterStyle(styleName, d->stylesDotXml);
                 if (characterStyle) {
-                    characterStyle->applyStyle(&cursor);
+                    d->applyCharacterStyle(characterStyle, cursor);
                 } else {
                     warnText << "character style " << styleName << " not found";
                 }
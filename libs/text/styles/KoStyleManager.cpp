@@ -575,13 +575,17 @@ void KoStyleManager::add(KoTextTableTemplate *tableTemplate)
 
 void KoStyleManager::slotAppliedStyle(const KoParagraphStyle *style)
 {
-    d->m_usedParagraphStyles.append(style->styleId());
+    if (!d->m_usedParagraphStyles.contains(style->styleId())) {
+        d->m_usedParagraphStyles.append(style->styleId());
+    }
     emit styleApplied(style);
 }
 
 void KoStyleManager::slotAppliedStyle(const KoCharacterStyle *style)
 {
-    d->m_usedCharacterStyles.append(style->styleId());
+    if (!d->m_usedCharacterStyles.contains(style->styleId())) {
+        d->m_usedCharacterStyles.append(style->styleId());
+    }
     emit styleApplied(style);
 }
 
@@ -0,0 +1,224 @@
+/* This file is part of the KDE project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#include "TestKoTextRangeManager.h"
+
+#include <QTest>
+#include <QTextCursor>
+#include <QTextDocument>
+
+#include <KoTextRangeManager.h>
+#include <KoBookmark.h>
+
+#include <algorithm>
+
+typedef QList<QPair<int, KoTextRange *> > RangeList;
+
+static RangeList sorted(const QHash<int, KoTextRange *> &hash)
+{
+    RangeList list;
+    for (QHash<int, KoTextRange *>::const_iterator it = hash.constBegin(); it != hash.constEnd(); ++it) {
+        list.append(qMakePair(it.key(), it.value()));
+    }
+    std::sort(list.begin(), list.end());
+    return list;
+}
+
+// the plain scan over all ranges the index has to agree with
+static RangeList scan(const KoTextRangeManager &manager, const QTextDocument *doc, int first, int last, int matchFirst, int matchLast)
+{
+    QHash<int, KoTextRange *> ranges;
+    foreach (KoTextRange *range, manager.textRanges()) {
+        if (range->document() != doc) {
+            continue;
+        }
+        const int start = range->rangeStart();
+        const int end = range->rangeEnd();
+        if (!range->hasRange()) {
+            if (start >= first && start <= last) {
+                ranges.insertMulti(start, range);
+            }
+            continue;
+        }
+        if (start >= first && start <= last && (matchLast == -1 || end <= matchLast) && end >= matchFirst) {
+            ranges.insertMulti(start, range);
+        }
+        if (end >= first && end <= last && (matchLast == -1 || start <= matchLast) && start >= matchFirst) {
+            ranges.insertMulti(end, range);
+        }
+        if (start >= first && start <= last && (matchLast == -1 || end >= matchLast) && end >= matchFirst) {
+            ranges.insert(start, range);
+        }
+    }
+    return sorted(ranges);
+}
+
+static KoBookmark *addBookmark(KoTextRangeManager &manager, QTextDocument &doc, int start, int end)
+{
+    QTextCursor cursor(&doc);
+    cursor.setPosition(start);
+    if (end != start) {
+        cursor.setPosition(end, QTextCursor::KeepAnchor);
+    }
+    KoBookmark *bookmark = new KoBookmark(cursor);
+    bookmark->setName(QString("mark%1-%2").arg(start).arg(end));
+    manager.insert(bookmark);
+    return bookmark;
+}
+
+static void compareAllWindows(const KoTextRangeManager &manager, const QTextDocument &doc)
+{
+    const int length = doc.characterCount();
+    for (int first = 0; first < length; first += 7) {
+        for (int last = first; last < length; last += 13) {
+            QCOMPARE(sorted(manager.textRangesChangingWithin(&doc, first, last, first, last)),
+                     scan(manager, &doc, first, last, first, last));
+            QCOMPARE(sorted(manager.textRangesChangingWithin(&doc, first, last, 0, -1)),
+                     scan(manager, &doc, first, last, 0, -1));
+        }
+    }
+}
+
+void TestKoTextRangeManager::testRangesChangingWithin()
+{
+    QTextDocument doc;
+    doc.setPlainText(QString(200, QChar('x')));
+    KoTextRangeManager manager;
+
+    KoBookmark *point = addBookmark(manager, doc, 10, 10);
+    KoBookmark *inner = addBookmark(manager, doc, 22, 31);
+    KoBookmark *outer = addBookmark(manager, doc, 45, 120);
+    KoBookmark *tail = addBookmark(manager, doc, 150, 199);
+
+    RangeList expected;
+    expected << qMakePair(10, static_cast<KoTextRange *>(point));
+    expected << qMakePair(22, static_cast<KoTextRange *>(inner));
+    expected << qMakePair(31, static_cast<KoTextRange *>(inner));
+    QCOMPARE(sorted(manager.textRangesChangingWithin(&doc, 0, 40, 0, 40)), expected);
+
+    compareAllWindows(manager, doc);
+
+    QTextDocument otherDoc;
+    otherDoc.setPlainText(QString(200, QChar('y')));
+    QVERIFY(manager.textRangesChangingWithin(&otherDoc, 0, 199, 0, -1).isEmpty());
+
+    delete point;
+    delete inner;
+    delete outer;
+    delete tail;
+}
+
+void TestKoTextRangeManager::testRangesFollowEdits()
+{
+    QTextDocument doc;
+    doc.setPlainText(QString(300, QChar('x')));
+    KoTextRangeManager manager;
+
+    QList<KoBookmark *> bookmarks;
+    for (int i = 0; i < 280; i += 17) {
+        bookmarks << addBookmark(manager, doc, i, i + (i % 3) * 9);
+    }
+    compareAllWindows(manager, doc);
+
+    // the edits avoid collapsing range ends onto each other, as ranges sharing
+    // a position are reported in an unspecified order
+    QTextCursor cursor(&doc);
+    cursor.setPosition(40);
+    cursor.insertText(QString(25, QChar('y')));
+    compareAllWindows(manager, doc);
+
+    cursor.setPosition(128);
+    cursor.setPosition(143, QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    compareAllWindows(manager, doc);
+
+    doc.undo();
+    compareAllWindows(manager, doc);
+
+    qDeleteAll(bookmarks);
+}
+
+// the positions reported, which do not depend on the order of ranges sharing one
+static QList<int> positions(const QHash<int, KoTextRange *> &hash)
+{
+    QList<int> keys = hash.uniqueKeys();
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+void TestKoTextRangeManager::testInsertAtSharedPosition()
+{
+    QTextDocument doc;
+    doc.setPlainText(QString(200, QChar('x')));
+    KoTextRangeManager manager;
+
+    // indexed with the selection starting before the point
+    KoBookmark *selection = addBookmark(manager, doc, 49, 80);
+    KoBookmark *point = addBookmark(manager, doc, 50, 50);
+    compareAllWindows(manager, doc);
+
+    // removing text keeps the order, both now start at 49
+    QTextCursor cursor(&doc);
+    cursor.setPosition(49);
+    cursor.deleteChar();
+    QCOMPARE(selection->rangeStart(), 49);
+    QCOMPARE(point->rangeStart(), 49);
+    QCOMPARE(positions(manager.textRangesChangingWithin(&doc, 49, 49, 0, -1)), QList<int>() << 49);
+
+    // the anchor of the selection moves on insert, the point stays
+    cursor.setPosition(49);
+    cursor.insertText(QString(5, QChar('y')));
+    QCOMPARE(selection->rangeStart(), 54);
+    QCOMPARE(point->rangeStart(), 49);
+
+    QCOMPARE(manager.textRangesChangingWithin(&doc, 49, 49, 0, -1).value(49), static_cast<KoTextRange *>(point));
+    QCOMPARE(positions(manager.textRangesChangingWithin(&doc, 40, 60, 0, -1)), QList<int>() << 49 << 54);
+    compareAllWindows(manager, doc);
+
+    delete selection;
+    delete point;
+}
+
+void TestKoTextRangeManager::testMovedAndRemovedRanges()
+{
+    QTextDocument doc;
+    doc.setPlainText(QString(200, QChar('x')));
+    KoTextRangeManager manager;
+
+    KoBookmark *first = addBookmark(manager, doc, 10, 20);
+    KoBookmark *second = addBookmark(manager, doc, 50, 60);
+    compareAllWindows(manager, doc);
+
+    // jump the first range behind the second one
+    first->setRangeStart(100);
+    first->setRangeEnd(110);
+    compareAllWindows(manager, doc);
+    QCOMPARE(manager.textRangesChangingWithin(&doc, 100, 100, 0, -1).value(100), static_cast<KoTextRange *>(first));
+
+    manager.remove(second);
+    compareAllWindows(manager, doc);
+    QVERIFY(manager.textRangesChangingWithin(&doc, 50, 60, 0, -1).isEmpty());
+
+    manager.insert(second);
+    compareAllWindows(manager, doc);
+    QCOMPARE(manager.textRangesChangingWithin(&doc, 50, 50, 50, 60).value(50), static_cast<KoTextRange *>(second));
+
+    delete first;
+    delete second;
+}
+
+QTEST_MAIN(TestKoTextRangeManager)
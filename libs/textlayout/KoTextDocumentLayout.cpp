@@ -50,13 +50,20 @@
 #include <KoTableStyle.h>
 
 #include <TextLayoutDebug.h>
+#include <QCache>
 #include <QTextBlock>
 #include <QTextTable>
 #include <QTimer>
 #include <QList>
+#include <QVector>
+
+#include <algorithm>
 
 extern int qt_defaultDpiY();
 
+// Providers suggest this height (or more) for root-areas which grow with their content
+static const qreal UnboundedRootAreaHeight = 1E6;
+
 
 KoInlineObjectExtent::KoInlineObjectExtent(qreal ascent, qreal descent)
     : m_ascent(ascent),
@@ -64,6 +71,13 @@ KoInlineObjectExtent::KoInlineObjectExtent(qreal ascent, qreal descent)
 {
 }
 
+KoDropCapsFit::KoDropCapsFit(qreal pointSize, qreal width, qreal positionAdjust)
+    : m_pointSize(pointSize),
+      m_width(width),
+      m_positionAdjust(positionAdjust)
+{
+}
+
 class Q_DECL_HIDDEN KoTextDocumentLayout::Private
 {
 public:
@@ -92,6 +106,7 @@ public:
        , restartLayout(false)
        , wordprocessingMode(false)
        , showInlineObjectVisualization(false)
+       , dropCapsFits(256)
     {
     }
     KoStyleManager *styleManager;
@@ -103,6 +118,9 @@ public:
     KoTextLayoutRootAreaProvider *provider;
     KoPostscriptPaintDevice *paintDevice;
     QList<KoTextLayoutRootArea *> rootAreaList;
+    QVector<int> rootAreaStarts; // text-position each root-area in rootAreaList starts at, ascending
+    QHash<KoTextLayoutRootArea *, int> rootAreaIndexes; // maps root-area to its index in rootAreaList
+    QList<KoTextLayoutRootArea *> previousRootAreas; // rootAreaList of the previous layout run, while it can be reused
     FrameIterator *layoutPosition;
 
     QHash<int, KoInlineObjectExtent> inlineObjectExtents; // maps text-position to whole-line-height of an inline object
@@ -128,6 +146,9 @@ public:
 
     QHash<KoInlineObject *, KoTextLayoutRootArea *> rootAreaForInlineObject;
 
+    // the bottom up to which a root-area of bounded height was allowed to grow when layouted
+    QHash<KoTextLayoutRootArea *, qreal> reservedBottoms;
+
     qreal defaultTabSizing;
     qreal y;
     bool isLayouting;
@@ -138,8 +159,111 @@ public:
     bool restartLayout;
     bool wordprocessingMode;
     bool showInlineObjectVisualization;
+    // Fitting the dropped chars to the height of the drop caps shapes them up to five times
+    // and paragraphs are laid out again on every relayout, so the results are remembered.
+    QCache<QString, KoDropCapsFit> dropCapsFits;
+
+    qreal topOfFollowingArea(KoTextLayoutRootArea *rootArea) const;
+
+    void appendRootArea(KoTextLayoutRootArea *rootArea, int startPosition);
+    void truncateRootAreas(int count);
+    void moveRootAreaStarts(int position, int charsRemoved, int charsAdded);
+    int rootAreaIndexForPosition(const QTextDocument *document, int position) const;
 };
 
+void KoTextDocumentLayout::Private::appendRootArea(KoTextLayoutRootArea *rootArea, int startPosition)
+{
+    rootAreaIndexes.insert(rootArea, rootAreaList.count());
+    rootAreaList.append(rootArea);
+    rootAreaStarts.append(startPosition);
+}
+
+void KoTextDocumentLayout::Private::truncateRootAreas(int count)
+{
+    while (rootAreaList.count() > count) {
+        rootAreaIndexes.remove(rootAreaList.takeLast());
+    }
+    rootAreaStarts.resize(rootAreaList.count());
+
+    // The list is rebuilt by every layout run, so root-areas released by the provider
+    // are not necessarily in it anymore. Forget all root-areas that are not.
+    QHash<KoTextLayoutRootArea *, qreal>::iterator it = reservedBottoms.begin();
+    while (it != reservedBottoms.end()) {
+        if (rootAreaIndexes.contains(it.key())) {
+            ++it;
+        } else {
+            it = reservedBottoms.erase(it);
+        }
+    }
+}
+
+void KoTextDocumentLayout::Private::moveRootAreaStarts(int position, int charsRemoved, int charsAdded)
+{
+    // Root-areas starting behind the change keep their content until they are layouted again,
+    // so their start moves with it. The starts stay ascending.
+    const int delta = charsAdded - charsRemoved;
+    QVector<int>::iterator it = std::upper_bound(rootAreaStarts.begin(), rootAreaStarts.end(), position);
+    for (; it != rootAreaStarts.end(); ++it) {
+        if (*it >= position + charsRemoved) {
+            *it += delta;
+        } else {
+            *it = position;
+        }
+    }
+}
+
+static bool rootAreaContainsLine(const KoTextLayoutRootArea *rootArea, const QTextLine &line)
+{
+    QRectF rect = rootArea->boundingRect(); // should already be normalized()
+    if (rect.width() <= 0.0 && rect.height() <= 0.0) // ignore the rootArea if it has a size of QSizeF(0,0)
+        return false;
+    QPointF pos = line.position();
+    qreal x = pos.x();
+    qreal y = pos.y();
+
+    //0.125 needed since Qt Scribe works with fixed point
+    return x + 0.125 >= rect.x() && x<= rect.right() && y + line.height() + 0.125 >= rect.y() && y <= rect.bottom();
+}
+
+int KoTextDocumentLayout::Private::rootAreaIndexForPosition(const QTextDocument *document, int position) const
+{
+    QTextBlock block = document->findBlock(position);
+    if (!block.isValid())
+        return -1;
+    QTextLine line = block.layout()->lineForTextPosition(position - block.position());
+    if (!line.isValid())
+        return -1;
+
+    // The root-area starting last at or before the position is the one holding it. Its neighbours
+    // are checked too, as a line at the start of a root-area may also be reached from the end of
+    // the previous one, and root-areas continuing a table share the start of the table.
+    const int index = int(std::upper_bound(rootAreaStarts.constBegin(), rootAreaStarts.constEnd(), position) - rootAreaStarts.constBegin()) - 1;
+    for (int i = qMax(0, index - 1); i <= qMin(index + 1, rootAreaList.count() - 1); ++i) {
+        if (rootAreaContainsLine(rootAreaList.at(i), line)) {
+            return i;
+        }
+    }
+
+    // Fall back to asking every root-area, e.g. for text laid out in tables
+    for (int i = 0; i < rootAreaList.count(); ++i) {
+        if (rootAreaContainsLine(rootAreaList.at(i), line)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int textPosition(const FrameIterator *cursor, QTextFrame *rootFrame)
+{
+    if (cursor->it == rootFrame->end())
+        return rootFrame->lastPosition();
+    QTextBlock block = cursor->it.currentBlock();
+    if (block.isValid())
+        return block.position() + qMax(0, cursor->lineTextStart);
+    QTextFrame *frame = cursor->it.currentFrame();
+    return frame ? frame->firstPosition() : rootFrame->lastPosition();
+}
+
 
 // ------------------- KoTextDocumentLayout --------------------
 KoTextDocumentLayout::KoTextDocumentLayout(QTextDocument *doc, KoTextLayoutRootAreaProvider *provider)
@@ -297,6 +421,8 @@ qreal KoTextDocumentLayout::defaultTabSpacing() const
 // this method is called on every char inserted or deleted, on format changes, setting/moving of variables or objects.
 void KoTextDocumentLayout::documentChanged(int position, int charsRemoved, int charsAdded)
 {
+    d->moveRootAreaStarts(position, charsRemoved, charsAdded);
+
     if (d->changesBlocked) {
         return;
     }
@@ -318,13 +444,9 @@ void KoTextDocumentLayout::documentChanged(int position, int charsRemoved, int c
     // Mark the to the position corresponding root-areas as dirty. If there is no root-area for the position then we
     // don't need to mark anything dirty but still need to go on to force a scheduled relayout.
     if (!d->rootAreaList.isEmpty()) {
-        KoTextLayoutRootArea *fromArea;
-        if (position) {
-            fromArea = rootAreaForPosition(position-1);
-        } else {
-            fromArea = d->rootAreaList.at(0);
-        }
-        int startIndex = fromArea ? qMax(0, d->rootAreaList.indexOf(fromArea)) : 0;
+        int startIndex = position ? d->rootAreaIndexForPosition(document(), position - 1) : 0;
+        const bool hasFromArea = startIndex >= 0;
+        startIndex = qMax(0, startIndex);
         int endIndex = startIndex;
         if (charsRemoved != 0 || charsAdded != 0) {
             // If any characters got removed or added make sure to also catch other root-areas that may be
@@ -332,13 +454,9 @@ void KoTextDocumentLayout::documentChanged(int position, int charsRemoved, int c
             // and charsAdded>0 cause they are changing a range of characters. One case where both is zero is if
             // the content of a variable changed (see KoVariable::setValue which calls publicDocumentChanged). In
             // those cases we only need to relayout the root-area dirty where the variable is on.
-            KoTextLayoutRootArea *toArea = fromArea ? rootAreaForPosition(position + qMax(charsRemoved, charsAdded) + 1) : 0;
-            if (toArea) {
-                if (toArea != fromArea) {
-                    endIndex = qMax(startIndex, d->rootAreaList.indexOf(toArea));
-                } else {
-                    endIndex = startIndex;
-                }
+            int toIndex = hasFromArea ? d->rootAreaIndexForPosition(document(), position + qMax(charsRemoved, charsAdded) + 1) : -1;
+            if (toIndex >= 0) {
+                endIndex = qMax(startIndex, toIndex);
             } else {
                 endIndex = d->rootAreaList.count() - 1;
             }
@@ -364,27 +482,13 @@ void KoTextDocumentLayout::documentChanged(int position, int charsRemoved, int c
 
 KoTextLayoutRootArea *KoTextDocumentLayout::rootAreaForPosition(int position) const
 {
-    QTextBlock block = document()->findBlock(position);
-    if (!block.isValid())
-        return 0;
-    QTextLine line = block.layout()->lineForTextPosition(position - block.position());
-    if (!line.isValid())
-        return 0;
+    int index = d->rootAreaIndexForPosition(document(), position);
+    return index >= 0 ? d->rootAreaList.at(index) : 0;
+}
 
-    foreach (KoTextLayoutRootArea *rootArea, d->rootAreaList) {
-        QRectF rect = rootArea->boundingRect(); // should already be normalized()
-        if (rect.width() <= 0.0 && rect.height() <= 0.0) // ignore the rootArea if it has a size of QSizeF(0,0)
-            continue;
-        QPointF pos = line.position();
-        qreal x = pos.x();
-        qreal y = pos.y();
-
-        //0.125 needed since Qt Scribe works with fixed point
-        if (x + 0.125 >= rect.x() && x<= rect.right() && y + line.height() + 0.125 >= rect.y() && y <= rect.bottom()) {
-            return rootArea;
-        }
-    }
-    return 0;
+int KoTextDocumentLayout::indexOfRootArea(KoTextLayoutRootArea *rootArea) const
+{
+    return d->rootAreaIndexes.value(rootArea, -1);
 }
 
 KoTextLayoutRootArea *KoTextDocumentLayout::rootAreaForPoint(const QPointF &point) const
@@ -752,6 +856,15 @@ RootAreaConstraint constraintsForPosition(QTextFrame::iterator it, bool previous
     return constraints;
 }
 
+qreal KoTextDocumentLayout::Private::topOfFollowingArea(KoTextLayoutRootArea *rootArea) const
+{
+    // A root-area of bounded height keeps its whole height reserved, so content growing
+    // or shrinking within it does not move the root-areas following it. Those can then
+    // be kept as they are as soon as their content starts where it did before.
+    const qreal bottom = qMax(rootArea->bottom(), reservedBottoms.value(rootArea, rootArea->bottom()));
+    return bottom + qreal(50); // 50 just to separate pages
+}
+
 bool KoTextDocumentLayout::doLayout()
 {
     delete d->layoutPosition;
@@ -764,9 +877,16 @@ bool KoTextDocumentLayout::doLayout()
     int footNoteAutoCount = 0;
     KoTextLayoutRootArea *rootArea = 0;
 
+    d->previousRootAreas = d->rootAreaList;
     d->rootAreaList.clear();
+    d->rootAreaStarts.clear();
+    d->rootAreaIndexes.clear();
 
+    // Every root-area up to the first one kept after a relayouted one goes through the
+    // provider, also when it is kept as it is, because the provider sets up the page of
+    // the root-area (page number, master page) there.
     int currentAreaNumber = 0;
+    bool relayouted = false;
     do {
         if (d->restartLayout) {
             return false; // Abort layouting to restart from the beginning.
@@ -783,10 +903,12 @@ bool KoTextDocumentLayout::doLayout()
             break;
         }
 
-        d->rootAreaList.append(rootArea);
+        d->appendRootArea(rootArea, textPosition(d->layoutPosition, document()->rootFrame()));
         bool shouldLayout = false;
 
-        if (rootArea->top() != d->y) {
+        // the root-area is placed at the top of the rect suggested for it
+        QRectF rect = d->provider->suggestRect(rootArea);
+        if (rootArea->top() != d->y + rect.top()) {
             shouldLayout = true;
         }
         else if (rootArea->isDirty()) {
@@ -800,10 +922,15 @@ bool KoTextDocumentLayout::doLayout()
         }
 
         if (shouldLayout) {
-            QRectF rect = d->provider->suggestRect(rootArea);
+            relayouted = true;
             d->freeObstructions = d->provider->relevantObstructions(rootArea);
 
             rootArea->setReferenceRect(rect.left(), rect.right(), d->y + rect.top(), d->y + rect.bottom());
+            if (rect.height() < UnboundedRootAreaHeight) {
+                d->reservedBottoms.insert(rootArea, d->y + rect.bottom());
+            } else {
+                d->reservedBottoms.remove(rootArea);
+            }
 
             beginAnchorCollecting(rootArea);
 
@@ -845,10 +972,7 @@ bool KoTextDocumentLayout::doLayout()
             if (finished && !rootArea->footNoteCursorToNext()) {
                 d->provider->releaseAllAfter(rootArea);
                 // We must also delete them from our own list too
-                int newsize = d->rootAreaList.indexOf(rootArea) + 1;
-                while (d->rootAreaList.size() > newsize) {
-                    d->rootAreaList.removeLast();
-                }
+                d->truncateRootAreas(indexOfRootArea(rootArea) + 1);
                 return true; // Finished layouting
             }
 
@@ -866,10 +990,7 @@ bool KoTextDocumentLayout::doLayout()
             if (d->layoutPosition->it == document()->rootFrame()->end() && !rootArea->footNoteCursorToNext()) {
                 d->provider->releaseAllAfter(rootArea);
                 // We must also delete them from our own list too
-                int newsize = d->rootAreaList.indexOf(rootArea) + 1;
-                while (d->rootAreaList.size() > newsize) {
-                    d->rootAreaList.removeLast();
-                }
+                d->truncateRootAreas(indexOfRootArea(rootArea) + 1);
                 return true; // Finished layouting
             }
         }
@@ -877,9 +998,37 @@ bool KoTextDocumentLayout::doLayout()
         transferedContinuedNote = rootArea->continuedNoteToNext();
         footNoteAutoCount += rootArea->footNoteAutoCount();
 
-        d->y = rootArea->bottom() + qreal(50); // (post)Layout method(s) just set this
-                                               // 50 just to separate pages
+        d->y = d->topOfFollowingArea(rootArea); // (post)Layout method(s) just set the bottom
         currentAreaNumber++;
+
+        if (relayouted && !shouldLayout) {
+            // The layout converged: this root-area is kept as it is after a previous one
+            // was relayouted, so the following root-areas get the same content and the same
+            // pages as before. Keep them without asking the provider again, up to the next
+            // one which is dirty or does not start where it did before.
+            while (currentAreaNumber < d->previousRootAreas.count()) {
+                KoTextLayoutRootArea *previousArea = d->previousRootAreas.at(currentAreaNumber);
+                if (previousArea->isDirty() || previousArea->top() != d->y + d->provider->suggestRect(previousArea).top()
+                        || !previousArea->isStartingAt(d->layoutPosition)) {
+                    break;
+                }
+                d->appendRootArea(previousArea, textPosition(d->layoutPosition, document()->rootFrame()));
+                delete d->layoutPosition;
+                d->layoutPosition = new FrameIterator(previousArea->nextStartOfArea());
+                if (d->layoutPosition->it == document()->rootFrame()->end() && !previousArea->footNoteCursorToNext()) {
+                    d->provider->releaseAllAfter(previousArea);
+                    // We must also delete them from our own list too
+                    d->truncateRootAreas(indexOfRootArea(previousArea) + 1);
+                    return true; // Finished layouting
+                }
+                transferedFootNoteCursor = previousArea->footNoteCursorToNext();
+                transferedContinuedNote = previousArea->continuedNoteToNext();
+                footNoteAutoCount += previousArea->footNoteAutoCount();
+
+                d->y = d->topOfFollowingArea(previousArea);
+                currentAreaNumber++;
+            }
+        }
     } while (transferedFootNoteCursor || d->layoutPosition->it != document()->rootFrame()->end());
 
     return true; // Finished layouting
@@ -975,6 +1124,16 @@ KoInlineObjectExtent KoTextDocumentLayout::inlineObjectExtent(const QTextFragmen
     return KoInlineObjectExtent();
 }
 
+const KoDropCapsFit *KoTextDocumentLayout::dropCapsFit(const QString &key) const
+{
+    return d->dropCapsFits.object(key);
+}
+
+void KoTextDocumentLayout::insertDropCapsFit(const QString &key, const KoDropCapsFit &fit)
+{
+    d->dropCapsFits.insert(key, new KoDropCapsFit(fit));
+}
+
 void KoTextDocumentLayout::setContinuationObstruction(KoTextLayoutObstruction *continuationObstruction)
 {
     if (d->continuationObstruction) {
@@ -1000,9 +1159,9 @@ QList<KoTextLayoutRootArea *> KoTextDocumentLayout::rootAreas() const
 
 void KoTextDocumentLayout::removeRootArea(KoTextLayoutRootArea *rootArea)
 {
-    int indexOf = rootArea ? qMax(0, d->rootAreaList.indexOf(rootArea)) : 0;
-    for(int i = d->rootAreaList.count() - 1; i >= indexOf; --i)
-        d->rootAreaList.removeAt(i);
+    // the provider may delete the removed root-areas, so do not reuse any of them
+    d->previousRootAreas.clear();
+    d->truncateRootAreas(rootArea ? qMax(0, indexOfRootArea(rootArea)) : 0);
 }
 
 QList<KoShape*> KoTextDocumentLayout::shapes() const
@@ -51,6 +51,16 @@ public:
     qreal m_descent;
 };
 
+/// The font size and placement found for the drop caps of a paragraph
+class KOTEXTLAYOUT_EXPORT KoDropCapsFit
+{
+public:
+    explicit KoDropCapsFit(qreal pointSize = 0, qreal width = 0, qreal positionAdjust = 0);
+    qreal m_pointSize;
+    qreal m_width;
+    qreal m_positionAdjust;
+};
+
 
 /**
  * Text layouter that allows text to flow in multiple root area and around
@@ -207,6 +217,12 @@ public:
 
     KoInlineObjectExtent inlineObjectExtent(const QTextFragment&);
 
+    /// Return the drop caps fit remembered for \p key or 0 if there is none
+    const KoDropCapsFit *dropCapsFit(const QString &key) const;
+
+    /// Remember \p fit for the drop caps described by \p key, see KoTextLayoutArea
+    void insertDropCapsFit(const QString &key, const KoDropCapsFit &fit);
+
     /**
      * We allow a text document to be distributed onto a sequence of KoTextLayoutRootArea;
      * which brings up the need to figure out which KoTextLayoutRootArea is used for a certain
@@ -216,6 +232,12 @@ public:
      */
     KoTextLayoutRootArea *rootAreaForPosition(int position) const;
 
+    /**
+     * Return the index of \p rootArea in \a rootAreas() or -1 if it is not one of them.
+     * Root-area providers can use this instead of searching their own lists.
+     */
+    int indexOfRootArea(KoTextLayoutRootArea *rootArea) const;
+
 
     KoTextLayoutRootArea *rootAreaForPoint(const QPointF &point) const;
 
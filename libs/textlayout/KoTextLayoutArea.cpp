@@ -63,6 +63,7 @@
 #include <QTextFragment>
 #include <QTextLayout>
 #include <QTextCursor>
+#include <QPaintDevice>
 
 extern int qt_defaultDpiY();
 Q_DECLARE_METATYPE(QTextDocument *)
@@ -811,6 +812,23 @@ static bool compareTab(const QTextOption::Tab &tab1, const QTextOption::Tab &tab
     return tab1.position < tab2.position;
 }
 
+// Everything the fit depends on. QFont::toString() leaves out the spacing and capitalization.
+static QString dropCapsFitKey(const QString &text, const QFont &font, qreal height, int dpi,
+                              const QTextOption &option, qreal availableWidth)
+{
+    const QChar separator(0);
+    return text + separator + font.toString() + separator
+        + QString::number(font.letterSpacingType()) + separator
+        + QString::number(font.letterSpacing()) + separator
+        + QString::number(font.wordSpacing()) + separator
+        + QString::number(font.capitalization()) + separator
+        + QString::number(height) + separator
+        + QString::number(dpi) + separator
+        + QString::number(option.textDirection()) + separator
+        + QString::number(option.flags()) + separator
+        + QString::number(availableWidth);
+}
+
 // layoutBlock() method is structured like this:
 //
 // 1) Setup various helper values
@@ -999,24 +1017,34 @@ bool KoTextLayoutArea::layoutBlock(FrameIterator *cursor)
                 QFont f(dropCapsFormatRange.format.font(), d->documentLayout->paintDevice());
                 QString dropCapsText(block.text().left(dropCapsLength));
                 f.setPointSizeF(dropCapsHeight);
-                for (int i=0; i < 5; ++i) {
-                    QTextLayout tmplayout(dropCapsText, f);
-                    tmplayout.setTextOption(option);
-                    tmplayout.beginLayout();
-                    QTextLine tmpline = tmplayout.createLine();
-                    tmplayout.endLayout();
-                    d->dropCapsWidth = tmpline.naturalTextWidth();
-
-                    QFontMetricsF fm(f, documentLayout()->paintDevice());
-                    QRectF rect = fm.tightBoundingRect(dropCapsText);
-                    const qreal diff = dropCapsHeight - rect.height();
-                    dropCapsPositionAdjust = rect.top() + fm.ascent();
-                    if (qAbs(diff) < 0.5) // good enough
-                        break;
-
-                    const qreal adjustment = diff * (f.pointSizeF() / rect.height());
-                    // warnTextLayout << "adjusting with" << adjustment;
-                    f.setPointSizeF(f.pointSizeF() + adjustment);
+                const QString fitKey = dropCapsFitKey(dropCapsText, f, dropCapsHeight,
+                        d->documentLayout->paintDevice()->logicalDpiY(), option, width());
+                if (const KoDropCapsFit *fit = d->documentLayout->dropCapsFit(fitKey)) {
+                    d->dropCapsWidth = fit->m_width;
+                    dropCapsPositionAdjust = fit->m_positionAdjust;
+                    f.setPointSizeF(fit->m_pointSize);
+                } else {
+                    for (int i=0; i < 5; ++i) {
+                        QTextLayout tmplayout(dropCapsText, f);
+                        tmplayout.setTextOption(option);
+                        tmplayout.beginLayout();
+                        QTextLine tmpline = tmplayout.createLine();
+                        tmplayout.endLayout();
+                        d->dropCapsWidth = tmpline.naturalTextWidth();
+
+                        QFontMetricsF fm(f, documentLayout()->paintDevice());
+                        QRectF rect = fm.tightBoundingRect(dropCapsText);
+                        const qreal diff = dropCapsHeight - rect.height();
+                        dropCapsPositionAdjust = rect.top() + fm.ascent();
+                        if (qAbs(diff) < 0.5) // good enough
+                            break;
+
+                        const qreal adjustment = diff * (f.pointSizeF() / rect.height());
+                        // warnTextLayout << "adjusting with" << adjustment;
+                        f.setPointSizeF(f.pointSizeF() + adjustment);
+                    }
+                    d->documentLayout->insertDropCapsFit(fitKey,
+                            KoDropCapsFit(f.pointSizeF(), d->dropCapsWidth, dropCapsPositionAdjust));
                 }
 
                 dropCapsFormatRange.format.setFontPointSize(f.pointSizeF());
@@ -25,6 +25,7 @@
 
 MockRootAreaProvider::MockRootAreaProvider()
     : maxPosition(0)
+    , m_layoutCount(0)
     , m_suggestedRect(QRectF(100, 100, 200, 1000))
     , m_askedForMoreThenOneArea(false)
 {
@@ -37,6 +38,7 @@ KoTextLayoutRootArea *MockRootAreaProvider::provide(KoTextDocumentLayout *docume
         return 0; // guard against loop
     }
     m_askedForMoreThenOneArea |= (m_areas.count() > 1);
+    m_constraints.insert(requestedPosition, constraint);
     *isNewRootArea = !m_areas.contains(requestedPosition);
     if (!m_areas.contains(requestedPosition)) {
         m_areas.insert(requestedPosition, new KoTextLayoutRootArea(documentLayout));
@@ -49,6 +51,7 @@ void MockRootAreaProvider::doPostLayout(KoTextLayoutRootArea *rootArea, bool isN
 {
     Q_UNUSED(rootArea);
     Q_UNUSED(isNewRootArea);
+    ++m_layoutCount;
 }
 
 void MockRootAreaProvider::updateAll()
@@ -44,6 +44,8 @@ public:
 
     int maxPosition;
     QMap<int, KoTextLayoutRootArea*> m_areas;
+    QMap<int, RootAreaConstraint> m_constraints; // the last constraints asked for, by position
+    int m_layoutCount; // number of root-areas laid out, counted in doPostLayout
     QRectF m_suggestedRect;
     bool m_askedForMoreThenOneArea;
 };
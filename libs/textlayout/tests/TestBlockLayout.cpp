@@ -1270,4 +1270,38 @@ void TestBlockLayout::testDropCapsWithNewline()
     QCOMPARE(line.height(), heightNormalLine);
 }
 
+void TestBlockLayout::testDropCapsLetterSpacing()
+{
+    // The drop caps fit is cached; a change that only affects the letter
+    // spacing of the dropped chars must still widen them.
+    setupTest(m_loremIpsum);
+
+    KoParagraphStyle style;
+    style.setFontPointSize(12.0);
+    style.setDropCaps(true);
+    style.setDropCapsLength(2);
+    style.setDropCapsLines(4);
+    style.setDropCapsDistance(9.0);
+    QTextBlock block = m_doc->begin();
+    style.applyStyle(block);
+    m_layout->layout();
+
+    QTextLayout *blockLayout = block.layout();
+    QVERIFY(blockLayout->lineCount() > 4);
+    QCOMPARE(blockLayout->lineAt(0).textLength(), 2);
+    const qreal indent = blockLayout->lineAt(1).x();
+
+    QTextCursor cursor(m_doc);
+    cursor.setPosition(0);
+    cursor.setPosition(2, QTextCursor::KeepAnchor);
+    QTextCharFormat charFormat;
+    charFormat.setFontLetterSpacing(200.0);
+    cursor.mergeCharFormat(charFormat);
+    m_layout->layout();
+
+    blockLayout = block.layout();
+    QCOMPARE(blockLayout->lineAt(0).textLength(), 2);
+    QVERIFY(blockLayout->lineAt(1).x() > indent);
+}
+
 QTEST_MAIN(TestBlockLayout)
@@ -87,6 +87,7 @@ private Q_SLOTS:
     void testDropCapsLongText();
     void testDropCapsShortText();
     void testDropCapsWithNewline();
+    void testDropCapsLetterSpacing();
 
 private:
     void setupTest(const QString &initText = QString());
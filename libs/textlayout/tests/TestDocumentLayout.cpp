@@ -26,6 +26,7 @@
 
 #include <KoTextDocument.h>
 #include <KoStyleManager.h>
+#include <KoParagraphStyle.h>
 #include <KoTextBlockData.h>
 #include <KoTextBlockBorderData.h>
 #include <KoInlineTextObjectManager.h>
@@ -191,4 +192,173 @@ void TestDocumentLayout::testRootAreaZeroWidthAndHeight()
     QCOMPARE(provider->area()->referenceRect(), QRectF(10.,10.,0.,0.));
 }
 
+void TestDocumentLayout::testBoundedRootAreasKeepTheirPlace()
+{
+    QString text;
+    for (int i = 0; i < 40; ++i) {
+        text += QString("paragraph %1\n").arg(i);
+    }
+    setupTest(text);
+
+    // every paragraph asks for its own page number, if it starts a page
+    for (QTextBlock block = m_doc->begin(); block.isValid(); block = block.next()) {
+        QTextBlockFormat format;
+        format.setProperty(KoParagraphStyle::PageNumber, 100 + block.blockNumber());
+        QTextCursor(block).mergeBlockFormat(format);
+    }
+
+    MockRootAreaProvider *provider = dynamic_cast<MockRootAreaProvider*>(m_layout->provider());
+    provider->setSuggestedRect(QRectF(10., 10., 200., 100.));
+
+    m_layout->layout();
+
+    QVERIFY(provider->m_areas.count() > 2);
+    QList<KoTextLayoutRootArea *> areas = m_layout->rootAreas();
+    QCOMPARE(areas.count(), provider->m_areas.count());
+    for (int i = 0; i < areas.count(); ++i) {
+        // each root-area reserves its suggested height plus 50 to separate pages
+        QCOMPARE(areas[i]->top(), qreal(10. + i * 160.));
+        QVERIFY(!areas[i]->isDirty());
+    }
+    comparePageNumbers(provider);
+
+    // Remove a paragraph from the first root-area. The following root-areas
+    // start at other positions now but must not move.
+    QTextCursor cursor(m_doc);
+    cursor.movePosition(QTextCursor::NextBlock, QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    provider->m_constraints.clear();
+    m_layout->layout();
+
+    areas = m_layout->rootAreas();
+    QVERIFY(areas.count() > 2);
+    for (int i = 0; i < areas.count(); ++i) {
+        QCOMPARE(areas[i]->top(), qreal(10. + i * 160.));
+        QVERIFY(!areas[i]->isDirty());
+    }
+    // the provider is asked for the root-areas kept as they are too, so it can
+    // give their pages the page number of the paragraph starting them now
+    QCOMPARE(provider->m_constraints.count(), areas.count());
+    comparePageNumbers(provider);
+}
+
+void TestDocumentLayout::testRelayoutStopsAfterEditedRootArea()
+{
+    QString text;
+    for (int i = 0; i < 60; ++i) {
+        text += QString("paragraph %1\n").arg(i);
+    }
+    setupTest(text);
+
+    MockRootAreaProvider *provider = dynamic_cast<MockRootAreaProvider*>(m_layout->provider());
+    provider->setSuggestedRect(QRectF(10., 0., 200., 100.));
+
+    m_layout->layout();
+
+    const QList<KoTextLayoutRootArea *> areas = m_layout->rootAreas();
+    QVERIFY(areas.count() >= 7);
+    QCOMPARE(provider->m_layoutCount, areas.count());
+
+    // Change a character of a paragraph in the middle of the third root-area
+    const int edited = 2;
+    QTextBlock block;
+    for (block = m_doc->begin(); block.isValid(); block = block.next()) {
+        if (m_layout->rootAreaForPosition(block.position()) == areas[edited]
+                && m_layout->rootAreaForPosition(block.previous().position()) == areas[edited]) {
+            break;
+        }
+    }
+    QVERIFY(block.isValid());
+    QTextCursor cursor(block);
+    cursor.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor);
+    cursor.insertText("q");
+    QVERIFY(areas[edited]->isDirty());
+    QVERIFY(!areas[edited + 2]->isDirty());
+
+    provider->m_constraints.clear();
+    provider->m_layoutCount = 0;
+    m_layout->layout();
+
+    // The edited root-area and the ones before and after it, which the edit marked
+    // dirty, are relayouted. The provider is asked for all root-areas up to the
+    // first one kept as it is after them, the others are kept without asking it.
+    QCOMPARE(provider->m_layoutCount, 3);
+    QCOMPARE(provider->m_constraints.count(), edited + 3);
+    QCOMPARE(m_layout->rootAreas(), areas);
+    for (int i = 0; i < areas.count(); ++i) {
+        QCOMPARE(areas[i]->top(), qreal(i * 150.));
+        QVERIFY(!areas[i]->isDirty());
+    }
+    QCOMPARE(m_layout->rootAreaForPosition(block.position()), areas[edited]);
+}
+
+void TestDocumentLayout::comparePageNumbers(MockRootAreaProvider *provider)
+{
+    QList<KoTextLayoutRootArea *> areas = m_layout->rootAreas();
+    int index = -1;
+    for (QTextBlock block = m_doc->begin(); block.isValid(); block = block.next()) {
+        const int areaIndex = areas.indexOf(m_layout->rootAreaForPosition(block.position()));
+        if (areaIndex > index) {
+            // the paragraph starts the root-area
+            index = areaIndex;
+            QVERIFY(provider->m_constraints.contains(index));
+            QCOMPARE(provider->m_constraints.value(index).visiblePageNumber,
+                     block.blockFormat().intProperty(KoParagraphStyle::PageNumber));
+        }
+    }
+    QCOMPARE(index, areas.count() - 1);
+}
+
+static KoTextLayoutRootArea *findRootArea(KoTextDocumentLayout *layout, int position)
+{
+    QTextBlock block = layout->document()->findBlock(position);
+    QTextLine line = block.layout()->lineForTextPosition(position - block.position());
+    if (!line.isValid())
+        return 0;
+    foreach (KoTextLayoutRootArea *rootArea, layout->rootAreas()) {
+        QRectF rect = rootArea->boundingRect();
+        if (line.position().y() + line.height() + 0.125 >= rect.y() && line.position().y() <= rect.bottom())
+            return rootArea;
+    }
+    return 0;
+}
+
+void TestDocumentLayout::testRootAreaForPosition()
+{
+    QString text;
+    for (int i = 0; i < 60; ++i) {
+        text += QString("paragraph %1\n").arg(i);
+    }
+    setupTest(text);
+
+    MockRootAreaProvider *provider = dynamic_cast<MockRootAreaProvider*>(m_layout->provider());
+    provider->setSuggestedRect(QRectF(10., 10., 200., 100.));
+
+    m_layout->layout();
+
+    QList<KoTextLayoutRootArea *> areas = m_layout->rootAreas();
+    QVERIFY(areas.count() > 2);
+    for (int i = 0; i < areas.count(); ++i) {
+        QCOMPARE(m_layout->indexOfRootArea(areas[i]), i);
+    }
+    QCOMPARE(m_layout->indexOfRootArea(0), -1);
+
+    for (QTextBlock block = m_doc->begin(); block.isValid(); block = block.next()) {
+        QCOMPARE(m_layout->rootAreaForPosition(block.position()), findRootArea(m_layout, block.position()));
+    }
+
+    // positions behind an edit are still found before the next layout
+    QTextCursor cursor(m_doc);
+    cursor.movePosition(QTextCursor::NextBlock);
+    cursor.insertText("inserted ");
+    for (QTextBlock block = m_doc->begin().next().next(); block.isValid(); block = block.next()) {
+        QCOMPARE(m_layout->rootAreaForPosition(block.position()), findRootArea(m_layout, block.position()));
+    }
+
+    m_layout->layout();
+    for (QTextBlock block = m_doc->begin(); block.isValid(); block = block.next()) {
+        QCOMPARE(m_layout->rootAreaForPosition(block.position()), findRootArea(m_layout, block.position()));
+    }
+}
+
 QTEST_MAIN(TestDocumentLayout)
@@ -27,6 +27,7 @@
 class QTextDocument;
 class KoTextDocumentLayout;
 class KoStyleManager;
+class MockRootAreaProvider;
 
 class TestDocumentLayout : public QObject
 {
@@ -57,8 +58,26 @@ private Q_SLOTS:
      */
     void testRootAreaZeroWidthAndHeight();
 
+    /**
+     * Test that root-areas of bounded height stay in place when the content before them changes.
+     */
+    void testBoundedRootAreasKeepTheirPlace();
+
+    /**
+     * Test that an edit inside one root-area only relayouts that root-area and the
+     * ones next to it, and that the layout stops once it converged.
+     */
+    void testRelayoutStopsAfterEditedRootArea();
+
+    /**
+     * Test that root-areas are found by text-position, also after editing.
+     */
+    void testRootAreaForPosition();
+
 private:
     void setupTest(const QString &initText = QString());
+    /// compare the page number each root-area was provided for with the one of the paragraph starting it
+    void comparePageNumbers(MockRootAreaProvider *provider);
 
 private:
     QTextDocument *m_doc;
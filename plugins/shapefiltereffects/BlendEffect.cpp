@@ -19,6 +19,7 @@
 
 #include "BlendEffect.h"
 #include "ColorChannelConversion.h"
+#include "FilterEffectRows.h"
 #include <KoFilterEffectRenderContext.h>
 #include <KoXmlWriter.h>
 #include <KoXmlReader.h>
@@ -65,62 +66,63 @@ QImage BlendEffect::processImages(const QVector<QImage> &images, const KoFilterE
     QRgb *dst = (QRgb*)result.bits();
     int w = result.width();
 
-    qreal sa, sr, sg, sb;
-    qreal da, dr, dg, db;
-    int pixel = 0;
-
     QRect roi = context.filterRegion().toRect();
-    for (int row = roi.top(); row < roi.bottom(); ++row) {
-        for (int col = roi.left(); col < roi.right(); ++col) {
-            pixel = row * w + col;
-            const QRgb &s = src[pixel];
-            QRgb &d = dst[pixel];
-
-            sa = fromIntColor[qAlpha(s)];
-            sr = fromIntColor[qRed(s)];
-            sg = fromIntColor[qGreen(s)];
-            sb = fromIntColor[qBlue(s)];
-
-            da = fromIntColor[qAlpha(d)];
-            dr = fromIntColor[qRed(d)];
-            dg = fromIntColor[qGreen(d)];
-            db = fromIntColor[qBlue(d)];
-
-            switch (m_blendMode) {
-            case Normal:
-                dr = (qreal(1.0) - da) * sr + dr;
-                dg = (qreal(1.0) - da) * sg + dg;
-                db = (qreal(1.0) - da) * sb + db;
-                break;
-            case Multiply:
-                dr = (qreal(1.0) - da) * sr + (qreal(1.0) - sa) * dr + dr * sr;
-                dg = (qreal(1.0) - da) * sg + (qreal(1.0) - sa) * dg + dg * sg;
-                db = (qreal(1.0) - da) * sb + (qreal(1.0) - sa) * db + db * sb;
-                break;
-            case Screen:
-                dr = sr + dr - dr * sr;
-                dg = sg + dg - dg * sg;
-                db = sb + db - db * sb;
-                break;
-            case Darken:
-                dr = qMin((qreal(1.0) - da) * sr + dr, (qreal(1.0) - sa) * dr + sr);
-                dg = qMin((qreal(1.0) - da) * sg + dg, (qreal(1.0) - sa) * dg + sg);
-                db = qMin((qreal(1.0) - da) * sb + db, (qreal(1.0) - sa) * db + sb);
-                break;
-            case Lighten:
-                dr = qMax((qreal(1.0) - da) * sr + dr, (qreal(1.0) - sa) * dr + sr);
-                dg = qMax((qreal(1.0) - da) * sg + dg, (qreal(1.0) - sa) * dg + sg);
-                db = qMax((qreal(1.0) - da) * sb + db, (qreal(1.0) - sa) * db + sb);
-                break;
+    FilterEffectRows::process(roi.top(), roi.bottom(), roi.width(), [&](int firstRow, int lastRow) {
+        qreal sa, sr, sg, sb;
+        qreal da, dr, dg, db;
+        int pixel = 0;
+        for (int row = firstRow; row < lastRow; ++row) {
+            for (int col = roi.left(); col < roi.right(); ++col) {
+                pixel = row * w + col;
+                const QRgb &s = src[pixel];
+                QRgb &d = dst[pixel];
+
+                sa = fromIntColor[qAlpha(s)];
+                sr = fromIntColor[qRed(s)];
+                sg = fromIntColor[qGreen(s)];
+                sb = fromIntColor[qBlue(s)];
+
+                da = fromIntColor[qAlpha(d)];
+                dr = fromIntColor[qRed(d)];
+                dg = fromIntColor[qGreen(d)];
+                db = fromIntColor[qBlue(d)];
+
+                switch (m_blendMode) {
+                case Normal:
+                    dr = (qreal(1.0) - da) * sr + dr;
+                    dg = (qreal(1.0) - da) * sg + dg;
+                    db = (qreal(1.0) - da) * sb + db;
+                    break;
+                case Multiply:
+                    dr = (qreal(1.0) - da) * sr + (qreal(1.0) - sa) * dr + dr * sr;
+                    dg = (qreal(1.0) - da) * sg + (qreal(1.0) - sa) * dg + dg * sg;
+                    db = (qreal(1.0) - da) * sb + (qreal(1.0) - sa) * db + db * sb;
+                    break;
+                case Screen:
+                    dr = sr + dr - dr * sr;
+                    dg = sg + dg - dg * sg;
+                    db = sb + db - db * sb;
+                    break;
+                case Darken:
+                    dr = qMin((qreal(1.0) - da) * sr + dr, (qreal(1.0) - sa) * dr + sr);
+                    dg = qMin((qreal(1.0) - da) * sg + dg, (qreal(1.0) - sa) * dg + sg);
+                    db = qMin((qreal(1.0) - da) * sb + db, (qreal(1.0) - sa) * db + sb);
+                    break;
+                case Lighten:
+                    dr = qMax((qreal(1.0) - da) * sr + dr, (qreal(1.0) - sa) * dr + sr);
+                    dg = qMax((qreal(1.0) - da) * sg + dg, (qreal(1.0) - sa) * dg + sg);
+                    db = qMax((qreal(1.0) - da) * sb + db, (qreal(1.0) - sa) * db + sb);
+                    break;
+                }
+                da = qreal(1.0) - (qreal(1.0) - da) * (qreal(1.0) - sa);
+
+                d = qRgba(static_cast<quint8>(qBound(qreal(0.0), dr * qreal(255.0), qreal(255.0))),
+                          static_cast<quint8>(qBound(qreal(0.0), dg * qreal(255.0), qreal(255.0))),
+                          static_cast<quint8>(qBound(qreal(0.0), db * qreal(255.0), qreal(255.0))),
+                          static_cast<quint8>(qBound(qreal(0.0), da * qreal(255.0), qreal(255.0))));
             }
-            da = qreal(1.0) - (qreal(1.0) - da) * (qreal(1.0) - sa);
-
-            d = qRgba(static_cast<quint8>(qBound(qreal(0.0), dr * qreal(255.0), qreal(255.0))),
-                      static_cast<quint8>(qBound(qreal(0.0), dg * qreal(255.0), qreal(255.0))),
-                      static_cast<quint8>(qBound(qreal(0.0), db * qreal(255.0), qreal(255.0))),
-                      static_cast<quint8>(qBound(qreal(0.0), da * qreal(255.0), qreal(255.0))));
         }
-    }
+    });
 
     return result;
 }
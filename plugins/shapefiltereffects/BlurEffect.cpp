@@ -24,252 +24,149 @@
 #include "KoXmlWriter.h"
 #include "KoXmlReader.h"
 #include <klocalizedstring.h>
+#include "FilterEffectRows.h"
 #include <QColor>
 #include <QImage>
+#include <QVector>
 
-// Stack Blur Algorithm by Mario Klingemann <mario@quasimondo.com>
-// fixed to handle alpha channel correctly by Zack Rusin
-void fastbluralpha(QImage &img, int radius)
+namespace
 {
-    if (radius < 1) {
-        return;
-    }
-
-    QRgb *pix = (QRgb*)img.bits();
-    int w   = img.width();
-    int h   = img.height();
-    int wm  = w - 1;
-    int hm  = h - 1;
-    int wh  = w * h;
-    int div = radius + radius + 1;
-
-    int *r = new int[wh];
-    int *g = new int[wh];
-    int *b = new int[wh];
-    int *a = new int[wh];
-    int rsum, gsum, bsum, asum, x, y, i, yp, yi, yw;
-    QRgb p;
-    int *vmin = new int[qMax(w, h)];
-
-    int divsum = (div + 1) >> 1;
-    divsum *= divsum;
-    int *dv = new int[256*divsum];
-    for (i = 0; i < 256*divsum; ++i) {
-        dv[i] = (i / divsum);
-    }
-
-    yw = yi = 0;
-
-    int **stack = new int*[div];
-    for (int i = 0; i < div; ++i) {
-        stack[i] = new int[4];
-    }
 
+/// Divides the weighted channel sums of a stack blur by the kernel weight
+inline int blurredChannel(int sum, double scale)
+{
+    // adding one half keeps the truncation exact, the gap to the next
+    // integer quotient is much larger than the rounding error of scale
+    return static_cast<int>((sum + 0.5) * scale);
+}
 
-    int stackpointer;
-    int stackstart;
-    int *sir;
-    int rbs;
-    int r1 = radius + 1;
-    int routsum, goutsum, boutsum, aoutsum;
-    int rinsum, ginsum, binsum, ainsum;
-
-    for (y = 0; y < h; ++y) {
-        rinsum = ginsum = binsum = ainsum
-                                   = routsum = goutsum = boutsum = aoutsum
-                                                                   = rsum = gsum = bsum = asum = 0;
-        for (i = - radius; i <= radius; ++i) {
-            p = pix[yi+qMin(wm, qMax(i, 0))];
-            sir = stack[i+radius];
-            sir[0] = qRed(p);
-            sir[1] = qGreen(p);
-            sir[2] = qBlue(p);
-            sir[3] = qAlpha(p);
-
-            rbs = r1 - abs(i);
-            rsum += sir[0] * rbs;
-            gsum += sir[1] * rbs;
-            bsum += sir[2] * rbs;
-            asum += sir[3] * rbs;
-
-            if (i > 0) {
-                rinsum += sir[0];
-                ginsum += sir[1];
-                binsum += sir[2];
-                ainsum += sir[3];
-            } else {
-                routsum += sir[0];
-                goutsum += sir[1];
-                boutsum += sir[2];
-                aoutsum += sir[3];
+/// Blurs the rows [firstRow, lastRow) of pix horizontally into the interleaved channels of sums
+void blurRows(const QRgb *pix, int w, int radius, double scale, int *sums, int firstRow, int lastRow)
+{
+    const int wm = w - 1;
+    const int r1 = radius + 1;
+
+    for (int y = firstRow; y < lastRow; ++y) {
+        const QRgb *line = pix + y * w;
+        int *out = sums + 4 * y * w;
+        int sum[4] = { 0, 0, 0, 0 };
+        int insum[4] = { 0, 0, 0, 0 };
+        int outsum[4] = { 0, 0, 0, 0 };
+
+        for (int i = -radius; i <= radius; ++i) {
+            const QRgb p = line[qMin(wm, qMax(i, 0))];
+            const int rbs = r1 - qAbs(i);
+            for (int c = 0; c < 4; ++c) {
+                const int v = (p >> (8 * c)) & 0xff;
+                sum[c] += v * rbs;
+                if (i > 0) {
+                    insum[c] += v;
+                } else {
+                    outsum[c] += v;
+                }
             }
         }
-        stackpointer = radius;
 
-        for (x = 0; x < w; ++x) {
-
-            r[yi] = dv[rsum];
-            g[yi] = dv[gsum];
-            b[yi] = dv[bsum];
-            a[yi] = dv[asum];
-
-            rsum -= routsum;
-            gsum -= goutsum;
-            bsum -= boutsum;
-            asum -= aoutsum;
-
-            stackstart = stackpointer - radius + div;
-            sir = stack[stackstart%div];
-
-            routsum -= sir[0];
-            goutsum -= sir[1];
-            boutsum -= sir[2];
-            aoutsum -= sir[3];
-
-            if (y == 0) {
-                vmin[x] = qMin(x + radius + 1, wm);
+        for (int x = 0; x < w; ++x) {
+            const QRgb leaving = line[qMax(x - radius, 0)];
+            const QRgb entering = line[qMin(x + r1, wm)];
+            const QRgb center = line[qMin(x + 1, wm)];
+            for (int c = 0; c < 4; ++c) {
+                out[4 * x + c] = blurredChannel(sum[c], scale);
+                sum[c] -= outsum[c];
+                outsum[c] -= (leaving >> (8 * c)) & 0xff;
+                insum[c] += (entering >> (8 * c)) & 0xff;
+                sum[c] += insum[c];
+                const int v = (center >> (8 * c)) & 0xff;
+                outsum[c] += v;
+                insum[c] -= v;
             }
-            p = pix[yw+vmin[x]];
-
-            sir[0] = qRed(p);
-            sir[1] = qGreen(p);
-            sir[2] = qBlue(p);
-            sir[3] = qAlpha(p);
-
-            rinsum += sir[0];
-            ginsum += sir[1];
-            binsum += sir[2];
-            ainsum += sir[3];
-
-            rsum += rinsum;
-            gsum += ginsum;
-            bsum += binsum;
-            asum += ainsum;
-
-            stackpointer = (stackpointer + 1) % div;
-            sir = stack[(stackpointer)%div];
-
-            routsum += sir[0];
-            goutsum += sir[1];
-            boutsum += sir[2];
-            aoutsum += sir[3];
-
-            rinsum -= sir[0];
-            ginsum -= sir[1];
-            binsum -= sir[2];
-            ainsum -= sir[3];
-
-            ++yi;
         }
-        yw += w;
     }
-    for (x = 0; x < w; ++x) {
-        rinsum = ginsum = binsum = ainsum
-                                   = routsum = goutsum = boutsum = aoutsum
-                                                                   = rsum = gsum = bsum = asum = 0;
-
-        yp = - radius * w;
-
-        for (i = -radius; i <= radius; ++i) {
-            yi = qMax(0, yp) + x;
-
-            sir = stack[i+radius];
-
-            sir[0] = r[yi];
-            sir[1] = g[yi];
-            sir[2] = b[yi];
-            sir[3] = a[yi];
-
-            rbs = r1 - abs(i);
-
-            rsum += r[yi] * rbs;
-            gsum += g[yi] * rbs;
-            bsum += b[yi] * rbs;
-            asum += a[yi] * rbs;
-
-            if (i > 0) {
-                rinsum += sir[0];
-                ginsum += sir[1];
-                binsum += sir[2];
-                ainsum += sir[3];
-            } else {
-                routsum += sir[0];
-                goutsum += sir[1];
-                boutsum += sir[2];
-                aoutsum += sir[3];
-            }
+}
 
-            if (i < hm) {
-                yp += w;
-            }
+/**
+ * Blurs the columns [firstColumn, lastColumn) of sums vertically back into pix.
+ *
+ * The columns advance in lockstep, so the running sums are kept per column
+ * and updated a whole row at a time, which the compiler can vectorize.
+ */
+void blurColumns(const int *sums, int w, int h, int radius, double scale, QRgb *pix, int firstColumn, int lastColumn)
+{
+    const int hm = h - 1;
+    const int r1 = radius + 1;
+    const int n = 4 * (lastColumn - firstColumn);
+
+    QVector<int> sumBuffer(n), insumBuffer(n), outsumBuffer(n);
+    int *sum = sumBuffer.data();
+    int *insum = insumBuffer.data();
+    int *outsum = outsumBuffer.data();
+
+    for (int i = -radius; i <= radius; ++i) {
+        const int *line = sums + 4 * (qMin(hm, qMax(i, 0)) * w + firstColumn);
+        const int rbs = r1 - qAbs(i);
+        for (int k = 0; k < n; ++k) {
+            sum[k] += line[k] * rbs;
         }
+        int *side = i > 0 ? insum : outsum;
+        for (int k = 0; k < n; ++k) {
+            side[k] += line[k];
+        }
+    }
 
-        yi = x;
-        stackpointer = radius;
-
-        for (y = 0; y < h; ++y) {
-            pix[yi] = qRgba(dv[rsum], dv[gsum], dv[bsum], dv[asum]);
-
-            rsum -= routsum;
-            gsum -= goutsum;
-            bsum -= boutsum;
-            asum -= aoutsum;
-
-            stackstart = stackpointer - radius + div;
-            sir = stack[stackstart%div];
-
-            routsum -= sir[0];
-            goutsum -= sir[1];
-            boutsum -= sir[2];
-            aoutsum -= sir[3];
-
-            if (x == 0) {
-                vmin[y] = qMin(y + r1, hm) * w;
-            }
-            p = x + vmin[y];
+    for (int y = 0; y < h; ++y) {
+        QRgb *out = pix + y * w + firstColumn;
+        for (int x = 0; x < n / 4; ++x) {
+            const int *s = sum + 4 * x;
+            out[x] = qRgba(blurredChannel(s[2], scale), blurredChannel(s[1], scale),
+                           blurredChannel(s[0], scale), blurredChannel(s[3], scale));
+        }
 
-            sir[0] = r[p];
-            sir[1] = g[p];
-            sir[2] = b[p];
-            sir[3] = a[p];
+        const int *leaving = sums + 4 * (qMax(y - radius, 0) * w + firstColumn);
+        const int *entering = sums + 4 * (qMin(y + r1, hm) * w + firstColumn);
+        const int *center = sums + 4 * (qMin(y + 1, hm) * w + firstColumn);
+        for (int k = 0; k < n; ++k) {
+            sum[k] -= outsum[k];
+            insum[k] += entering[k];
+            sum[k] += insum[k];
+            insum[k] -= center[k];
+            outsum[k] += center[k] - leaving[k];
+        }
+    }
+}
 
-            rinsum += sir[0];
-            ginsum += sir[1];
-            binsum += sir[2];
-            ainsum += sir[3];
+}
 
-            rsum += rinsum;
-            gsum += ginsum;
-            bsum += binsum;
-            asum += ainsum;
+// Stack Blur Algorithm by Mario Klingemann <mario@quasimondo.com>
+// fixed to handle alpha channel correctly by Zack Rusin
+// The stack itself is not needed as both passes read from an unmodified
+// source, so the values leaving the window are read from there instead.
+void fastbluralpha(QImage &img, int radius)
+{
+    if (radius < 1) {
+        return;
+    }
 
-            stackpointer = (stackpointer + 1) % div;
-            sir = stack[stackpointer];
+    QRgb *pix = (QRgb*)img.bits();
+    const int w = img.width();
+    const int h = img.height();
+    if (w < 1 || h < 1) {
+        return;
+    }
 
-            routsum += sir[0];
-            goutsum += sir[1];
-            boutsum += sir[2];
-            aoutsum += sir[3];
+    int divsum = (radius + 1);
+    divsum *= divsum;
+    const double scale = 1.0 / divsum;
 
-            rinsum -= sir[0];
-            ginsum -= sir[1];
-            binsum -= sir[2];
-            ainsum -= sir[3];
+    QVector<int> sums(4 * w * h);
+    int *s = sums.data();
 
-            yi += w;
-        }
-    }
-    delete [] r;
-    delete [] g;
-    delete [] b;
-    delete [] a;
-    delete [] vmin;
-    delete [] dv;
-
-    for (int i = 0; i < div; ++i) {
-        delete [] stack[i];
-    }
-    delete [] stack;
+    FilterEffectRows::process(0, h, w, [=](int first, int last) {
+        blurRows(pix, w, radius, scale, s, first, last);
+    });
+    FilterEffectRows::process(0, w, h, [=](int first, int last) {
+        blurColumns(s, w, h, radius, scale, pix, first, last);
+    });
 }
 
 BlurEffect::BlurEffect()
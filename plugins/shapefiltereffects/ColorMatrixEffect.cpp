@@ -19,6 +19,7 @@
 
 #include "ColorMatrixEffect.h"
 #include "ColorChannelConversion.h"
+#include "FilterEffectRows.h"
 #include <KoFilterEffectRenderContext.h>
 #include <KoXmlWriter.h>
 #include <KoXmlReader.h>
@@ -162,41 +163,43 @@ QImage ColorMatrixEffect::processImage(const QImage &image, const KoFilterEffect
     int w = result.width();
 
     const qreal * m = m_matrix.data();
-    qreal sa, sr, sg, sb;
-    qreal da, dr, dg, db;
 
     QRect roi = context.filterRegion().toRect();
-    for (int row = roi.top(); row < roi.bottom(); ++row) {
-        for (int col = roi.left(); col < roi.right(); ++col) {
-            const QRgb &s = src[row*w+col];
-            sa = fromIntColor[qAlpha(s)];
-            sr = fromIntColor[qRed(s)];
-            sg = fromIntColor[qGreen(s)];
-            sb = fromIntColor[qBlue(s)];
-            // the matrix is applied to non-premultiplied color values
-            // so we have to convert colors by dividing by alpha value
-            if (sa > 0.0 && sa < 1.0) {
-                sr /= sa;
-                sb /= sa;
-                sg /= sa;
+    FilterEffectRows::process(roi.top(), roi.bottom(), roi.width(), [&](int firstRow, int lastRow) {
+        qreal sa, sr, sg, sb;
+        qreal da, dr, dg, db;
+        for (int row = firstRow; row < lastRow; ++row) {
+            for (int col = roi.left(); col < roi.right(); ++col) {
+                const QRgb &s = src[row*w+col];
+                sa = fromIntColor[qAlpha(s)];
+                sr = fromIntColor[qRed(s)];
+                sg = fromIntColor[qGreen(s)];
+                sb = fromIntColor[qBlue(s)];
+                // the matrix is applied to non-premultiplied color values
+                // so we have to convert colors by dividing by alpha value
+                if (sa > 0.0 && sa < 1.0) {
+                    sr /= sa;
+                    sb /= sa;
+                    sg /= sa;
+                }
+
+                // apply matrix to color values
+                dr = m[ 0] * sr + m[ 1] * sg + m[ 2] * sb + m[ 3] * sa + m[ 4];
+                dg = m[ 5] * sr + m[ 6] * sg + m[ 7] * sb + m[ 8] * sa + m[ 9];
+                db = m[10] * sr + m[11] * sg + m[12] * sb + m[13] * sa + m[14];
+                da = m[15] * sr + m[16] * sg + m[17] * sb + m[18] * sa + m[19];
+
+                // the new alpha value
+                da *= 255.0;
+
+                // set pre-multiplied color values on destination image
+                dst[row*w+col] = qRgba(static_cast<quint8>(qBound(qreal(0.0), dr * da, qreal(255.0))),
+                                       static_cast<quint8>(qBound(qreal(0.0), dg * da, qreal(255.0))),
+                                       static_cast<quint8>(qBound(qreal(0.0), db * da, qreal(255.0))),
+                                       static_cast<quint8>(qBound(qreal(0.0), da, qreal(255.0))));
             }
-
-            // apply matrix to color values
-            dr = m[ 0] * sr + m[ 1] * sg + m[ 2] * sb + m[ 3] * sa + m[ 4];
-            dg = m[ 5] * sr + m[ 6] * sg + m[ 7] * sb + m[ 8] * sa + m[ 9];
-            db = m[10] * sr + m[11] * sg + m[12] * sb + m[13] * sa + m[14];
-            da = m[15] * sr + m[16] * sg + m[17] * sb + m[18] * sa + m[19];
-
-            // the new alpha value
-            da *= 255.0;
-
-            // set pre-multiplied color values on destination image
-            dst[row*w+col] = qRgba(static_cast<quint8>(qBound(qreal(0.0), dr * da, qreal(255.0))),
-                                   static_cast<quint8>(qBound(qreal(0.0), dg * da, qreal(255.0))),
-                                   static_cast<quint8>(qBound(qreal(0.0), db * da, qreal(255.0))),
-                                   static_cast<quint8>(qBound(qreal(0.0), da, qreal(255.0))));
         }
-    }
+    });
 
     return result;
 }
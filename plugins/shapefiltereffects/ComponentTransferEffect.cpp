@@ -19,6 +19,7 @@
 
 #include "ComponentTransferEffect.h"
 #include "ColorChannelConversion.h"
+#include "FilterEffectRows.h"
 #include <KoFilterEffectRenderContext.h>
 #include <KoXmlWriter.h>
 #include <KoXmlReader.h>
@@ -110,48 +111,63 @@ QImage ComponentTransferEffect::processImage(const QImage &image, const KoFilter
     QRgb *dst = (QRgb*)result.bits();
     int w = result.width();
 
-    qreal sa, sr, sg, sb;
-    qreal da, dr, dg, db;
-    int pixel;
-
     const QRect roi = context.filterRegion().toRect();
     const int minRow = roi.top();
     const int maxRow = roi.bottom();
     const int minCol = roi.left();
     const int maxCol = roi.right();
 
-    for (int row = minRow; row <= maxRow; ++row) {
-        for (int col = minCol; col <= maxCol; ++col) {
-            pixel = row * w + col;
-            const QRgb &s = src[pixel];
-
-            sa = fromIntColor[qAlpha(s)];
-            sr = fromIntColor[qRed(s)];
-            sg = fromIntColor[qGreen(s)];
-            sb = fromIntColor[qBlue(s)];
-            // the matrix is applied to non-premultiplied color values
-            // so we have to convert colors by dividing by alpha value
-            if (sa > 0.0 && sa < 1.0) {
-                sr /= sa;
-                sb /= sa;
-                sg /= sa;
-            }
-
-            dr = transferChannel(ChannelR, sr);
-            dg = transferChannel(ChannelG, sg);
-            db = transferChannel(ChannelB, sb);
-            da = transferChannel(ChannelA, sa);
-
-            da *= 255.0;
-
-            // set pre-multiplied color values on destination image
-            dst[pixel] = qRgba(static_cast<quint8>(qBound(qreal(0.0), dr * da, qreal(255.0))),
-                               static_cast<quint8>(qBound(qreal(0.0), dg * da, qreal(255.0))),
-                               static_cast<quint8>(qBound(qreal(0.0), db * da, qreal(255.0))),
-                               static_cast<quint8>(qBound(qreal(0.0), da, qreal(255.0))));
+    // opaque and fully transparent pixels need no un-premultiplication, so
+    // their channels only take 256 distinct values which can be looked up
+    qreal transferTable[4][256];
+    for (int channel = ChannelR; channel <= ChannelA; ++channel) {
+        for (int i = 0; i < 256; ++i) {
+            transferTable[channel][i] = transferChannel(static_cast<Channel>(channel), fromIntColor[i]);
         }
     }
 
+    FilterEffectRows::process(minRow, maxRow + 1, roi.width(), [&](int firstRow, int lastRow) {
+        qreal sa, sr, sg, sb;
+        qreal da, dr, dg, db;
+        int pixel;
+        for (int row = firstRow; row < lastRow; ++row) {
+            for (int col = minCol; col <= maxCol; ++col) {
+                pixel = row * w + col;
+                const QRgb &s = src[pixel];
+
+                const int alpha = qAlpha(s);
+                da = transferTable[ChannelA][alpha];
+                if (alpha == 0 || alpha == 255) {
+                    dr = transferTable[ChannelR][qRed(s)];
+                    dg = transferTable[ChannelG][qGreen(s)];
+                    db = transferTable[ChannelB][qBlue(s)];
+                } else {
+                    sa = fromIntColor[alpha];
+                    sr = fromIntColor[qRed(s)];
+                    sg = fromIntColor[qGreen(s)];
+                    sb = fromIntColor[qBlue(s)];
+                    // the matrix is applied to non-premultiplied color values
+                    // so we have to convert colors by dividing by alpha value
+                    sr /= sa;
+                    sb /= sa;
+                    sg /= sa;
+
+                    dr = transferChannel(ChannelR, sr);
+                    dg = transferChannel(ChannelG, sg);
+                    db = transferChannel(ChannelB, sb);
+                }
+
+                da *= 255.0;
+
+                // set pre-multiplied color values on destination image
+                dst[pixel] = qRgba(static_cast<quint8>(qBound(qreal(0.0), dr * da, qreal(255.0))),
+                                   static_cast<quint8>(qBound(qreal(0.0), dg * da, qreal(255.0))),
+                                   static_cast<quint8>(qBound(qreal(0.0), db * da, qreal(255.0))),
+                                   static_cast<quint8>(qBound(qreal(0.0), da, qreal(255.0))));
+            }
+        }
+    });
+
     return result;
 }
 
@@ -23,6 +23,7 @@
 #include "KoViewConverter.h"
 #include "KoXmlWriter.h"
 #include "KoXmlReader.h"
+#include "FilterEffectRows.h"
 #include <klocalizedstring.h>
 #include <QRect>
 #include <QVector>
@@ -161,8 +162,7 @@ QImage ConvolveMatrixEffect::processImage(const QImage &image, const KoFilterEff
             divisor = 1.0;
     }
 
-    int dstPixel, srcPixel;
-    qreal sumA, sumR, sumG, sumB;
+    const qreal * kernel = m_kernel.constData();
     const QRgb * src = (const QRgb*)image.constBits();
     QRgb * dst = (QRgb*)result.bits();
 
@@ -172,66 +172,70 @@ QImage ConvolveMatrixEffect::processImage(const QImage &image, const KoFilterEff
     const int minY = roi.top();
     const int maxY = roi.bottom();
 
-    int srcRow, srcCol;
-    for (int row = minY; row <= maxY; ++row) {
-        for (int col = minX; col <= maxX; ++col) {
-            dstPixel = row * w + col;
-            sumA = sumR = sumG = sumB = 0;
-            for (int i = 0; i < maskSize; ++i) {
-                srcRow = row + offset[i].y();
-                srcCol = col + offset[i].x();
-                // handle top and bottom edge
-                if (srcRow < 0 || srcRow >= h ) {
-                    switch(m_edgeMode) {
-                        case Duplicate:
-                            srcRow = srcRow >= h ? h-1 : 0;
-                            break;
-                        case Wrap:
-                            srcRow = (srcRow+h)%h;
-                            break;
-                        case None:
-                            // zero for all color channels
-                            continue;
-                            break;
+    FilterEffectRows::process(minY, maxY + 1, roi.width() * maskSize, [&](int firstRow, int lastRow) {
+        int dstPixel, srcPixel;
+        qreal sumA, sumR, sumG, sumB;
+        int srcRow, srcCol;
+        for (int row = firstRow; row < lastRow; ++row) {
+            for (int col = minX; col <= maxX; ++col) {
+                dstPixel = row * w + col;
+                sumA = sumR = sumG = sumB = 0;
+                for (int i = 0; i < maskSize; ++i) {
+                    srcRow = row + offset.at(i).y();
+                    srcCol = col + offset.at(i).x();
+                    // handle top and bottom edge
+                    if (srcRow < 0 || srcRow >= h ) {
+                        switch(m_edgeMode) {
+                            case Duplicate:
+                                srcRow = srcRow >= h ? h-1 : 0;
+                                break;
+                            case Wrap:
+                                srcRow = (srcRow+h)%h;
+                                break;
+                            case None:
+                                // zero for all color channels
+                                continue;
+                                break;
+                        }
                     }
-                }
-                // handle left and right edge
-                if (srcCol < 0 || srcCol >= w) {
-                    switch(m_edgeMode) {
-                        case Duplicate:
-                            srcCol = srcCol >= w ? w-1 : 0;
-                            break;
-                        case Wrap:
-                            srcCol = (srcCol+w)%w;
-                            break;
-                        case None:
-                            // zero for all color channels
-                            continue;
-                            break;
+                    // handle left and right edge
+                    if (srcCol < 0 || srcCol >= w) {
+                        switch(m_edgeMode) {
+                            case Duplicate:
+                                srcCol = srcCol >= w ? w-1 : 0;
+                                break;
+                            case Wrap:
+                                srcCol = (srcCol+w)%w;
+                                break;
+                            case None:
+                                // zero for all color channels
+                                continue;
+                                break;
+                        }
                     }
+                    srcPixel = srcRow * w + srcCol;
+                    const QRgb &s = src[srcPixel];
+                    const qreal &k = kernel[i];
+                    if (!m_preserveAlpha)
+                        sumA += qAlpha(s) * k;
+                    sumR += qRed(s) * k;
+                    sumG += qGreen(s) * k;
+                    sumB += qBlue(s) * k;
+                }
+                if (m_preserveAlpha) {
+                    dst[dstPixel] = qRgba( qBound(0, static_cast<int>(sumR / divisor + m_bias), 255),
+                                           qBound(0, static_cast<int>(sumG / divisor + m_bias), 255),
+                                           qBound(0, static_cast<int>(sumB / divisor + m_bias), 255),
+                                           qAlpha(dst[dstPixel]));
+                } else {
+                    dst[dstPixel] = qRgba( qBound(0, static_cast<int>(sumR / divisor + m_bias), 255),
+                                           qBound(0, static_cast<int>(sumG / divisor + m_bias), 255),
+                                           qBound(0, static_cast<int>(sumB / divisor + m_bias), 255),
+                                           qBound(0, static_cast<int>(sumA / divisor + m_bias), 255));
                 }
-                srcPixel = srcRow * w + srcCol;
-                const QRgb &s = src[srcPixel];
-                const qreal &k = m_kernel[i];
-                if (!m_preserveAlpha)
-                    sumA += qAlpha(s) * k;
-                sumR += qRed(s) * k;
-                sumG += qGreen(s) * k;
-                sumB += qBlue(s) * k;
-            }
-            if (m_preserveAlpha) {
-                dst[dstPixel] = qRgba( qBound(0, static_cast<int>(sumR / divisor + m_bias), 255),
-                                       qBound(0, static_cast<int>(sumG / divisor + m_bias), 255),
-                                       qBound(0, static_cast<int>(sumB / divisor + m_bias), 255),
-                                       qAlpha(dst[dstPixel]));
-            } else {
-                dst[dstPixel] = qRgba( qBound(0, static_cast<int>(sumR / divisor + m_bias), 255),
-                                       qBound(0, static_cast<int>(sumG / divisor + m_bias), 255),
-                                       qBound(0, static_cast<int>(sumB / divisor + m_bias), 255),
-                                       qBound(0, static_cast<int>(sumA / divisor + m_bias), 255));
             }
         }
-    }
+    });
 
     return result;
 }
@@ -0,0 +1,102 @@
+/* This file is part of the KDE project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef FILTEREFFECTROWS_H
+#define FILTEREFFECTROWS_H
+
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+
+namespace FilterEffectRows
+{
+
+/// Images with fewer pixels than this are not worth the thread hand-off
+const int MinimumParallelPixels = 64 * 1024;
+
+template <typename Function>
+class BandJob : public QRunnable
+{
+public:
+    BandJob(const Function &function, int first, int last, QSemaphore &done)
+        : m_function(function), m_first(first), m_last(last), m_done(done)
+    {
+    }
+
+    virtual void run()
+    {
+        m_function(m_first, m_last);
+        m_done.release();
+    }
+
+private:
+    const Function &m_function;
+    const int m_first;
+    const int m_last;
+    QSemaphore &m_done;
+};
+
+/**
+ * Calls function(first, last) for consecutive bands covering the rows
+ * [begin, end), spreading the bands over the global thread pool.
+ *
+ * The calling thread processes a band itself and bands no pool thread is
+ * free for are processed inline, so this never waits on queued work and can
+ * safely be called from a pool thread. Bands must only write their own rows.
+ *
+ * @param rowLength the number of pixels per row, used to keep small images serial
+ */
+template <typename Function>
+void process(int begin, int end, int rowLength, const Function &function)
+{
+    const int rows = end - begin;
+    if (rows <= 0) {
+        return;
+    }
+
+    int bandCount = qMin(QThread::idealThreadCount(), rows);
+    if (qint64(rows) * rowLength < MinimumParallelPixels) {
+        bandCount = 1;
+    }
+    if (bandCount <= 1) {
+        function(begin, end);
+        return;
+    }
+
+    const int bandRows = (rows + bandCount - 1) / bandCount;
+    QThreadPool *pool = QThreadPool::globalInstance();
+    QSemaphore done;
+    int started = 0;
+    for (int first = begin + bandRows; first < end; first += bandRows) {
+        const int last = qMin(first + bandRows, end);
+        BandJob<Function> *job = new BandJob<Function>(function, first, last, done);
+        if (pool->tryStart(job)) {
+            ++started;
+        } else {
+            delete job;
+            function(first, last);
+        }
+    }
+    function(begin, qMin(begin + bandRows, end));
+    done.acquire(started);
+}
+
+}
+
+#endif // FILTEREFFECTROWS_H
@@ -23,10 +23,72 @@
 #include "KoViewConverter.h"
 #include "KoXmlWriter.h"
 #include "KoXmlReader.h"
+#include "FilterEffectRows.h"
 #include <klocalizedstring.h>
 #include <QRect>
 #include <QImage>
+#include <QVector>
 #include <cmath>
+#include <string.h>
+
+namespace
+{
+
+struct ErodeOperator
+{
+    static uchar apply(uchar a, uchar b) { return a < b ? a : b; }
+};
+
+struct DilateOperator
+{
+    static uchar apply(uchar a, uchar b) { return a > b ? a : b; }
+};
+
+/**
+ * Applies the operator over the rectangular mask to the pixels [minX, maxX) x [minY, maxY).
+ *
+ * The rectangle is separable, so rows are reduced horizontally first and the
+ * result is reduced vertically, with inner loops running over contiguous bytes.
+ */
+template <typename Operator>
+void morphology(const uchar *src, uchar *dst, int w, int rx, int ry, int minX, int maxX, int minY, int maxY)
+{
+    const int columns = maxX - minX;
+    const int lineBytes = 4 * columns;
+    const int firstLine = minY - ry;
+    QVector<uchar> lines(lineBytes * (maxY + ry - firstLine));
+    uchar *tmp = lines.data();
+
+    FilterEffectRows::process(firstLine, maxY + ry, columns, [=](int first, int last) {
+        for (int row = first; row < last; ++row) {
+            const uchar *s = src + 4 * (row * w + minX);
+            uchar *t = tmp + (row - firstLine) * lineBytes;
+            memcpy(t, s - 4 * rx, lineBytes);
+            for (int dx = -rx + 1; dx <= rx; ++dx) {
+                const uchar *sx = s + 4 * dx;
+                for (int k = 0; k < lineBytes; ++k) {
+                    t[k] = Operator::apply(t[k], sx[k]);
+                }
+            }
+        }
+    });
+
+    FilterEffectRows::process(minY, maxY, columns, [=](int first, int last) {
+        for (int row = first; row < last; ++row) {
+            uchar *d = dst + 4 * (row * w + minX);
+            const uchar *t = tmp + (row - minY) * lineBytes;
+            memcpy(d, t, lineBytes);
+            for (int dy = 1; dy <= 2 * ry; ++dy) {
+                const uchar *ty = t + dy * lineBytes;
+                for (int k = 0; k < lineBytes; ++k) {
+                    d[k] = Operator::apply(d[k], ty[k]);
+                }
+            }
+        }
+    });
+}
+
+}
 
 MorphologyEffect::MorphologyEffect()
         : KoFilterEffect(MorphologyEffectId, i18n("Morphology"))
@@ -66,59 +128,22 @@ QImage MorphologyEffect::processImage(const QImage &image, const KoFilterEffectR
     const int w = result.width();
     const int h = result.height();
 
-    // setup mask
-    const int maskSize = (1+2*rx)*(1+2*ry);
-    int * mask = new int[maskSize];
-    int index = 0;
-    for (int y = -ry; y <= ry; ++y) {
-        for (int x = -rx; x <= rx; ++x) {
-            mask[index] = y*w+x;
-            index++;
-        }
-    }
-
-    int dstPixel, srcPixel;
-    uchar s0, s1, s2, s3;
-    const uchar * src = image.constBits();
-    uchar * dst = result.bits();
-
     const QRect roi = context.filterRegion().toRect();
     const int minX = qMax(rx, roi.left());
     const int maxX = qMin(w-rx, roi.right());
     const int minY = qMax(ry, roi.top());
     const int maxY = qMin(h-ry, roi.bottom());
-    const int defValue = m_operator == Erode ? 255 : 0;
-
-    uchar * d = 0;
-
-    for (int row = minY; row < maxY; ++row) {
-        for (int col = minX; col < maxX; ++col) {
-            dstPixel = row * w + col;
-            s0 = s1 = s2 = s3 = defValue;
-            for (int i = 0; i < maskSize; ++i) {
-                srcPixel = dstPixel+mask[i];
-                const uchar *s = &src[4*srcPixel];
-                if (m_operator == Erode ) {
-                    s0 = qMin(s0, s[0]);
-                    s1 = qMin(s1, s[1]);
-                    s2 = qMin(s2, s[2]);
-                    s3 = qMin(s3, s[3]);
-                } else {
-                    s0 = qMax(s0, s[0]);
-                    s1 = qMax(s1, s[1]);
-                    s2 = qMax(s2, s[2]);
-                    s3 = qMax(s3, s[3]);
-                }
-            }
-            d = &dst[4*dstPixel];
-            d[0] = s0;
-            d[1] = s1;
-            d[2] = s2;
-            d[3] = s3;
-        }
-    }
+    if (minX >= maxX || minY >= maxY)
+        return result;
 
-    delete [] mask;
+    const uchar * src = image.constBits();
+    uchar * dst = result.bits();
+
+    if (m_operator == Erode) {
+        morphology<ErodeOperator>(src, dst, w, rx, ry, minX, maxX, minY, maxY);
+    } else {
+        morphology<DilateOperator>(src, dst, w, rx, ry, minX, maxX, minY, maxY);
+    }
 
     return result;
 }
@@ -0,0 +1,95 @@
+/* This file is part of the KDE project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef FILTEREFFECTTESTIMAGE_H
+#define FILTEREFFECTTESTIMAGE_H
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QImage>
+#include <QVector>
+
+namespace FilterEffectTestImage
+{
+
+/**
+ * A premultiplied image of noise with varying alpha. A fixed generator
+ * is used instead of qrand(), so the content is the same on every platform.
+ * Different seeds give different images, e.g. for the second input of
+ * effects combining two images.
+ */
+inline QImage create(int width, int height, quint32 seed = 42)
+{
+    QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+    quint32 state = seed;
+    for (int y = 0; y < height; ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < width; ++x) {
+            // xorshift32
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            const int alpha = state >> 24;
+            line[x] = qRgba(((state >> 16) & 0xff) % (alpha + 1), ((state >> 8) & 0xff) % (alpha + 1),
+                            (state & 0xff) % (alpha + 1), alpha);
+        }
+    }
+    return image;
+}
+
+/// The hex MD5 of the red, green, blue and alpha bytes of all pixels, row by row
+inline QByteArray digest(const QImage &image)
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    QByteArray line;
+    for (int y = 0; y < image.height(); ++y) {
+        const QRgb *pixels = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+        line.resize(4 * image.width());
+        for (int x = 0; x < image.width(); ++x) {
+            line[4 * x] = qRed(pixels[x]);
+            line[4 * x + 1] = qGreen(pixels[x]);
+            line[4 * x + 2] = qBlue(pixels[x]);
+            line[4 * x + 3] = qAlpha(pixels[x]);
+        }
+        hash.addData(line);
+    }
+    return hash.result().toHex();
+}
+
+inline QVector<qreal> sepiaMatrix()
+{
+    QVector<qreal> matrix(20, 0.0);
+    matrix[0] = 0.393; matrix[1] = 0.769; matrix[2] = 0.189;
+    matrix[5] = 0.349; matrix[6] = 0.686; matrix[7] = 0.168;
+    matrix[10] = 0.272; matrix[11] = 0.534; matrix[12] = 0.131;
+    matrix[18] = 1.0;
+    return matrix;
+}
+
+inline QVector<qreal> embossKernel()
+{
+    QVector<qreal> kernel(9);
+    kernel[0] = -2.0; kernel[1] = -1.0; kernel[2] = 0.0;
+    kernel[3] = -1.0; kernel[4] = 1.0; kernel[5] = 1.0;
+    kernel[6] = 0.0; kernel[7] = 1.0; kernel[8] = 2.0;
+    return kernel;
+}
+
+}
+
+#endif // FILTEREFFECTTESTIMAGE_H
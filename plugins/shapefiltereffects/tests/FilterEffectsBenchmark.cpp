@@ -0,0 +1,936 @@
+/* This file is part of the KDE project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "FilterEffectsBenchmark.h"
+
+#include "BlendEffect.h"
+#include "BlurEffect.h"
+#include "ColorChannelConversion.h"
+#include "ColorMatrixEffect.h"
+#include "ComponentTransferEffect.h"
+#include "CompositeEffect.h"
+#include "ConvolveMatrixEffect.h"
+#include "MorphologyEffect.h"
+#include "FilterEffectTestImage.h"
+
+#include <KoFilterEffectRenderContext.h>
+#include <KoViewConverter.h>
+
+#include <QTest>
+
+#include <math.h>
+
+const int IMG_WIDTH = 2048;
+const int IMG_HEIGHT = 2048;
+
+const int BLUR_RADIUS = 12;
+const int MORPHOLOGY_RADIUS = 4;
+
+namespace
+{
+
+// The scalar, single threaded implementations the effects used before
+// being split over rows, kept to check results and to compare timings.
+
+// Stack Blur Algorithm by Mario Klingemann <mario@quasimondo.com>
+// fixed to handle alpha channel correctly by Zack Rusin
+void referenceBlur(QImage &img, int radius)
+{
+    if (radius < 1) {
+        return;
+    }
+
+    QRgb *pix = (QRgb*)img.bits();
+    int w   = img.width();
+    int h   = img.height();
+    int wm  = w - 1;
+    int hm  = h - 1;
+    int wh  = w * h;
+    int div = radius + radius + 1;
+
+    int *r = new int[wh];
+    int *g = new int[wh];
+    int *b = new int[wh];
+    int *a = new int[wh];
+    int rsum, gsum, bsum, asum, x, y, i, yp, yi, yw;
+    QRgb p;
+    int *vmin = new int[qMax(w, h)];
+
+    int divsum = (div + 1) >> 1;
+    divsum *= divsum;
+    int *dv = new int[256*divsum];
+    for (i = 0; i < 256*divsum; ++i) {
+        dv[i] = (i / divsum);
+    }
+
+    yw = yi = 0;
+
+    int **stack = new int*[div];
+    for (int i = 0; i < div; ++i) {
+        stack[i] = new int[4];
+    }
+
+
+    int stackpointer;
+    int stackstart;
+    int *sir;
+    int rbs;
+    int r1 = radius + 1;
+    int routsum, goutsum, boutsum, aoutsum;
+    int rinsum, ginsum, binsum, ainsum;
+
+    for (y = 0; y < h; ++y) {
+        rinsum = ginsum = binsum = ainsum
+                                   = routsum = goutsum = boutsum = aoutsum
+                                                                   = rsum = gsum = bsum = asum = 0;
+        for (i = - radius; i <= radius; ++i) {
+            p = pix[yi+qMin(wm, qMax(i, 0))];
+            sir = stack[i+radius];
+            sir[0] = qRed(p);
+            sir[1] = qGreen(p);
+            sir[2] = qBlue(p);
+            sir[3] = qAlpha(p);
+
+            rbs = r1 - abs(i);
+            rsum += sir[0] * rbs;
+            gsum += sir[1] * rbs;
+            bsum += sir[2] * rbs;
+            asum += sir[3] * rbs;
+
+            if (i > 0) {
+                rinsum += sir[0];
+                ginsum += sir[1];
+                binsum += sir[2];
+                ainsum += sir[3];
+            } else {
+                routsum += sir[0];
+                goutsum += sir[1];
+                boutsum += sir[2];
+                aoutsum += sir[3];
+            }
+        }
+        stackpointer = radius;
+
+        for (x = 0; x < w; ++x) {
+
+            r[yi] = dv[rsum];
+            g[yi] = dv[gsum];
+            b[yi] = dv[bsum];
+            a[yi] = dv[asum];
+
+            rsum -= routsum;
+            gsum -= goutsum;
+            bsum -= boutsum;
+            asum -= aoutsum;
+
+            stackstart = stackpointer - radius + div;
+            sir = stack[stackstart%div];
+
+            routsum -= sir[0];
+            goutsum -= sir[1];
+            boutsum -= sir[2];
+            aoutsum -= sir[3];
+
+            if (y == 0) {
+                vmin[x] = qMin(x + radius + 1, wm);
+            }
+            p = pix[yw+vmin[x]];
+
+            sir[0] = qRed(p);
+            sir[1] = qGreen(p);
+            sir[2] = qBlue(p);
+            sir[3] = qAlpha(p);
+
+            rinsum += sir[0];
+            ginsum += sir[1];
+            binsum += sir[2];
+            ainsum += sir[3];
+
+            rsum += rinsum;
+            gsum += ginsum;
+            bsum += binsum;
+            asum += ainsum;
+
+            stackpointer = (stackpointer + 1) % div;
+            sir = stack[(stackpointer)%div];
+
+            routsum += sir[0];
+            goutsum += sir[1];
+            boutsum += sir[2];
+            aoutsum += sir[3];
+
+            rinsum -= sir[0];
+            ginsum -= sir[1];
+            binsum -= sir[2];
+            ainsum -= sir[3];
+
+            ++yi;
+        }
+        yw += w;
+    }
+    for (x = 0; x < w; ++x) {
+        rinsum = ginsum = binsum = ainsum
+                                   = routsum = goutsum = boutsum = aoutsum
+                                                                   = rsum = gsum = bsum = asum = 0;
+
+        yp = - radius * w;
+
+        for (i = -radius; i <= radius; ++i) {
+            yi = qMax(0, yp) + x;
+
+            sir = stack[i+radius];
+
+            sir[0] = r[yi];
+            sir[1] = g[yi];
+            sir[2] = b[yi];
+            sir[3] = a[yi];
+
+            rbs = r1 - abs(i);
+
+            rsum += r[yi] * rbs;
+            gsum += g[yi] * rbs;
+            bsum += b[yi] * rbs;
+            asum += a[yi] * rbs;
+
+            if (i > 0) {
+                rinsum += sir[0];
+                ginsum += sir[1];
+                binsum += sir[2];
+                ainsum += sir[3];
+            } else {
+                routsum += sir[0];
+                goutsum += sir[1];
+                boutsum += sir[2];
+                aoutsum += sir[3];
+            }
+
+            if (i < hm) {
+                yp += w;
+            }
+        }
+
+        yi = x;
+        stackpointer = radius;
+
+        for (y = 0; y < h; ++y) {
+            pix[yi] = qRgba(dv[rsum], dv[gsum], dv[bsum], dv[asum]);
+
+            rsum -= routsum;
+            gsum -= goutsum;
+            bsum -= boutsum;
+            asum -= aoutsum;
+
+            stackstart = stackpointer - radius + div;
+            sir = stack[stackstart%div];
+
+            routsum -= sir[0];
+            goutsum -= sir[1];
+            boutsum -= sir[2];
+            aoutsum -= sir[3];
+
+            if (x == 0) {
+                vmin[y] = qMin(y + r1, hm) * w;
+            }
+            p = x + vmin[y];
+
+            sir[0] = r[p];
+            sir[1] = g[p];
+            sir[2] = b[p];
+            sir[3] = a[p];
+
+            rinsum += sir[0];
+            ginsum += sir[1];
+            binsum += sir[2];
+            ainsum += sir[3];
+
+            rsum += rinsum;
+            gsum += ginsum;
+            bsum += binsum;
+            asum += ainsum;
+
+            stackpointer = (stackpointer + 1) % div;
+            sir = stack[stackpointer];
+
+            routsum += sir[0];
+            goutsum += sir[1];
+            boutsum += sir[2];
+            aoutsum += sir[3];
+
+            rinsum -= sir[0];
+            ginsum -= sir[1];
+            binsum -= sir[2];
+            ainsum -= sir[3];
+
+            yi += w;
+        }
+    }
+    delete [] r;
+    delete [] g;
+    delete [] b;
+    delete [] a;
+    delete [] vmin;
+    delete [] dv;
+
+    for (int i = 0; i < div; ++i) {
+        delete [] stack[i];
+    }
+    delete [] stack;
+}
+
+QImage referenceMorphology(const QImage &image, int rx, int ry, bool erode)
+{
+    QImage result = image;
+
+    const int w = result.width();
+    const int h = result.height();
+
+    // setup mask
+    const int maskSize = (1+2*rx)*(1+2*ry);
+    int * mask = new int[maskSize];
+    int index = 0;
+    for (int y = -ry; y <= ry; ++y) {
+        for (int x = -rx; x <= rx; ++x) {
+            mask[index] = y*w+x;
+            index++;
+        }
+    }
+
+    int dstPixel, srcPixel;
+    uchar s0, s1, s2, s3;
+    const uchar * src = image.constBits();
+    uchar * dst = result.bits();
+
+    const QRect roi = image.rect();
+    const int minX = qMax(rx, roi.left());
+    const int maxX = qMin(w-rx, roi.right());
+    const int minY = qMax(ry, roi.top());
+    const int maxY = qMin(h-ry, roi.bottom());
+    const int defValue = erode ? 255 : 0;
+
+    uchar * d = 0;
+
+    for (int row = minY; row < maxY; ++row) {
+        for (int col = minX; col < maxX; ++col) {
+            dstPixel = row * w + col;
+            s0 = s1 = s2 = s3 = defValue;
+            for (int i = 0; i < maskSize; ++i) {
+                srcPixel = dstPixel+mask[i];
+                const uchar *s = &src[4*srcPixel];
+                if (erode) {
+                    s0 = qMin(s0, s[0]);
+                    s1 = qMin(s1, s[1]);
+                    s2 = qMin(s2, s[2]);
+                    s3 = qMin(s3, s[3]);
+                } else {
+                    s0 = qMax(s0, s[0]);
+                    s1 = qMax(s1, s[1]);
+                    s2 = qMax(s2, s[2]);
+                    s3 = qMax(s3, s[3]);
+                }
+            }
+            d = &dst[4*dstPixel];
+            d[0] = s0;
+            d[1] = s1;
+            d[2] = s2;
+            d[3] = s3;
+        }
+    }
+
+    delete [] mask;
+
+    return result;
+}
+
+QImage referenceColorMatrix(const QImage &image, const QVector<qreal> &matrix)
+{
+    QImage result = image;
+
+    const QRgb *src = (const QRgb*)image.constBits();
+    QRgb *dst = (QRgb*)result.bits();
+    int w = result.width();
+
+    const qreal * m = matrix.data();
+    qreal sa, sr, sg, sb;
+    qreal da, dr, dg, db;
+
+    QRect roi = image.rect();
+    for (int row = roi.top(); row < roi.bottom(); ++row) {
+        for (int col = roi.left(); col < roi.right(); ++col) {
+            const QRgb &s = src[row*w+col];
+            sa = fromIntColor[qAlpha(s)];
+            sr = fromIntColor[qRed(s)];
+            sg = fromIntColor[qGreen(s)];
+            sb = fromIntColor[qBlue(s)];
+            if (sa > 0.0 && sa < 1.0) {
+                sr /= sa;
+                sb /= sa;
+                sg /= sa;
+            }
+
+            dr = m[ 0] * sr + m[ 1] * sg + m[ 2] * sb + m[ 3] * sa + m[ 4];
+            dg = m[ 5] * sr + m[ 6] * sg + m[ 7] * sb + m[ 8] * sa + m[ 9];
+            db = m[10] * sr + m[11] * sg + m[12] * sb + m[13] * sa + m[14];
+            da = m[15] * sr + m[16] * sg + m[17] * sb + m[18] * sa + m[19];
+
+            da *= 255.0;
+
+            dst[row*w+col] = qRgba(static_cast<quint8>(qBound(qreal(0.0), dr * da, qreal(255.0))),
+                                   static_cast<quint8>(qBound(qreal(0.0), dg * da, qreal(255.0))),
+                                   static_cast<quint8>(qBound(qreal(0.0), db * da, qreal(255.0))),
+                                   static_cast<quint8>(qBound(qreal(0.0), da, qreal(255.0))));
+        }
+    }
+
+    return result;
+}
+QImage referenceConvolveMatrix(const QImage &image, const ConvolveMatrixEffect &effect)
+{
+    QImage result = image;
+
+    const int rx = effect.order().x();
+    const int ry = effect.order().y();
+    const QPoint target = effect.target();
+    const int tx = target.x() >= 0 && target.x() <= rx ? target.x() : rx >> 1;
+    const int ty = target.y() >= 0 && target.y() <= ry ? target.y() : ry >> 1;
+
+    const int w = result.width();
+    const int h = result.height();
+
+    // setup mask
+    const int maskSize = rx*ry;
+    QVector<QPoint> offset(maskSize);
+    int index = 0;
+    for (int y = 0; y < ry; ++y) {
+        for (int x = 0; x < rx; ++x) {
+            offset[index] = QPoint(x-tx, y-ty);
+            index++;
+        }
+    }
+
+    const QVector<qreal> kernel = effect.kernel();
+    qreal divisor = effect.divisor();
+    if (divisor == 0.0) {
+        for (int i = 0; i < kernel.count(); ++i) {
+            divisor += kernel[i];
+        }
+        if (divisor == 0.0)
+            divisor = 1.0;
+    }
+    const qreal bias = effect.bias();
+    const bool preserveAlpha = effect.isPreserveAlphaEnabled();
+
+    int dstPixel, srcPixel;
+    qreal sumA, sumR, sumG, sumB;
+    const QRgb * src = (const QRgb*)image.constBits();
+    QRgb * dst = (QRgb*)result.bits();
+
+    const QRect roi = image.rect();
+    int srcRow, srcCol;
+    for (int row = roi.top(); row <= roi.bottom(); ++row) {
+        for (int col = roi.left(); col <= roi.right(); ++col) {
+            dstPixel = row * w + col;
+            sumA = sumR = sumG = sumB = 0;
+            for (int i = 0; i < maskSize; ++i) {
+                srcRow = row + offset[i].y();
+                srcCol = col + offset[i].x();
+                if (srcRow < 0 || srcRow >= h) {
+                    switch (effect.edgeMode()) {
+                    case ConvolveMatrixEffect::Duplicate:
+                        srcRow = srcRow >= h ? h-1 : 0;
+                        break;
+                    case ConvolveMatrixEffect::Wrap:
+                        srcRow = (srcRow+h)%h;
+                        break;
+                    case ConvolveMatrixEffect::None:
+                        continue;
+                    }
+                }
+                if (srcCol < 0 || srcCol >= w) {
+                    switch (effect.edgeMode()) {
+                    case ConvolveMatrixEffect::Duplicate:
+                        srcCol = srcCol >= w ? w-1 : 0;
+                        break;
+                    case ConvolveMatrixEffect::Wrap:
+                        srcCol = (srcCol+w)%w;
+                        break;
+                    case ConvolveMatrixEffect::None:
+                        continue;
+                    }
+                }
+                srcPixel = srcRow * w + srcCol;
+                const QRgb &s = src[srcPixel];
+                const qreal &k = kernel[i];
+                if (!preserveAlpha)
+                    sumA += qAlpha(s) * k;
+                sumR += qRed(s) * k;
+                sumG += qGreen(s) * k;
+                sumB += qBlue(s) * k;
+            }
+            dst[dstPixel] = qRgba(qBound(0, static_cast<int>(sumR / divisor + bias), 255),
+                                  qBound(0, static_cast<int>(sumG / divisor + bias), 255),
+                                  qBound(0, static_cast<int>(sumB / divisor + bias), 255),
+                                  preserveAlpha ? qAlpha(dst[dstPixel]) : qBound(0, static_cast<int>(sumA / divisor + bias), 255));
+        }
+    }
+
+    return result;
+}
+
+qreal referenceTransferChannel(const ComponentTransferEffect &effect, ComponentTransferEffect::Channel channel, qreal value)
+{
+    const QList<qreal> tableValues = effect.tableValues(channel);
+
+    switch (effect.function(channel)) {
+    case ComponentTransferEffect::Identity:
+        return value;
+    case ComponentTransferEffect::Table: {
+        qreal valueCount = tableValues.count() - 1;
+        if (valueCount < 0.0)
+            return value;
+        qreal k1 = static_cast<int>(value * valueCount);
+        qreal k2 = qMin(k1 + 1, valueCount);
+        qreal vk1 = tableValues[k1];
+        qreal vk2 = tableValues[k2];
+        return vk1 + (value - static_cast<qreal>(k1) / valueCount)*valueCount *(vk2 - vk1);
+    }
+    case ComponentTransferEffect::Discrete: {
+        qreal valueCount = tableValues.count() - 1;
+        if (valueCount < 0.0)
+            return value;
+        return tableValues[static_cast<int>(value*valueCount)];
+    }
+    case ComponentTransferEffect::Linear:
+        return effect.slope(channel) * value + effect.intercept(channel);
+    case ComponentTransferEffect::Gamma:
+        return effect.amplitude(channel) * pow(value, effect.exponent(channel)) + effect.offset(channel);
+    }
+
+    return value;
+}
+
+QImage referenceComponentTransfer(const QImage &image, const ComponentTransferEffect &effect)
+{
+    QImage result = image;
+
+    const QRgb *src = (const QRgb*)image.constBits();
+    QRgb *dst = (QRgb*)result.bits();
+    int w = result.width();
+
+    qreal sa, sr, sg, sb;
+    qreal da, dr, dg, db;
+    int pixel;
+
+    const QRect roi = image.rect();
+    for (int row = roi.top(); row <= roi.bottom(); ++row) {
+        for (int col = roi.left(); col <= roi.right(); ++col) {
+            pixel = row * w + col;
+            const QRgb &s = src[pixel];
+
+            sa = fromIntColor[qAlpha(s)];
+            sr = fromIntColor[qRed(s)];
+            sg = fromIntColor[qGreen(s)];
+            sb = fromIntColor[qBlue(s)];
+            if (sa > 0.0 && sa < 1.0) {
+                sr /= sa;
+                sb /= sa;
+                sg /= sa;
+            }
+
+            dr = referenceTransferChannel(effect, ComponentTransferEffect::ChannelR, sr);
+            dg = referenceTransferChannel(effect, ComponentTransferEffect::ChannelG, sg);
+            db = referenceTransferChannel(effect, ComponentTransferEffect::ChannelB, sb);
+            da = referenceTransferChannel(effect, ComponentTransferEffect::ChannelA, sa);
+
+            da *= 255.0;
+
+            dst[pixel] = qRgba(static_cast<quint8>(qBound(qreal(0.0), dr * da, qreal(255.0))),
+                               static_cast<quint8>(qBound(qreal(0.0), dg * da, qreal(255.0))),
+                               static_cast<quint8>(qBound(qreal(0.0), db * da, qreal(255.0))),
+                               static_cast<quint8>(qBound(qreal(0.0), da, qreal(255.0))));
+        }
+    }
+
+    return result;
+}
+
+QImage referenceBlend(const QImage &image, const QImage &other, BlendEffect::BlendMode blendMode)
+{
+    QImage result = image;
+
+    const QRgb *src = (const QRgb*)other.constBits();
+    QRgb *dst = (QRgb*)result.bits();
+    int w = result.width();
+
+    qreal sa, sr, sg, sb;
+    qreal da, dr, dg, db;
+    int pixel = 0;
+
+    const QRect roi = image.rect();
+    for (int row = roi.top(); row < roi.bottom(); ++row) {
+        for (int col = roi.left(); col < roi.right(); ++col) {
+            pixel = row * w + col;
+            const QRgb &s = src[pixel];
+            QRgb &d = dst[pixel];
+
+            sa = fromIntColor[qAlpha(s)];
+            sr = fromIntColor[qRed(s)];
+            sg = fromIntColor[qGreen(s)];
+            sb = fromIntColor[qBlue(s)];
+
+            da = fromIntColor[qAlpha(d)];
+            dr = fromIntColor[qRed(d)];
+            dg = fromIntColor[qGreen(d)];
+            db = fromIntColor[qBlue(d)];
+
+            switch (blendMode) {
+            case BlendEffect::Normal:
+                dr = (qreal(1.0) - da) * sr + dr;
+                dg = (qreal(1.0) - da) * sg + dg;
+                db = (qreal(1.0) - da) * sb + db;
+                break;
+            case BlendEffect::Multiply:
+                dr = (qreal(1.0) - da) * sr + (qreal(1.0) - sa) * dr + dr * sr;
+                dg = (qreal(1.0) - da) * sg + (qreal(1.0) - sa) * dg + dg * sg;
+                db = (qreal(1.0) - da) * sb + (qreal(1.0) - sa) * db + db * sb;
+                break;
+            case BlendEffect::Screen:
+                dr = sr + dr - dr * sr;
+                dg = sg + dg - dg * sg;
+                db = sb + db - db * sb;
+                break;
+            case BlendEffect::Darken:
+                dr = qMin((qreal(1.0) - da) * sr + dr, (qreal(1.0) - sa) * dr + sr);
+                dg = qMin((qreal(1.0) - da) * sg + dg, (qreal(1.0) - sa) * dg + sg);
+                db = qMin((qreal(1.0) - da) * sb + db, (qreal(1.0) - sa) * db + sb);
+                break;
+            case BlendEffect::Lighten:
+                dr = qMax((qreal(1.0) - da) * sr + dr, (qreal(1.0) - sa) * dr + sr);
+                dg = qMax((qreal(1.0) - da) * sg + dg, (qreal(1.0) - sa) * dg + sg);
+                db = qMax((qreal(1.0) - da) * sb + db, (qreal(1.0) - sa) * db + sb);
+                break;
+            }
+            da = qreal(1.0) - (qreal(1.0) - da) * (qreal(1.0) - sa);
+
+            d = qRgba(static_cast<quint8>(qBound(qreal(0.0), dr * qreal(255.0), qreal(255.0))),
+                      static_cast<quint8>(qBound(qreal(0.0), dg * qreal(255.0), qreal(255.0))),
+                      static_cast<quint8>(qBound(qreal(0.0), db * qreal(255.0), qreal(255.0))),
+                      static_cast<quint8>(qBound(qreal(0.0), da * qreal(255.0), qreal(255.0))));
+        }
+    }
+
+    return result;
+}
+
+QImage referenceArithmeticComposite(const QImage &image, const QImage &other, const qreal *k)
+{
+    QImage result = image;
+
+    const QRgb *src = (const QRgb*)other.constBits();
+    QRgb *dst = (QRgb*)result.bits();
+    int w = result.width();
+
+    qreal sa, sr, sg, sb;
+    qreal da, dr, dg, db;
+    int pixel = 0;
+
+    const QRect roi = image.rect();
+    for (int row = roi.top(); row < roi.bottom(); ++row) {
+        for (int col = roi.left(); col < roi.right(); ++col) {
+            pixel = row * w + col;
+            const QRgb &s = src[pixel];
+            QRgb &d = dst[pixel];
+
+            sa = fromIntColor[qAlpha(s)];
+            sr = fromIntColor[qRed(s)];
+            sg = fromIntColor[qGreen(s)];
+            sb = fromIntColor[qBlue(s)];
+
+            da = fromIntColor[qAlpha(d)];
+            dr = fromIntColor[qRed(d)];
+            dg = fromIntColor[qGreen(d)];
+            db = fromIntColor[qBlue(d)];
+
+            da = k[0] * sa * da + k[1] * da + k[2] * sa + k[3];
+            dr = k[0] * sr * dr + k[1] * dr + k[2] * sr + k[3];
+            dg = k[0] * sg * dg + k[1] * dg + k[2] * sg + k[3];
+            db = k[0] * sb * db + k[1] * db + k[2] * sb + k[3];
+
+            da *= 255.0;
+
+            d = qRgba(static_cast<quint8>(qBound(qreal(0.0), dr * da, qreal(255.0))),
+                      static_cast<quint8>(qBound(qreal(0.0), dg * da, qreal(255.0))),
+                      static_cast<quint8>(qBound(qreal(0.0), db * da, qreal(255.0))),
+                      static_cast<quint8>(qBound(qreal(0.0), da, qreal(255.0))));
+        }
+    }
+
+    return result;
+}
+
+}
+
+void FilterEffectsBenchmark::initTestCase()
+{
+    m_image = FilterEffectTestImage::create(IMG_WIDTH, IMG_HEIGHT);
+    m_otherImage = FilterEffectTestImage::create(IMG_WIDTH, IMG_HEIGHT, 7);
+}
+
+#define FILTER_CONTEXT(context) \
+    KoViewConverter converter; \
+    KoFilterEffectRenderContext context(converter); \
+    context.setShapeBoundingBox(QRectF(0, 0, 1, 1)); \
+    context.setFilterRegion(m_image.rect())
+
+void FilterEffectsBenchmark::testBlur()
+{
+    FILTER_CONTEXT(context);
+    BlurEffect effect;
+    effect.setDeviation(QPointF(BLUR_RADIUS, BLUR_RADIUS));
+
+    QImage expected = m_image;
+    referenceBlur(expected, BLUR_RADIUS);
+    QCOMPARE(effect.processImage(m_image, context), expected);
+}
+
+void FilterEffectsBenchmark::benchmarkBlur()
+{
+    FILTER_CONTEXT(context);
+    BlurEffect effect;
+    effect.setDeviation(QPointF(BLUR_RADIUS, BLUR_RADIUS));
+
+    QBENCHMARK {
+        effect.processImage(m_image, context);
+    }
+}
+
+void FilterEffectsBenchmark::benchmarkReferenceBlur()
+{
+    QBENCHMARK {
+        QImage result = m_image;
+        referenceBlur(result, BLUR_RADIUS);
+    }
+}
+
+void FilterEffectsBenchmark::testMorphology()
+{
+    FILTER_CONTEXT(context);
+    MorphologyEffect effect;
+    effect.setMorphologyRadius(QPointF(MORPHOLOGY_RADIUS, MORPHOLOGY_RADIUS));
+
+    effect.setMorphologyOperator(MorphologyEffect::Erode);
+    QCOMPARE(effect.processImage(m_image, context), referenceMorphology(m_image, MORPHOLOGY_RADIUS, MORPHOLOGY_RADIUS, true));
+    effect.setMorphologyOperator(MorphologyEffect::Dilate);
+    QCOMPARE(effect.processImage(m_image, context), referenceMorphology(m_image, MORPHOLOGY_RADIUS, MORPHOLOGY_RADIUS, false));
+}
+
+void FilterEffectsBenchmark::benchmarkMorphology()
+{
+    FILTER_CONTEXT(context);
+    MorphologyEffect effect;
+    effect.setMorphologyRadius(QPointF(MORPHOLOGY_RADIUS, MORPHOLOGY_RADIUS));
+
+    QBENCHMARK {
+        effect.processImage(m_image, context);
+    }
+}
+
+void FilterEffectsBenchmark::benchmarkReferenceMorphology()
+{
+    QBENCHMARK {
+        referenceMorphology(m_image, MORPHOLOGY_RADIUS, MORPHOLOGY_RADIUS, true);
+    }
+}
+
+void FilterEffectsBenchmark::testColorMatrix()
+{
+    FILTER_CONTEXT(context);
+    ColorMatrixEffect effect;
+    effect.setColorMatrix(FilterEffectTestImage::sepiaMatrix());
+
+    QCOMPARE(effect.processImage(m_image, context), referenceColorMatrix(m_image, FilterEffectTestImage::sepiaMatrix()));
+}
+
+void FilterEffectsBenchmark::benchmarkColorMatrix()
+{
+    FILTER_CONTEXT(context);
+    ColorMatrixEffect effect;
+    effect.setColorMatrix(FilterEffectTestImage::sepiaMatrix());
+
+    QBENCHMARK {
+        effect.processImage(m_image, context);
+    }
+}
+
+void FilterEffectsBenchmark::benchmarkReferenceColorMatrix()
+{
+    const QVector<qreal> matrix = FilterEffectTestImage::sepiaMatrix();
+    QBENCHMARK {
+        referenceColorMatrix(m_image, matrix);
+    }
+}
+
+void FilterEffectsBenchmark::testConvolveMatrix()
+{
+    FILTER_CONTEXT(context);
+    ConvolveMatrixEffect effect;
+    effect.setKernel(FilterEffectTestImage::embossKernel());
+
+    effect.setEdgeMode(ConvolveMatrixEffect::Duplicate);
+    QCOMPARE(effect.processImage(m_image, context), referenceConvolveMatrix(m_image, effect));
+    effect.setEdgeMode(ConvolveMatrixEffect::Wrap);
+    QCOMPARE(effect.processImage(m_image, context), referenceConvolveMatrix(m_image, effect));
+    effect.setEdgeMode(ConvolveMatrixEffect::None);
+    QCOMPARE(effect.processImage(m_image, context), referenceConvolveMatrix(m_image, effect));
+}
+
+void FilterEffectsBenchmark::benchmarkConvolveMatrix()
+{
+    FILTER_CONTEXT(context);
+    ConvolveMatrixEffect effect;
+    effect.setKernel(FilterEffectTestImage::embossKernel());
+
+    QBENCHMARK {
+        effect.processImage(m_image, context);
+    }
+}
+
+void FilterEffectsBenchmark::benchmarkReferenceConvolveMatrix()
+{
+    ConvolveMatrixEffect effect;
+    effect.setKernel(FilterEffectTestImage::embossKernel());
+
+    QBENCHMARK {
+        referenceConvolveMatrix(m_image, effect);
+    }
+}
+
+static void setupComponentTransfer(ComponentTransferEffect &effect)
+{
+    effect.setFunction(ComponentTransferEffect::ChannelR, ComponentTransferEffect::Table);
+    effect.setTableValues(ComponentTransferEffect::ChannelR, QList<qreal>() << 0.0 << 0.8 << 0.2 << 1.0);
+    effect.setFunction(ComponentTransferEffect::ChannelG, ComponentTransferEffect::Discrete);
+    effect.setTableValues(ComponentTransferEffect::ChannelG, QList<qreal>() << 0.2 << 0.6 << 1.0);
+    effect.setFunction(ComponentTransferEffect::ChannelB, ComponentTransferEffect::Linear);
+    effect.setSlope(ComponentTransferEffect::ChannelB, 0.5);
+    effect.setIntercept(ComponentTransferEffect::ChannelB, 0.25);
+    effect.setFunction(ComponentTransferEffect::ChannelA, ComponentTransferEffect::Gamma);
+    effect.setAmplitude(ComponentTransferEffect::ChannelA, 1.0);
+    effect.setExponent(ComponentTransferEffect::ChannelA, 0.5);
+    effect.setOffset(ComponentTransferEffect::ChannelA, 0.0);
+}
+
+void FilterEffectsBenchmark::testComponentTransfer()
+{
+    FILTER_CONTEXT(context);
+    ComponentTransferEffect effect;
+    setupComponentTransfer(effect);
+
+    QCOMPARE(effect.processImage(m_image, context), referenceComponentTransfer(m_image, effect));
+}
+
+void FilterEffectsBenchmark::benchmarkComponentTransfer()
+{
+    FILTER_CONTEXT(context);
+    ComponentTransferEffect effect;
+    setupComponentTransfer(effect);
+
+    QBENCHMARK {
+        effect.processImage(m_image, context);
+    }
+}
+
+void FilterEffectsBenchmark::benchmarkReferenceComponentTransfer()
+{
+    ComponentTransferEffect effect;
+    setupComponentTransfer(effect);
+
+    QBENCHMARK {
+        referenceComponentTransfer(m_image, effect);
+    }
+}
+
+void FilterEffectsBenchmark::testBlend()
+{
+    FILTER_CONTEXT(context);
+    BlendEffect effect;
+
+    QVector<QImage> images;
+    images << m_image << m_otherImage;
+    for (int mode = BlendEffect::Normal; mode <= BlendEffect::Lighten; ++mode) {
+        effect.setBlendMode(static_cast<BlendEffect::BlendMode>(mode));
+        QCOMPARE(effect.processImages(images, context), referenceBlend(m_image, m_otherImage, effect.blendMode()));
+    }
+}
+
+void FilterEffectsBenchmark::benchmarkBlend()
+{
+    FILTER_CONTEXT(context);
+    BlendEffect effect;
+    effect.setBlendMode(BlendEffect::Multiply);
+
+    QVector<QImage> images;
+    images << m_image << m_otherImage;
+    QBENCHMARK {
+        effect.processImages(images, context);
+    }
+}
+
+void FilterEffectsBenchmark::benchmarkReferenceBlend()
+{
+    QBENCHMARK {
+        referenceBlend(m_image, m_otherImage, BlendEffect::Multiply);
+    }
+}
+
+void FilterEffectsBenchmark::testArithmeticComposite()
+{
+    FILTER_CONTEXT(context);
+    CompositeEffect effect;
+    effect.setOperation(CompositeEffect::Arithmetic);
+    qreal k[4] = { 0.5, 0.25, 0.25, 0.0 };
+    effect.setArithmeticValues(k);
+
+    QVector<QImage> images;
+    images << m_image << m_otherImage;
+    QCOMPARE(effect.processImages(images, context), referenceArithmeticComposite(m_image, m_otherImage, k));
+}
+
+void FilterEffectsBenchmark::benchmarkArithmeticComposite()
+{
+    FILTER_CONTEXT(context);
+    CompositeEffect effect;
+    effect.setOperation(CompositeEffect::Arithmetic);
+    qreal k[4] = { 0.5, 0.25, 0.25, 0.0 };
+    effect.setArithmeticValues(k);
+
+    QVector<QImage> images;
+    images << m_image << m_otherImage;
+    QBENCHMARK {
+        effect.processImages(images, context);
+    }
+}
+
+void FilterEffectsBenchmark::benchmarkReferenceArithmeticComposite()
+{
+    const qreal k[4] = { 0.5, 0.25, 0.25, 0.0 };
+    QBENCHMARK {
+        referenceArithmeticComposite(m_image, m_otherImage, k);
+    }
+}
+
+QTEST_GUILESS_MAIN(FilterEffectsBenchmark)
@@ -0,0 +1,64 @@
+/* This file is part of the KDE project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef FILTEREFFECTSBENCHMARK_H
+#define FILTEREFFECTSBENCHMARK_H
+
+#include <QObject>
+#include <QImage>
+
+class FilterEffectsBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+
+    void testBlur();
+    void benchmarkBlur();
+    void benchmarkReferenceBlur();
+
+    void testMorphology();
+    void benchmarkMorphology();
+    void benchmarkReferenceMorphology();
+
+    void testColorMatrix();
+    void benchmarkColorMatrix();
+    void benchmarkReferenceColorMatrix();
+
+    void testConvolveMatrix();
+    void benchmarkConvolveMatrix();
+    void benchmarkReferenceConvolveMatrix();
+
+    void testComponentTransfer();
+    void benchmarkComponentTransfer();
+    void benchmarkReferenceComponentTransfer();
+
+    void testBlend();
+    void benchmarkBlend();
+    void benchmarkReferenceBlend();
+
+    void testArithmeticComposite();
+    void benchmarkArithmeticComposite();
+    void benchmarkReferenceArithmeticComposite();
+
+private:
+    QImage m_image;
+    QImage m_otherImage;
+};
+
+#endif // FILTEREFFECTSBENCHMARK_H
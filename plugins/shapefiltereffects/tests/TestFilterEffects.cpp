@@ -0,0 +1,153 @@
+/* This file is part of the KDE project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "TestFilterEffects.h"
+
+#include "BlendEffect.h"
+#include "BlurEffect.h"
+#include "ColorMatrixEffect.h"
+#include "ComponentTransferEffect.h"
+#include "CompositeEffect.h"
+#include "ConvolveMatrixEffect.h"
+#include "MorphologyEffect.h"
+#include "FilterEffectTestImage.h"
+
+#include <KoFilterEffectRenderContext.h>
+#include <KoViewConverter.h>
+
+#include <QTest>
+
+// The golden digests were taken from the output of the effects before they
+// were split over rows, so any change in the results shows up here. The
+// images have more than FilterEffectRows::MinimumParallelPixels pixels, so
+// the effects process them in several bands.
+
+#define FILTER_CONTEXT(context) \
+    KoViewConverter converter; \
+    KoFilterEffectRenderContext context(converter); \
+    context.setShapeBoundingBox(QRectF(0, 0, 1, 1)); \
+    context.setFilterRegion(m_image.rect())
+
+void TestFilterEffects::initTestCase()
+{
+    m_image = FilterEffectTestImage::create(512, 384);
+    QCOMPARE(FilterEffectTestImage::digest(m_image), QByteArray("2d37c9949cf575a48ce0887448703943"));
+    m_otherImage = FilterEffectTestImage::create(512, 384, 7);
+    QCOMPARE(FilterEffectTestImage::digest(m_otherImage), QByteArray("f38d2ef047175bc2f106388f22cb0752"));
+}
+
+void TestFilterEffects::testBlur()
+{
+    FILTER_CONTEXT(context);
+    BlurEffect effect;
+    effect.setDeviation(QPointF(12, 12));
+
+    QCOMPARE(FilterEffectTestImage::digest(effect.processImage(m_image, context)),
+             QByteArray("130b90f87b7e72abc1f49d08c7e70b09"));
+}
+
+void TestFilterEffects::testErode()
+{
+    FILTER_CONTEXT(context);
+    MorphologyEffect effect;
+    effect.setMorphologyRadius(QPointF(4, 4));
+    effect.setMorphologyOperator(MorphologyEffect::Erode);
+
+    QCOMPARE(FilterEffectTestImage::digest(effect.processImage(m_image, context)),
+             QByteArray("4f4d98948ec3c1ef24a8c9bf95ff59b4"));
+}
+
+void TestFilterEffects::testDilate()
+{
+    FILTER_CONTEXT(context);
+    MorphologyEffect effect;
+    effect.setMorphologyRadius(QPointF(4, 4));
+    effect.setMorphologyOperator(MorphologyEffect::Dilate);
+
+    QCOMPARE(FilterEffectTestImage::digest(effect.processImage(m_image, context)),
+             QByteArray("254b1b192128fb0967f42c85f6a2b671"));
+}
+
+void TestFilterEffects::testColorMatrix()
+{
+    FILTER_CONTEXT(context);
+    ColorMatrixEffect effect;
+    effect.setColorMatrix(FilterEffectTestImage::sepiaMatrix());
+
+    QCOMPARE(FilterEffectTestImage::digest(effect.processImage(m_image, context)),
+             QByteArray("3690e8cc5f5672f44ede5b12a75ea7c6"));
+}
+
+void TestFilterEffects::testConvolveMatrix()
+{
+    FILTER_CONTEXT(context);
+    ConvolveMatrixEffect effect;
+    effect.setKernel(FilterEffectTestImage::embossKernel());
+    effect.setEdgeMode(ConvolveMatrixEffect::Wrap);
+
+    QCOMPARE(FilterEffectTestImage::digest(effect.processImage(m_image, context)),
+             QByteArray("1709c1d434c48503e10da1e74b21b40c"));
+}
+
+void TestFilterEffects::testComponentTransfer()
+{
+    FILTER_CONTEXT(context);
+    ComponentTransferEffect effect;
+    effect.setFunction(ComponentTransferEffect::ChannelR, ComponentTransferEffect::Table);
+    effect.setTableValues(ComponentTransferEffect::ChannelR, QList<qreal>() << 0.0 << 0.8 << 0.2 << 1.0);
+    effect.setFunction(ComponentTransferEffect::ChannelG, ComponentTransferEffect::Discrete);
+    effect.setTableValues(ComponentTransferEffect::ChannelG, QList<qreal>() << 0.2 << 0.6 << 1.0);
+    effect.setFunction(ComponentTransferEffect::ChannelB, ComponentTransferEffect::Linear);
+    effect.setSlope(ComponentTransferEffect::ChannelB, 0.5);
+    effect.setIntercept(ComponentTransferEffect::ChannelB, 0.25);
+    effect.setFunction(ComponentTransferEffect::ChannelA, ComponentTransferEffect::Gamma);
+    effect.setAmplitude(ComponentTransferEffect::ChannelA, 1.0);
+    effect.setExponent(ComponentTransferEffect::ChannelA, 0.5);
+    effect.setOffset(ComponentTransferEffect::ChannelA, 0.0);
+
+    QCOMPARE(FilterEffectTestImage::digest(effect.processImage(m_image, context)),
+             QByteArray("9009227792812e11151f20461a9e8451"));
+}
+
+void TestFilterEffects::testBlend()
+{
+    FILTER_CONTEXT(context);
+    BlendEffect effect;
+    effect.setBlendMode(BlendEffect::Multiply);
+
+    QVector<QImage> images;
+    images << m_image << m_otherImage;
+    QCOMPARE(FilterEffectTestImage::digest(effect.processImages(images, context)),
+             QByteArray("53f0b586fb62c275f621d0687c188462"));
+}
+
+void TestFilterEffects::testArithmeticComposite()
+{
+    FILTER_CONTEXT(context);
+    CompositeEffect effect;
+    effect.setOperation(CompositeEffect::Arithmetic);
+    qreal k[4] = { 0.5, 0.25, 0.25, 0.0 };
+    effect.setArithmeticValues(k);
+
+    QVector<QImage> images;
+    images << m_image << m_otherImage;
+    QCOMPARE(FilterEffectTestImage::digest(effect.processImages(images, context)),
+             QByteArray("11f3a9b72744cdf921c2344b81bd4713"));
+}
+
+QTEST_GUILESS_MAIN(TestFilterEffects)
@@ -32,6 +32,7 @@
 #include <QPainter>
 #include <QBuffer>
 #include <QDataStream>
+#include <QPicture>
 #include <QMutexLocker>
 #include <QThreadPool>
 #include <QSvgRenderer>
@@ -102,16 +103,19 @@ void VectorShape::setCompressedContents(const QByteArray &newContents, VectorTyp
     m_contents = newContents;
     m_type = vectorType;
     m_cache.clear();
+    m_displayList.clear();
+    m_displayListSize = QSizeF(); // drops a list recorded by a render still running
+
     update();
 }
 
 // ----------------------------------------------------------------
 //                             Painting
 
-RenderThread::RenderThread(const QByteArray &contents, VectorShape::VectorType type,
+RenderThread::RenderThread(const QByteArray &contents, const QByteArray &displayList, VectorShape::VectorType type,
                            const QSizeF &size, const QSize &boundingSize, qreal zoomX, qreal zoomY)
     : QObject(), QRunnable(),
-      m_contents(contents), m_type(type),
+      m_contents(contents), m_displayList(displayList), m_type(type),
       m_size(size), m_boundingSize(boundingSize), m_zoomX(zoomX), m_zoomY(zoomY)
 {
     setAutoDelete(true);
@@ -123,6 +127,8 @@ RenderThread::~RenderThread()
 
 void RenderThread::run()
 {
+    const QByteArray displayList = m_displayList.isEmpty() ? recordDisplayList() : m_displayList;
+
     QImage *image = new QImage(m_boundingSize, QImage::Format_ARGB32);
     image->fill(0);
     QPainter painter;
@@ -132,10 +138,26 @@ void RenderThread::run()
         image = 0;
     } else {
         painter.scale(m_zoomX, m_zoomY);
-        draw(painter);
+        // QPicture replays in a shared buffer, so every render uses its own instance
+        QPicture picture;
+        picture.setData(displayList.constData(), displayList.size());
+        painter.drawPicture(0, 0, picture);
         painter.end();
     }
-    emit finished(m_boundingSize, image);
+    emit finished(m_boundingSize, image, displayList);
+}
+
+QByteArray RenderThread::recordDisplayList()
+{
+    QPicture picture;
+    QPainter painter;
+    if (!painter.begin(&picture)) {
+        warnVector << "Failed to record display list";
+        return QByteArray();
+    }
+    draw(painter);
+    painter.end();
+    return QByteArray(picture.data(), picture.size());
 }
 
 void RenderThread::draw(QPainter &painter)
@@ -259,8 +281,14 @@ void VectorShape::paint(QPainter &painter, const KoViewConverter &converter, KoS
     }
 }
 
-void VectorShape::renderFinished(const QSize &boundingSize, QImage *image)
+void VectorShape::renderFinished(const QSize &boundingSize, QImage *image, const QByteArray &displayList)
 {
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_displayList.isEmpty()) {
+            m_displayList = displayList;
+        }
+    }
     if (image) {
         m_cache.insert(boundingSize.height(), image);
         update();
@@ -390,11 +418,20 @@ QImage* VectorShape::render(const KoViewConverter &converter, bool asynchronous,
             m_isRendering = true;
             qreal zoomX, zoomY;
             converter.zoom(&zoomX, &zoomY);
-            QMutexLocker locker(&m_mutex);
-            const QByteArray uncompressedContents =
-                m_type != VectorShape::VectorTypeNone ? qUncompress(m_contents) : QByteArray();
-            RenderThread *t = new RenderThread(uncompressedContents, m_type, size(), rect.size().toSize(), zoomX, zoomY);
-            connect(t, SIGNAL(finished(QSize,QImage*)), this, SLOT(renderFinished(QSize,QImage*)));
+            RenderThread *t;
+            {
+                QMutexLocker locker(&m_mutex);
+                // the display list depends on the shape size, the backends scale to it
+                if (m_displayListSize != size()) {
+                    m_displayList.clear();
+                    m_displayListSize = size();
+                }
+                // only uncompress and parse the contents once, other zoom levels replay the display list
+                const QByteArray uncompressedContents =
+                    m_displayList.isEmpty() && m_type != VectorShape::VectorTypeNone ? qUncompress(m_contents) : QByteArray();
+                t = new RenderThread(uncompressedContents, m_displayList, m_type, size(), rect.size().toSize(), zoomX, zoomY);
+            }
+            connect(t, SIGNAL(finished(QSize,QImage*,QByteArray)), this, SLOT(renderFinished(QSize,QImage*,QByteArray)));
             if (asynchronous) { // render and paint the image threaded
                 QThreadPool::globalInstance()->start(t);
             } else { // non-threaded rendering and painting of the image
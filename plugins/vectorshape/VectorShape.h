@@ -82,9 +82,11 @@ public:
     static VectorShape::VectorType vectorType(const QByteArray &contents);
 
 private Q_SLOTS:
-    void renderFinished(const QSize &boundingSize, QImage *image);
+    void renderFinished(const QSize &boundingSize, QImage *image, const QByteArray &displayList);
 
 private:
+    friend class TestVectorShape;
+
     static bool isWmf(const QByteArray &bytes);
     static bool isEmf(const QByteArray &bytes);
     static bool isSvm(const QByteArray &bytes);
@@ -96,6 +98,11 @@ private:
     mutable bool m_isRendering;
     mutable QMutex m_mutex;
     QCache<int, QImage> m_cache;
+    // The parsed contents, recorded as QPicture data so they can be
+    // replayed at any zoom without parsing the metafile again.
+    mutable QByteArray m_displayList;
+    // The shape size the display list was recorded for
+    mutable QSizeF m_displayListSize;
 
     QImage* render(const KoViewConverter &converter, bool asynchronous, bool useCache) const;
 };
@@ -105,13 +112,18 @@ class RenderThread : public QObject, public QRunnable
 {
     Q_OBJECT
 public:
-    RenderThread(const QByteArray &contents, VectorShape::VectorType type,
+    /**
+     * If @p displayList is empty, @p contents are parsed and recorded into
+     * a new display list first, which is passed on with finished().
+     */
+    RenderThread(const QByteArray &contents, const QByteArray &displayList, VectorShape::VectorType type,
                  const QSizeF &size, const QSize &boundingSize, qreal zoomX, qreal zoomY);
     virtual ~RenderThread();
     virtual void run();
 Q_SIGNALS:
-    void finished(const QSize &boundingSize, QImage *image);
+    void finished(const QSize &boundingSize, QImage *image, const QByteArray &displayList);
 private:
+    QByteArray recordDisplayList();
     void draw(QPainter &painter);
     void drawNull(QPainter &painter) const;
     void drawWmf(QPainter &painter) const;
@@ -120,6 +132,7 @@ private:
     void drawSvg(QPainter &painter) const;
 private:
     const QByteArray m_contents;
+    const QByteArray m_displayList;
     VectorShape::VectorType m_type;
     QSizeF m_size;
     QSize m_boundingSize;
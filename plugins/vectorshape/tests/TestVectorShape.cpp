@@ -0,0 +1,117 @@
+/* This file is part of the KDE project
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "TestVectorShape.h"
+
+#include "VectorShape.h"
+
+#include <KoViewConverter.h>
+
+#include <QImage>
+#include <QPainter>
+#include <QSvgRenderer>
+#include <QTest>
+
+static const char svg[] =
+    "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"100\" height=\"50\" viewBox=\"0 0 100 50\">"
+    "<rect x=\"5\" y=\"5\" width=\"40\" height=\"30\" fill=\"#3060c0\" stroke=\"#202020\" stroke-width=\"2\"/>"
+    "<circle cx=\"70\" cy=\"25\" r=\"18\" fill=\"#e08020\"/>"
+    "<path d=\"M 10 45 L 50 40 L 90 45\" fill=\"none\" stroke=\"#10a010\" stroke-width=\"1.5\"/>"
+    "</svg>";
+
+static void setUpShape(VectorShape &shape)
+{
+    shape.setSize(QSizeF(100, 50));
+    shape.setCompressedContents(qCompress(QByteArray(svg)), VectorShape::VectorTypeSvg);
+}
+
+/// Renders the shape synchronously at @p zoom, the image is owned by the shape
+static QImage *renderAt(VectorShape &shape, qreal zoom)
+{
+    KoViewConverter converter;
+    converter.setZoom(zoom);
+    return shape.render(converter, false, true);
+}
+
+/// Draws the SVG straight onto an image the size of @p cached, the way the shape draws it when recording
+static QImage drawDirectly(const QSizeF &shapeSize, const QImage &cached, qreal zoom)
+{
+    QImage image(cached.size(), QImage::Format_ARGB32);
+    image.fill(0);
+    QPainter painter(&image);
+    painter.scale(zoom, zoom);
+    QSvgRenderer renderer(QByteArray(svg));
+    renderer.render(&painter, QRectF(QPointF(), shapeSize));
+    painter.end();
+    return image;
+}
+
+void TestVectorShape::testDisplayListRecordedOnce()
+{
+    VectorShape shape;
+    setUpShape(shape);
+    QVERIFY(shape.m_displayList.isEmpty());
+
+    QVERIFY(renderAt(shape, 1.0));
+    const QByteArray displayList = shape.m_displayList;
+    QVERIFY(!displayList.isEmpty());
+
+    // contents that cannot be parsed any more: only the display list is replayed
+    shape.m_contents = qCompress(QByteArray("not a vector image"));
+
+    QImage *zoomed = renderAt(shape, 2.0);
+    QVERIFY(zoomed);
+    QCOMPARE(shape.m_displayList, displayList);
+    QCOMPARE(*zoomed, drawDirectly(shape.size(), *zoomed, 2.0));
+
+    QVERIFY(renderAt(shape, 0.5));
+    QCOMPARE(shape.m_displayList, displayList);
+}
+
+void TestVectorShape::testDisplayListReplaysLikeDirectDrawing()
+{
+    VectorShape shape;
+    setUpShape(shape);
+
+    const qreal zooms[] = { 1.0, 0.75, 1.5, 3.0 };
+    for (int i = 0; i < int(sizeof(zooms) / sizeof(zooms[0])); ++i) {
+        QImage *cached = renderAt(shape, zooms[i]);
+        QVERIFY(cached);
+        QVERIFY(!cached->isNull());
+        QCOMPARE(*cached, drawDirectly(shape.size(), *cached, zooms[i]));
+    }
+}
+
+void TestVectorShape::testDisplayListDroppedOnResize()
+{
+    VectorShape shape;
+    setUpShape(shape);
+
+    QVERIFY(renderAt(shape, 1.0));
+    const QByteArray displayList = shape.m_displayList;
+    QVERIFY(!displayList.isEmpty());
+
+    // the backends scale the contents to the shape size, so it is recorded again
+    shape.setSize(QSizeF(200, 80));
+    QImage *cached = renderAt(shape, 1.0);
+    QVERIFY(cached);
+    QVERIFY(shape.m_displayList != displayList);
+    QCOMPARE(*cached, drawDirectly(shape.size(), *cached, 1.0));
+}
+
+QTEST_MAIN(TestVectorShape)
@@ -52,6 +52,7 @@ public:
     PointStorageUndoCommand(QAbstractItemModel *const model, int role, KUndo2Command *parent = 0);
 
     virtual void undo();
+    virtual qint64 memoryCost() const;
 
     void add(const QVector<Pair> &pairs);
 
@@ -88,6 +89,12 @@ void PointStorageUndoCommand<T>::undo()
     KUndo2Command::undo(); // undo possible child commands
 }
 
+template<typename T>
+qint64 PointStorageUndoCommand<T>::memoryCost() const
+{
+    return KUndo2Command::memoryCost() + m_undoData.count() * qint64(sizeof(Pair));
+}
+
 template<typename T>
 void PointStorageUndoCommand<T>::add(const QVector<Pair>& pairs)
 {
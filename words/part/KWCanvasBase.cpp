@@ -49,11 +49,16 @@
 #include <QPainter>
 #include <QPainterPath>
 #include <QThread>
+#include <QTimer>
+#include <QElapsedTimer>
 
 #include <sys/time.h>
 
 //#define DEBUG_REPAINT
 
+// time in ms the cached pages are rendered for before returning to the event loop
+static const int RENDER_TIME_SLICE = 15;
+
 
 KWCanvasBase::KWCanvasBase(KWDocument *document, QObject *parent)
     : KoCanvasBase(document),
@@ -66,15 +71,22 @@ KWCanvasBase::KWCanvasBase(KWDocument *document, QObject *parent)
       m_cacheEnabled(false),
       m_currentZoom(0.0),
       m_maxZoom(2.0),
-      m_pageCacheManager(0)
+      m_pageCacheManager(0),
+      m_cacheSize(0),
+      m_renderTimer(new QTimer())
 {
     m_shapeManager = new KoShapeManager(this);
     m_toolProxy = new KoToolProxy(this, parent);
-    //setCacheEnabled(true);
+    setCacheEnabled(true);
+
+    m_renderTimer->setSingleShot(true);
+    m_renderTimer->setInterval(0);
+    QObject::connect(m_renderTimer, &QTimer::timeout, [this]() { renderPendingTiles(); });
 }
 
 KWCanvasBase::~KWCanvasBase()
 {
+    delete m_renderTimer;
     delete m_shapeManager;
     delete m_viewMode;
     delete m_pageCacheManager;
@@ -244,6 +256,7 @@ void KWCanvasBase::paintGrid(QPainter &painter, KWViewMode::ViewMap &vm)
 void KWCanvasBase::paint(QPainter &painter, const QRectF &paintRect)
 {
     painter.translate(-m_documentOffset);
+    m_lastPaintRect = paintRect.translated(m_documentOffset);
 
     static int iteration = 0;
     iteration++;
@@ -251,7 +264,13 @@ void KWCanvasBase::paint(QPainter &painter, const QRectF &paintRect)
     if (m_viewMode->hasPages()) {
 
         int pageContentArea = 0;
-        if (!m_cacheEnabled || !m_pageCacheManager) { // no caching, simple case
+        const bool cached = m_cacheEnabled && m_pageCacheManager && viewConverter()->zoom() <= m_maxZoom;
+        if (!cached && m_pageCacheManager && m_currentZoom != 0.0) {
+            // pages are not cached above the maximum zoom level, so free the cached ones
+            m_pageCacheManager->clear();
+            m_currentZoom = 0.0;
+        }
+        if (!cached) { // no caching, simple case
 
             QVector<KWViewMode::ViewMap> map =
                     m_viewMode->mapExposedRects(paintRect.translated(m_documentOffset),
@@ -291,355 +310,97 @@ void KWCanvasBase::paint(QPainter &painter, const QRectF &paintRect)
                 }
             }
         }
-        else {
+        else { // we cache at the actual zoom level
+            QVector<KWViewMode::ViewMap> map =
+                    m_viewMode->mapExposedRects(paintRect.translated(m_documentOffset),
+                                                viewConverter());
 
-#if 0
-    // at the moment we're always caching at the actual zoomlevel anyway, but if we want to
-    // re-enable this distinction, the massive code duplication between these two code paths
-    // should first be removed
-            if (viewConverter()->zoom() <= m_maxZoom) { // we cache at the actual zoom level
-#endif
-                QVector<KWViewMode::ViewMap> map =
-                        m_viewMode->mapExposedRects(paintRect.translated(m_documentOffset),
-                                                    viewConverter());
+            foreach (KWViewMode::ViewMap vm, map) {
 
-                foreach (KWViewMode::ViewMap vm, map) {
+                painter.save();
 
-                    painter.save();
+                // Set up the painter to clip the part of the canvas that contains the rect.
+                painter.translate(vm.distance.x(), vm.distance.y());
+                vm.clipRect = vm.clipRect.adjusted(-1, -1, 1, 1);
+                painter.setClipRect(vm.clipRect);
 
-                    // Set up the painter to clip the part of the canvas that contains the rect.
-                    painter.translate(vm.distance.x(), vm.distance.y());
-                    vm.clipRect = vm.clipRect.adjusted(-1, -1, 1, 1);
-                    painter.setClipRect(vm.clipRect);
+                // Paint the background of the page.  This includes
+                // the annotation area if that should be shown.
+                paintBackgrounds(painter, vm);
 
-                    // Paint the background of the page.
-                    QColor color = Qt::white;
-#ifdef DEBUG_REPAINT
-                    color = QColor(random() % 255, random() % 255, random() % 255);
-#endif
-                    painter.fillRect(vm.clipRect, QBrush(color));
-
-                    // Paint the contents of the page.
-                    painter.setRenderHint(QPainter::Antialiasing);
-
-                    // clear the cache if the zoom changed
-                    qreal zoom = viewConverter()->zoom();
-                    if (m_currentZoom != zoom) {
-                        m_pageCacheManager->clear();
-                        m_currentZoom = zoom;
-                    }
-
-                    KWPageCache *pageCache = m_pageCacheManager->take(vm.page);
-
-                    if (!pageCache) {
-                        pageCache = m_pageCacheManager->cache(QSize(viewConverter()->documentToViewX(vm.page.width()),
-                                                                    viewConverter()->documentToViewY(vm.page.height())));
-                    }
-
-                    Q_ASSERT(!pageCache->cache.isEmpty());
-
-                    // vm.page is in points, not view units
-                    QSizeF pageSizeDocument(vm.page.width(), vm.page.height());
-                    QSizeF pageSizeView = viewConverter()->documentToView(pageSizeDocument);
-
-                    qreal  pageTopDocument = vm.page.offsetInDocument();
-                    qreal  pageTopView = viewConverter()->documentToViewY(pageTopDocument);
-
-                    QRectF pageRectDocument = vm.page.rect();
-                    QRectF pageRectView = viewConverter()->documentToView(pageRectDocument);
-
-                    // translated from the page topleft to 0,0 for our cache image
-                    QRectF clipRectOnPage = vm.clipRect.translated(-pageRectView.x(), -pageTopView);
-
-                    // create exposed rects when the page is to be completely repainted.
-                    // we cannot wait for the updateCanvas calls to actually tell us which parts
-                    // need painting, because updateCanvas is not called when a page is done
-                    // layouting.
-                    if (pageCache->allExposed)  {
-
-                        pageCache->exposed.clear();
-                        QRect rc(QPoint(0,0), pageSizeView.toSize());
-
-                        const int UPDATE_WIDTH = 900;
-                        const int UPDATE_HEIGHT = 128;
-
-                        int row = 0;
-                        int heightLeft = rc.height();
-                        while (heightLeft > 0) {
-                            int height = qMin(heightLeft, UPDATE_HEIGHT);
-                            int column = 0;
-                            int columnLeft = rc.width();
-                            while (columnLeft > 0) {
-                                int width = qMin(columnLeft, UPDATE_WIDTH);
-                                QRect rc2(column, row, width, height);
-                                pageCache->exposed << rc2;
-                                columnLeft -= width;
-                                column += width;
-                            }
-                            heightLeft -= height;
-                            row += height;
-                        }
-                        pageCache->allExposed = false;
-                    }
-
-                    // There is stuff to be repainted, so collect all the repaintable
-                    // rects that are in view and paint them.
-                    if (!pageCache->exposed.isEmpty()) {
-                        QRegion paintRegion;
-                        QVector<QRect> remainingUnExposed;
-                        const QVector<QRect> &exposed = pageCache->exposed;
-                        for (int i = 0; i < exposed.size(); ++i) {
-
-                            QRect rc = exposed.at(i);
-
-                            if (rc.intersects(clipRectOnPage.toRect())) {
-                                paintRegion += rc;
-                                int tilex = 0, tiley = 0;
-                                for (int x = 0, i = 0; x < pageCache->m_tilesx; ++x) {
-                                    int dx = pageCache->cache[i].width();
-                                    for (int y = 0; y < pageCache->m_tilesy; ++y, ++i) {
-                                        QImage& img = pageCache->cache[i];
-                                        QRect tile(tilex, tiley, img.width(), img.height());
-                                        QRect toClear = tile.intersected(rc);
-                                        if (!toClear.isEmpty()) {
-                                            QPainter gc(&img);
-                                            gc.eraseRect(toClear.translated(-tilex, -tiley));
-                                            gc.end();
-                                        }
-                                        tiley += img.height();
-                                    }
-                                    tilex += dx;
-                                    tiley = 0;
-                                }
-                            }
-                            else {
-                                remainingUnExposed << rc;
-                            }
-                        }
-                        pageCache->exposed = remainingUnExposed;
-                        if (!paintRegion.isEmpty()) {
-                            // paint the exposed regions of the page
-
-                            QRect r = paintRegion.boundingRect();
-                            QImage img(r.size(), QImage::Format_RGB16);
-                            img.fill(0xffff);
-
-                            // we paint to a small image as it is much faster the painting to the big image
-                            QPainter tilePainter(&img);
-                            tilePainter.setClipRect(QRect(QPoint(0,0), r.size()));
-                            tilePainter.translate(-r.left(), -pageTopView - r.top());
-                            tilePainter.setRenderHint(QPainter::Antialiasing);
-                            shapeManager()->paint(tilePainter, *viewConverter(), false);
-
-                            int tilex = 0, tiley = 0;
-                            for (int x = 0, i = 0; x < pageCache->m_tilesx; ++x) {
-                                int dx = pageCache->cache[i].width();
-                                for (int y = 0; y < pageCache->m_tilesy; ++y, ++i) {
-                                    QImage& tileImg = pageCache->cache[i];
-                                    QRect tile(tilex, tiley, tileImg.width(), tileImg.height());
-                                    QRect toPaint = tile.intersected(r);
-                                    if (!toPaint.isEmpty()) {
-                                        QPainter imagePainter(&tileImg);
-                                        imagePainter.drawImage(r.topLeft() - QPoint(tilex, tiley), img);
-                                    }
-                                    tiley += tileImg.height();
-                                }
-                                tilex += dx;
-                                tiley = 0;
-                            }
-                        }
-                    }
-                    // paint from the cached page image on the original painter
-
-                    int tilex = 0, tiley = 0;
-                    for (int x = 0, i = 0; x < pageCache->m_tilesx; ++x) {
-                        int dx = pageCache->cache[i].width();
-                        for (int y = 0; y < pageCache->m_tilesy; ++y, ++i) {
-                            const QImage& cacheImage = pageCache->cache[i];
-                            QRectF tile(tilex, tiley, cacheImage.width(), cacheImage.height());
-                            QRectF toPaint = tile.intersected(clipRectOnPage);
-                            QRectF dst = toPaint.translated(pageRectView.topLeft());
-                            QRectF src = toPaint.translated(-tilex, -tiley);
-                            painter.drawImage(dst, cacheImage, src);
-                            tiley += cacheImage.height();
-                        }
-                        tilex += dx;
-                        tiley = 0;
-                    }
-
-                    // put the cache back
-                    m_pageCacheManager->insert(vm.page, pageCache);
-                    // Paint the page decorations: border, shadow, etc.
-                    paintPageDecorations(painter, vm);
-
-                    // Paint the grid
-                    paintGrid(painter, vm);
-
-                    // paint whatever the tool wants to paint
-                    m_toolProxy->paint(painter, *(viewConverter()));
-                    painter.restore();
+                // Paint the contents of the page.
+                painter.setRenderHint(QPainter::Antialiasing);
 
-                    int contentArea = vm.clipRect.width() * vm.clipRect.height();
-                    if (contentArea > pageContentArea) {
-                        pageContentArea = contentArea;
-                    }
+                // keep the pages of the previous zoom to show them until they are rendered again
+                qreal zoom = viewConverter()->zoom();
+                if (m_currentZoom != zoom) {
+                    m_pageCacheManager->zoomChanged(m_currentZoom, zoom);
+                    m_currentZoom = zoom;
                 }
-#if 0
-            }
-            else { // we cache at 100%, but paint at the actual zoom level
 
-                KoViewConverter localViewConverter;
-                localViewConverter.setZoom(1.0);
+                KWPageCache *pageCache = m_pageCacheManager->take(vm.page);
 
-                QVector<KWViewMode::ViewMap> map =
-                        m_viewMode->mapExposedRects(paintRect.translated(m_documentOffset),
-                                                    viewConverter());
-                foreach (KWViewMode::ViewMap vm, map) {
+                if (!pageCache) {
+                    pageCache = m_pageCacheManager->cache(pageSizeInView(vm.page));
+                }
 
-                    painter.save();
+                Q_ASSERT(!pageCache->cache.isEmpty());
 
-                    // Set up the painter to clip the part of the canvas that contains the rect.
-                    painter.translate(vm.distance.x(), vm.distance.y());
-                    vm.clipRect = vm.clipRect.adjusted(-1, -1, 1, 1);
-                    painter.setClipRect(vm.clipRect);
+                qreal  pageTopDocument = vm.page.offsetInDocument();
+                qreal  pageTopView = viewConverter()->documentToViewY(pageTopDocument);
 
-                    // Paint the background of the page.
-                    QColor color = Qt::white;
-#ifdef DEBUG_REPAINT
-                    color = QColor(random() % 255, random() % 255, random() % 255);
-#endif
-                    painter.fillRect(vm.clipRect, QBrush(color));
-
-                    // Paint the contents of the page.
-                    painter.setRenderHint(QPainter::Antialiasing);
-
-                    // clear the cache if the zoom changed
-                    qreal zoom = 1.0;
-                    if (m_currentZoom != zoom) {
-                        m_pageCacheManager->clear();
-                        m_currentZoom = zoom;
-                    }
-
-                    KWPageCache *pageCache = m_pageCacheManager->take(vm.page);
-                    if (!pageCache) {
-                        pageCache = m_pageCacheManager->cache(QSize(localViewConverter.documentToViewX(vm.page.width()),
-                                                                    localViewConverter.documentToViewY(vm.page.height())));
-                    }
-                    Q_ASSERT(pageCache->cache);
-
-                    // vm.page is in points, not view units
-                    QSizeF pageSizeDocument(vm.page.width(), vm.page.height());
-                    QSizeF pageSizeView = localViewConverter.documentToView(pageSizeDocument);
-
-                    qreal  pageTopDocument = vm.page.offsetInDocument();
-                    qreal  pageTopView = localViewConverter.documentToViewY(pageTopDocument);
-
-                    QRectF pageRectDocument = vm.page.rect();
-                    QRectF pageRectView = localViewConverter.documentToView(pageRectDocument);
-
-                    // translated from the page topleft to 0,0 for our cache image
-                    QRectF documentClipRect = m_viewMode->viewToDocument(vm.clipRect, viewConverter());
-                    QRectF clipRectOnPage = localViewConverter.documentToView(documentClipRect);
-                    clipRectOnPage = clipRectOnPage.translated(-pageRectView.x(), -pageTopView);
-
-                    // create exposed rects when the page is to be completely repainted.
-                    // we cannot wait for the updateCanvas calls to actually tell us which parts
-                    // need painting, because updateCanvas is not called when a page is done
-                    // layouting.
-                    if (pageCache->allExposed)  {
-
-                        pageCache->exposed.clear();
-                        QRect rc(QPoint(0,0), pageSizeView.toSize());
-
-                        const int UPDATE_SIZE = 64; //pixels
-
-                        if (rc.height() < UPDATE_SIZE) {
-                            pageCache->exposed << rc;
-                        }
-                        else {
-                            int row = 0;
-                            int hleft = rc.height();
-                            int w = rc.width();
-                            while (hleft > 0) {
-                                QRect rc2(0, row, w, qMin(hleft, UPDATE_SIZE));
-                                pageCache->exposed << rc2;
-                                hleft -= UPDATE_SIZE;
-                                row += UPDATE_SIZE;
-                            }
-                        }
-                        pageCache->allExposed = false;
-                    }
-
-                    // There is stuff to be repainted, so collect all the repaintable
-                    // rects that are in view and paint them.
-                    if (!pageCache->exposed.isEmpty()) {
-                        QRegion paintRegion;
-                        QVector<QRect> remainingUnExposed;
-                        const QVector<QRect> &exposed = pageCache->exposed;
-                        for (int i = 0; i < exposed.size(); ++i) {
-
-                            QRect rc = exposed.at(i);
-
-                            if (rc.intersects(clipRectOnPage.toRect())) {
-                                paintRegion += rc;
-                                QPainter gc(pageCache->cache);
-                                gc.eraseRect(rc);
-                                gc.end();
-                            }
-                            else {
-                                remainingUnExposed << rc;
-                            }
-                        }
-
-                        pageCache->exposed = remainingUnExposed;
-
-                        // paint the exposed regions of the page
-                        QPainter gc(pageCache->cache);
-                        gc.translate(0, -pageTopView);
-                        gc.setClipRegion(paintRegion.translated(0, pageTopView));
-
-                        // paint into the cache
-                        shapeManager()->paint(gc, localViewConverter, false);
-                    }
-                    QImage copy = pageCache->cache->copy(clipRectOnPage.toRect());
-
-                    // Now calculate where to paint pour stuff
-                    pageTopView = viewConverter()->documentToViewY(pageTopDocument);
-                    pageRectView = viewConverter()->documentToView(pageRectDocument);
-                    clipRectOnPage = viewConverter()->documentToView(documentClipRect);
-                    clipRectOnPage = clipRectOnPage.translated(-pageRectView.x(), -pageTopView);
-
-                    copy = copy.scaled(clipRectOnPage.width(), clipRectOnPage.height(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-
-                    // paint from the cached page image on the original painter.
-                    QRect dst = QRect(pageRectView.x() + clipRectOnPage.x(),
-                                      pageRectView.y() + clipRectOnPage.y(),
-                                      clipRectOnPage.width(),
-                                      clipRectOnPage.height());
-
-                    painter.drawImage(dst.x(), dst.y(), copy, 0, 0, copy.width(), copy.height());
+                QRectF pageRectDocument = vm.page.rect();
+                QRectF pageRectView = viewConverter()->documentToView(pageRectDocument);
+
+                // translated from the page topleft to 0,0 for our cache image
+                QRectF clipRectOnPage = vm.clipRect.translated(-pageRectView.x(), -pageTopView);
+
+                // create exposed rects when the page is to be completely repainted.
+                // we cannot wait for the updateCanvas calls to actually tell us which parts
+                // need painting, because updateCanvas is not called when a page is done
+                // layouting.
+                pageCache->exposeAll();
+
+                // The exposed rects are rendered by renderPendingTiles(). Until then the parts
+                // never rendered are shown from the page at the previous zoom, if there is one.
+                const QRegion missing = QRegion(clipRectOnPage.toAlignedRect()) - pageCache->rendered;
+                KWPageCache *previousCache = m_pageCacheManager->previousCache(vm.page);
+                if (!missing.isEmpty() && previousCache) {
+                    const qreal scale = zoom / m_pageCacheManager->previousZoom();
+                    painter.save();
+                    painter.setClipRegion(missing.translated(pageRectView.topLeft().toPoint()), Qt::IntersectClip);
+                    painter.translate(pageRectView.topLeft());
+                    painter.scale(scale, scale);
+                    previousCache->paint(painter, QRectF(clipRectOnPage.topLeft() / scale, clipRectOnPage.size() / scale), QPointF());
                     painter.restore();
+                }
 
-                    // put the cache back
-                    m_pageCacheManager->insert(vm.page, pageCache);
+                // paint from the cached page image on the original painter
+                pageCache->paint(painter, clipRectOnPage, pageRectView.topLeft());
 
-                    // Paint the page decorations: border, shadow, etc.
-                    paintPageDecorations(painter, vm);
+                if (!pageCache->exposed.isEmpty() && !m_renderTimer->isActive()) {
+                    m_renderTimer->start();
+                }
 
-                    // Paint the grid
-                    paintGrid(painter, vm);
+                // put the cache back
+                m_pageCacheManager->insert(vm.page, pageCache);
+                paintBorder(painter, vm);
 
-                    // paint whatever the tool wants to paint
-                    m_toolProxy->paint(painter, *(viewConverter()));
+                // Paint the page decorations: shadow, etc.
+                paintPageDecorations(painter, vm);
 
+                // Paint the grid
+                paintGrid(painter, vm);
 
-                    int contentArea = qRound(vm.clipRect.width() * vm.clipRect.height());
-                    if (contentArea > pageContentArea) {
-                        pageContentArea = contentArea;
-                    }
+                // paint whatever the tool wants to paint
+                m_toolProxy->paint(painter, *(viewConverter()));
+                painter.restore();
+
+                int contentArea = vm.clipRect.width() * vm.clipRect.height();
+                if (contentArea > pageContentArea) {
+                    pageContentArea = contentArea;
                 }
             }
-#endif
         }
     } else {
         // TODO paint the main-text-flake directly
@@ -649,130 +410,23 @@ void KWCanvasBase::paint(QPainter &painter, const QRectF &paintRect)
 
 void KWCanvasBase::updateCanvas(const QRectF &rc)
 {
-    if (!m_cacheEnabled) { // no caching
-        QRectF zoomedRect = m_viewMode->documentToView(rc, viewConverter());
-        QVector<KWViewMode::ViewMap> map = m_viewMode->mapExposedRects(zoomedRect,
-                                                                     viewConverter());
-        foreach (KWViewMode::ViewMap vm, map) {
-            vm.clipRect.adjust(-2, -2, 2, 2); // grow for anti-aliasing
-            QRect finalClip((int)(vm.clipRect.x() + vm.distance.x() - m_documentOffset.x()),
-                            (int)(vm.clipRect.y() + vm.distance.y() - m_documentOffset.y()),
-                            vm.clipRect.width(), vm.clipRect.height());
-            updateCanvasInternal(finalClip);
-        }
-    }
-    else { // Caching at the actual zoom level
-        if (viewConverter()->zoom() <= m_maxZoom) {
-            QRectF zoomedRect = m_viewMode->documentToView(rc, viewConverter());
-            QVector<KWViewMode::ViewMap> map = m_viewMode->mapExposedRects(zoomedRect,
-                                                                         viewConverter());
-            foreach (KWViewMode::ViewMap vm, map) {
-                vm.clipRect.adjust(-2, -2, 2, 2); // grow for anti-aliasing
-                QRect finalClip((int)(vm.clipRect.x() + vm.distance.x() - m_documentOffset.x()),
-                                (int)(vm.clipRect.y() + vm.distance.y() - m_documentOffset.y()),
-                                vm.clipRect.width(), vm.clipRect.height());
-
-                if (!m_pageCacheManager) {
-                    // no pageCacheManager, so create one for the current view. This happens only once!
-                    // so on zoom change, we don't re-pre-generate weight/zoom images.
-                    m_pageCacheManager = new KWPageCacheManager(m_cacheSize);
-                }
-
-                if (m_currentZoom != viewConverter()->zoom()) {
-                    m_currentZoom = viewConverter()->zoom();
-                    m_pageCacheManager->clear();
-                }
-
-                KWPageCache *pageCache = m_pageCacheManager->take(vm.page);
-                if (pageCache) {
-                    //if (rc.isNull()) {
-                        pageCache->allExposed = true;
-                        pageCache->exposed.clear();
-#if 0
-                    }
-                    else {
-                        qreal  pageTopDocument = vm.page.offsetInDocument();
-                        qreal  pageTopView = viewConverter()->documentToViewY(pageTopDocument);
-                        QRectF pageRectDocument = vm.page.rect();
-                        QRectF pageRectView = viewConverter()->documentToView(pageRectDocument);
-
-                        // translated from the page topleft to 0,0 for our cache image
-                        QRect clipRectOnPage = vm.clipRect.translated(-pageRectView.x(), -pageTopView);
-
-                        pageCache->exposed.append(clipRectOnPage);
-                    }
-#endif
-                    m_pageCacheManager->insert(vm.page, pageCache);
-                }
-                updateCanvasInternal(finalClip);
-            }
-        }
-        else { // Cache at 100%, but update the canvas at the actual zoom level
-
-            KoViewConverter localViewConverter;
-            localViewConverter.setZoom(1.0);
-
-            // Viewmap scaled to 100% for calculating which parts of the cached page image
-            // are exposed.
-            QRectF zoomedRect = m_viewMode->documentToView(rc, &localViewConverter);
-            QVector<KWViewMode::ViewMap> map = m_viewMode->mapExposedRects(zoomedRect, &localViewConverter);
-
-            // Viewmap scaled to the actual size of the canvas, so we know which areas to call
-            // update() for.
-            zoomedRect = m_viewMode->documentToView(rc, viewConverter());
-            QVector<KWViewMode::ViewMap> actualMap = m_viewMode->mapExposedRects(zoomedRect, viewConverter());
-
-            Q_ASSERT(actualMap.size() == map.size());
-
-            for (int index = 0; index < map.size(); ++index) {
-
-                Q_ASSERT(index < map.size());
-                KWViewMode::ViewMap vm = map.at(index);
-                vm.clipRect.adjust(-2, -2, 2, 2); // grow for anti-aliasing
-
-                Q_ASSERT(index < actualMap.size());
-                KWViewMode::ViewMap actualVm = actualMap.at(index);
-                actualVm.clipRect.adjust(-2, -2, 2, 2); // grow for anti-aliasing
-                QRect finalClip = QRect((int)(actualVm.clipRect.x() + vm.distance.x() - m_documentOffset.x()),
-                                        (int)(actualVm.clipRect.y() + vm.distance.y() - m_documentOffset.y()),
-                                        actualVm.clipRect.width(),
-                                        actualVm.clipRect.height());
-
-                if (!m_pageCacheManager) {
-                    // no pageCacheManager, so create one for the current view. This happens only once!
-                    // so on zoom change, we don't re-pre-generate weight/zoom images.
-                    m_pageCacheManager = new KWPageCacheManager(m_cacheSize);
-                }
-
-                if (m_currentZoom != 1.0) {
-                    m_pageCacheManager->clear();
-                    m_currentZoom = 1.0;
-                }
-
-                KWPageCache *pageCache = m_pageCacheManager->take(vm.page);
-                if (pageCache) {
-                    //if (rc.isNull()) {
-                        pageCache->allExposed = true;
-                        pageCache->exposed.clear();
-#if 0
-                    }
-                    else {
-                        qreal pageTopDocument = vm.page.offsetInDocument();
-                        qreal pageTopView = localViewConverter.documentToViewY(pageTopDocument);
-                        QRectF pageRectDocument = vm.page.rect();
-                        QRectF pageRectView = localViewConverter.documentToView(pageRectDocument);
-
-                        // translated from the page topleft to 0,0 for our cache image
-                        QRect clipRectOnPage = vm.clipRect.translated(-pageRectView.x(), -pageTopView);
-
-                        pageCache->exposed.append(clipRectOnPage);
-                    }
-#endif
-                    m_pageCacheManager->insert(vm.page, pageCache);
-                }
-                updateCanvasInternal(finalClip);
-            }
+    const bool cached = m_cacheEnabled && m_pageCacheManager && viewConverter()->zoom() <= m_maxZoom;
+    QRectF zoomedRect = m_viewMode->documentToView(rc, viewConverter());
+    QVector<KWViewMode::ViewMap> map = m_viewMode->mapExposedRects(zoomedRect,
+                                                                 viewConverter());
+    foreach (KWViewMode::ViewMap vm, map) {
+        vm.clipRect.adjust(-2, -2, 2, 2); // grow for anti-aliasing
+        QRect finalClip((int)(vm.clipRect.x() + vm.distance.x() - m_documentOffset.x()),
+                        (int)(vm.clipRect.y() + vm.distance.y() - m_documentOffset.y()),
+                        vm.clipRect.width(), vm.clipRect.height());
+
+        if (cached) { // Caching at the actual zoom level
+            // only the changed part of the cached page has to be rendered again
+            const qreal pageTopView = viewConverter()->documentToViewY(vm.page.offsetInDocument());
+            const QRectF pageRectView = viewConverter()->documentToView(vm.page.rect());
+            m_pageCacheManager->invalidate(vm.page, vm.clipRect.translated(-qRound(pageRectView.x()), -qRound(pageTopView)));
         }
+        updateCanvasInternal(finalClip);
     }
 }
 
@@ -791,6 +445,108 @@ void KWCanvasBase::setCacheEnabled(bool enabled, int cacheSize, qreal maxZoom)
     m_cacheEnabled = enabled;
     m_cacheSize = cacheSize;
     m_maxZoom = maxZoom;
+    if (!enabled) {
+        m_renderTimer->stop();
+    }
+}
+
+void KWCanvasBase::renderPendingTiles()
+{
+    if (!m_cacheEnabled || !m_pageCacheManager || !m_viewMode || !m_viewMode->hasPages())
+        return;
+    if (viewConverter()->zoom() > m_maxZoom)
+        return; // pages are painted directly
+    if (viewConverter()->zoom() != m_currentZoom)
+        return; // the next paint starts over for the new zoom
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QRectF visibleRect = m_lastPaintRect;
+    if (canvasController() && !canvasController()->viewportSize().isEmpty()) {
+        visibleRect = QRectF(m_documentOffset, canvasController()->viewportSize());
+    }
+    const QVector<KWViewMode::ViewMap> map = m_viewMode->mapExposedRects(visibleRect, viewConverter());
+    // room for the pages in view and the ones next to them
+    if (!map.isEmpty()) {
+        m_pageCacheManager->reserve(map.count() + 2, pageSizeInView(map.first().page));
+    }
+
+    bool pending = false;
+    foreach (const KWViewMode::ViewMap &vm, map) {
+        pending |= renderPageTiles(vm.page, vm.clipRect, vm.distance, timer);
+    }
+
+    // Prefetch the pages before and after the ones in view, as long as that
+    // does not push pages out of the cache.
+    if (!pending && !map.isEmpty()) {
+        QList<KWPage> neighbours;
+        neighbours << map.first().page.previous() << map.last().page.next();
+        foreach (const KWPage &page, neighbours) {
+            if (page.isValid() && (m_pageCacheManager->hasRoom(pageSizeInView(page)) || m_pageCacheManager->contains(page))) {
+                pending |= renderPageTiles(page, QRect(), QPointF(), timer);
+            }
+        }
+    }
+
+    if (pending) {
+        m_renderTimer->start();
+    }
+}
+
+bool KWCanvasBase::renderPageTiles(const KWPage &page, const QRect &clipRect, const QPointF &distance, const QElapsedTimer &timer)
+{
+    KWPageCache *pageCache = m_pageCacheManager->take(page);
+    if (!pageCache) {
+        pageCache = m_pageCacheManager->cache(pageSizeInView(page));
+    }
+    pageCache->exposeAll();
+
+    const qreal pageTopView = viewConverter()->documentToViewY(page.offsetInDocument());
+    const QRectF pageRectView = viewConverter()->documentToView(page.rect());
+    const QRect clipRectOnPage = QRectF(clipRect).translated(-pageRectView.x(), -pageTopView).toAlignedRect();
+
+    while (!pageCache->exposed.isEmpty() && timer.elapsed() < RENDER_TIME_SLICE) {
+        // render the parts in view first
+        int index = 0;
+        for (int i = 0; i < pageCache->exposed.count(); ++i) {
+            if (pageCache->exposed.at(i).intersects(clipRectOnPage)) {
+                index = i;
+                break;
+            }
+        }
+        const QRect r = pageCache->exposed.takeAt(index);
+
+        QImage img(r.size(), QImage::Format_RGB16);
+        img.fill(0xffff);
+
+        // we paint to a small image as it is much faster the painting to the big image
+        QPainter tilePainter(&img);
+        tilePainter.setClipRect(QRect(QPoint(0,0), r.size()));
+        tilePainter.translate(-r.left(), -pageTopView - r.top());
+        tilePainter.setRenderHint(QPainter::Antialiasing);
+        shapeManager()->paint(tilePainter, *viewConverter(), false);
+        tilePainter.end();
+
+        pageCache->update(r, img);
+
+        if (r.intersects(clipRectOnPage)) {
+            QRectF viewRect = QRectF(r.intersected(clipRectOnPage));
+            viewRect.translate(pageRectView.x() + distance.x() - m_documentOffset.x(),
+                               pageTopView + distance.y() - m_documentOffset.y());
+            updateCanvasInternal(viewRect);
+        }
+    }
+
+    const bool pending = !pageCache->exposed.isEmpty();
+    m_pageCacheManager->insert(page, pageCache);
+    return pending;
+}
+
+QSize KWCanvasBase::pageSizeInView(const KWPage &page) const
+{
+    return QSize(viewConverter()->documentToViewX(page.width()),
+                 viewConverter()->documentToViewY(page.height()));
 }
 
 QPoint KWCanvasBase::documentOffset() const
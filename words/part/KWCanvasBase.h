@@ -38,6 +38,8 @@
 
 class QRect;
 class QPainter;
+class QTimer;
+class QElapsedTimer;
 
 class KoToolProxy;
 class KoShape;
@@ -91,16 +93,22 @@ public: // KoCanvasBase interface methods.
     virtual void ensureVisible(const QRectF &rect);
 
     /**
-     * Enable or disable the page cache. The cache stores the rendered pages. It is
-     * emptied when the zoomlevel changes.
+     * Enable or disable the page cache. The cache stores the rendered pages. When the
+     * zoomlevel changes the pages of the previous zoomlevel are kept, so zooming back
+     * reuses them.
      *
      * @param enabled: if true, we cache the contents of the document for this canvas,
      *  for the current zoomlevel
-     * @param cacheSize: the maximum size for the cache. The cache will throw away
-     *  pages once this size is reached. Depending on Qt's implementation of QCache, the
-     *  unit is pages.
+     * @param cacheSize: the maximum size for the cache in megabytes of page images. The
+     *  cache will throw away the least recently used pages once this size is reached.
+     *  The pages of the previous zoomlevel may take up half of that in addition.
      * @param maxZoom above this zoomlevel we'll paint a scaled version of the cache, instead
      *  of creating a new cache
+     *
+     * With the cache enabled, pages are rendered into the cache in the background, in
+     * short time slices on the event loop. Until the parts of a page in view are rendered
+     * the page from the previous zoomlevel is shown scaled, or the page is left blank.
+     * Once the pages in view are complete the pages next to them are rendered too.
      */
     virtual void setCacheEnabled(bool enabled, int cacheSize = 50, qreal maxZoom = 2.0);
 
@@ -142,6 +150,14 @@ protected:
 
     virtual void updateCanvasInternal(const QRectF &clip) = 0;
 
+private:
+    /// render the exposed parts of the cached pages, the ones in view first
+    void renderPendingTiles();
+    /// render exposed parts of \p page until \p timer runs out, return true if parts are left
+    bool renderPageTiles(const KWPage &page, const QRect &clipRect, const QPointF &distance, const QElapsedTimer &timer);
+    /// return the size of \p page at the current zoom level
+    QSize pageSizeInView(const KWPage &page) const;
+
 protected:
 
     KWDocument *m_document;
@@ -154,9 +170,11 @@ protected:
 
     bool m_cacheEnabled;
     qreal m_currentZoom;
-    qreal m_maxZoom; //< above this zoomlevel we scale the cached image, instead of recreating the cache.
+    qreal m_maxZoom; //< above this zoomlevel pages are painted directly instead of being cached.
     KWPageCacheManager *m_pageCacheManager;
     int m_cacheSize;
+    QTimer *m_renderTimer; //< schedules renderPendingTiles()
+    QRectF m_lastPaintRect; //< in view coordinates, used when there is no canvas controller
 
 };
 
@@ -21,8 +21,16 @@
 #include "KWPageCacheManager.h"
 
 #include <QImage>
+#include <QList>
+#include <QPainter>
+#include <QPair>
 
 static const int MAX_TILE_SIZE = 1024;
+// size of the parts a page is rendered in, small enough to keep the canvas responsive
+static const int UPDATE_WIDTH = 900;
+static const int UPDATE_HEIGHT = 128;
+// how much reserve() may grow the cache beyond the size it was created with
+static const int MAX_RESERVE_FACTOR = 4;
 
 /*
 KWPageCache::KWPageCache(KWPageCacheManager *manager, QImage *img)
@@ -57,8 +65,117 @@ KWPageCache::~KWPageCache()
 {
 }
 
+void KWPageCache::exposeAll()
+{
+    if (!allExposed)
+        return;
+
+    exposed.clear();
+    expose(QRect(QPoint(0, 0), m_size));
+    allExposed = false;
+}
+
+void KWPageCache::invalidate(const QRect &rect)
+{
+    const QRect r = rect.intersected(QRect(QPoint(0, 0), m_size));
+    if (r.isEmpty())
+        return;
+
+    rendered -= r;
+    if (!allExposed) // else exposeAll() queues the whole page anyway
+        expose(r);
+}
+
+void KWPageCache::expose(const QRect &rect)
+{
+    for (int row = rect.top(); row <= rect.bottom(); row += UPDATE_HEIGHT) {
+        const int height = qMin(rect.bottom() + 1 - row, UPDATE_HEIGHT);
+        for (int column = rect.left(); column <= rect.right(); column += UPDATE_WIDTH) {
+            const QRect part(column, row, qMin(rect.right() + 1 - column, UPDATE_WIDTH), height);
+            // the caret for example invalidates the same small rect over and over
+            bool queued = false;
+            foreach (const QRect &r, exposed) {
+                if (r.contains(part)) {
+                    queued = true;
+                    break;
+                }
+            }
+            if (!queued)
+                exposed << part;
+        }
+    }
+}
+
+void KWPageCache::update(const QRect &rect, const QImage &image)
+{
+    int tilex = 0, tiley = 0;
+    for (int x = 0, i = 0; x < m_tilesx; ++x) {
+        int dx = cache[i].width();
+        for (int y = 0; y < m_tilesy; ++y, ++i) {
+            QImage &tileImg = cache[i];
+            QRect tile(tilex, tiley, tileImg.width(), tileImg.height());
+            if (tile.intersects(rect)) {
+                QPainter imagePainter(&tileImg);
+                imagePainter.setCompositionMode(QPainter::CompositionMode_Source);
+                imagePainter.drawImage(rect.topLeft() - QPoint(tilex, tiley), image);
+            }
+            tiley += tileImg.height();
+        }
+        tilex += dx;
+        tiley = 0;
+    }
+    rendered += rect;
+}
+
+void KWPageCache::paint(QPainter &painter, const QRectF &clipRectOnPage, const QPointF &offset) const
+{
+    if (rendered.isEmpty())
+        return;
+
+    painter.save();
+    painter.setClipRegion(rendered.translated(offset.toPoint()), Qt::IntersectClip);
+    int tilex = 0, tiley = 0;
+    for (int x = 0, i = 0; x < m_tilesx; ++x) {
+        int dx = cache[i].width();
+        for (int y = 0; y < m_tilesy; ++y, ++i) {
+            const QImage &cacheImage = cache[i];
+            QRectF tile(tilex, tiley, cacheImage.width(), cacheImage.height());
+            QRectF toPaint = tile.intersected(clipRectOnPage);
+            if (!toPaint.isEmpty()) {
+                QRectF dst = toPaint.translated(offset);
+                QRectF src = toPaint.translated(-tilex, -tiley);
+                painter.drawImage(dst, cacheImage, src);
+            }
+            tiley += cacheImage.height();
+        }
+        tilex += dx;
+        tiley = 0;
+    }
+    painter.restore();
+}
+
+int KWPageCache::cost() const
+{
+    int bytes = 0;
+    foreach (const QImage &tile, cache) {
+        bytes += tile.byteCount();
+    }
+    return bytes / 1024 + 1;
+}
+
+/// return the memory a page image of \p size takes, in kilobytes
+static int pageCost(const QSize &size)
+{
+    // the tiles are 16 bit images
+    return qint64(size.width()) * size.height() * 2 / 1024 + 1;
+}
+
 KWPageCacheManager::KWPageCacheManager(int cacheSize)
-    : m_cache(cacheSize)
+    : m_cache(cacheSize * 1024)
+    , m_previousCache(cacheSize * 512)
+    , m_cacheSize(cacheSize * 1024)
+    , m_zoom(0.0)
+    , m_previousZoom(0.0)
 {
 }
 
@@ -76,11 +193,14 @@ KWPageCache *KWPageCacheManager::take(const KWPage &page)
     return cache;
 }
 
+bool KWPageCacheManager::contains(const KWPage &page) const
+{
+    return m_cache.contains(page);
+}
+
 void KWPageCacheManager::insert(const KWPage &page, KWPageCache *cache)
 {
-    QSize size = cache->m_size;
-    // make sure always at least two pages can be cached
-    m_cache.insert(page, cache, qMin(m_cache.maxCost() / 2, size.width() * size.height()));
+    m_cache.insert(page, cache, cache->cost());
 }
 
 KWPageCache *KWPageCacheManager::cache(const QSize &size)
@@ -92,8 +212,69 @@ KWPageCache *KWPageCacheManager::cache(const QSize &size)
     return cache;
 }
 
-void KWPageCacheManager::clear()
+void KWPageCacheManager::reserve(int pageCount, const QSize &pageSize)
+{
+    const int cost = qBound(m_cacheSize, pageCount * pageCost(pageSize), MAX_RESERVE_FACTOR * m_cacheSize);
+    if (m_cache.maxCost() != cost) {
+        m_cache.setMaxCost(cost);
+        m_previousCache.setMaxCost(cost / 2);
+    }
+}
+
+bool KWPageCacheManager::hasRoom(const QSize &pageSize) const
+{
+    return m_cache.totalCost() + pageCost(pageSize) <= m_cache.maxCost();
+}
+
+void KWPageCacheManager::invalidate(const KWPage &page, const QRect &rect)
+{
+    KWPageCache *cache = m_cache.object(page);
+    if (cache) {
+        cache->invalidate(rect);
+    }
+    cache = m_previousCache.object(page);
+    if (cache && m_zoom > 0.0) {
+        const qreal scale = m_previousZoom / m_zoom;
+        cache->invalidate(QRectF(QPointF(rect.topLeft()) * scale, QSizeF(rect.size()) * scale).toAlignedRect());
+    }
+}
+
+void KWPageCacheManager::zoomChanged(qreal previousZoom, qreal zoom)
 {
+    QList<QPair<KWPage, KWPageCache*> > restored;
+    if (zoom == m_previousZoom) {
+        // zooming back, the pages kept for this zoom level are current again
+        foreach (const KWPage &page, m_previousCache.keys()) {
+            restored.append(qMakePair(page, m_previousCache.take(page)));
+        }
+    }
+    m_previousCache.clear();
+    m_previousZoom = previousZoom;
+    m_zoom = zoom;
+    if (previousZoom > 0.0) {
+        foreach (const KWPage &page, m_cache.keys()) {
+            KWPageCache *cache = m_cache.take(page);
+            m_previousCache.insert(page, cache, cache->cost());
+        }
+    }
     m_cache.clear();
+    for (int i = 0; i < restored.count(); ++i) {
+        insert(restored.at(i).first, restored.at(i).second);
+    }
+}
+
+KWPageCache *KWPageCacheManager::previousCache(const KWPage &page) const
+{
+    return m_previousCache.object(page);
+}
+
+qreal KWPageCacheManager::previousZoom() const
+{
+    return m_previousZoom;
 }
 
+void KWPageCacheManager::clear()
+{
+    m_cache.clear();
+    m_previousCache.clear();
+}
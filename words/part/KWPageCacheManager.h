@@ -21,15 +21,18 @@
 #define KWPAGECACHEMANAGER_H
 
 #include "KWPage.h"
+#include "words_export.h"
 // Qt
 #include <QCache>
 #include <QImage>
+#include <QRegion>
 
 class QSize;
+class QPainter;
 
 class KWPageCacheManager;
 
-class KWPageCache {
+class WORDS_TEST_EXPORT KWPageCache {
 
 
 public:
@@ -41,6 +44,24 @@ public:
     KWPageCache(KWPageCacheManager *manager, int w, int h);
     ~KWPageCache();
 
+    /// split the page into rects queued for updating if the whole page should be repainted
+    void exposeAll();
+
+    /// stop showing the part \p rect of the page and queue it for updating
+    void invalidate(const QRect &rect);
+
+    /// copy the rendered \p image of the part \p rect of the page into the tiles
+    void update(const QRect &rect, const QImage &image);
+
+    /**
+     * Paint the rendered parts of the page which are inside \p clipRectOnPage.
+     * @param offset the position of the top-left corner of the page on the painter
+     */
+    void paint(QPainter &painter, const QRectF &clipRectOnPage, const QPointF &offset) const;
+
+    /// return the memory taken by the tiles, in kilobytes
+    int cost() const;
+
     KWPageCacheManager* m_manager;
     QVector<QImage> cache;
     int m_tilesx, m_tilesy;
@@ -51,26 +72,69 @@ public:
     QVector<QRect> exposed;
     // true if the whole page should be repainted
     bool allExposed;
+    // The parts of the tiles which hold rendered contents. These may be outdated
+    // if they are also exposed.
+    QRegion rendered;
+
+private:
+    /// queue \p rect for updating, split into parts small enough to be rendered quickly
+    void expose(const QRect &rect);
 };
 
-class KWPageCacheManager {
+class WORDS_TEST_EXPORT KWPageCacheManager {
 
 public:
 
+    /// @param cacheSize the memory the cached page images may take, in megabytes
     explicit KWPageCacheManager(int cacheSize);
 
     ~KWPageCacheManager();
 
     KWPageCache *take(const KWPage &page);
 
+    bool contains(const KWPage &page) const;
+
     void insert(const KWPage &page, KWPageCache *cache);
 
     KWPageCache *cache(const QSize &size);
 
+    /**
+     * Make sure at least \p pageCount pages of \p pageSize can be cached at the same time.
+     * The cache grows to at most four times the size it was created with for that.
+     */
+    void reserve(int pageCount, const QSize &pageSize);
+
+    /// return true if a page of \p pageSize can be cached without pushing another one out of the cache
+    bool hasRoom(const QSize &pageSize) const;
+
+    /**
+     * Mark the part \p rect of \p page to be rendered again, at the current and at the
+     * previous zoom level.
+     * @param rect the part of the page in view coordinates at the current zoom level,
+     *     relative to the top-left corner of the page
+     */
+    void invalidate(const KWPage &page, const QRect &rect);
+
+    /**
+     * Keep the cached pages as the ones of the previous zoom level, so they can be
+     * shown scaled until the pages are rendered for the new zoom level.
+     * If \p zoom is the previous zoom level, the pages kept for it are used again.
+     */
+    void zoomChanged(qreal previousZoom, qreal zoom);
+
+    /// return the cache of \p page at the previous zoom level or 0 if there is none
+    KWPageCache *previousCache(const KWPage &page) const;
+    qreal previousZoom() const;
+
     void clear();
 
 private:
+    // both caches count the memory of the page images, in kilobytes
     QCache<KWPage, KWPageCache> m_cache;
+    QCache<KWPage, KWPageCache> m_previousCache;
+    int m_cacheSize; // the size the cache was created with, in kilobytes
+    qreal m_zoom;
+    qreal m_previousZoom;
     friend class KWPageCache;
 };
 
@@ -380,10 +380,17 @@ void KWRootAreaProvider::releaseAllAfter(KoTextLayoutRootArea *afterThis)
         if (!m_pageHash.contains(afterThis))
             return;
         KWRootAreaPage *page = m_pageHash.value(afterThis);
-        afterIndex = m_pages.indexOf(page);
+        // Pages and root-areas are appended in order, so their positions are known
+        // without searching; the searches are only a fallback.
+        afterIndex = page->page.pageNumber() - 1;
+        if (m_pages.value(afterIndex) != page)
+            afterIndex = m_pages.indexOf(page);
         Q_ASSERT(afterIndex >= 0);
 
-        int newSize = m_rootAreaCache.indexOf(afterThis) + 1;
+        int afterThisIndex = afterThis->documentLayout()->indexOfRootArea(afterThis);
+        if (m_rootAreaCache.value(afterThisIndex) != afterThis)
+            afterThisIndex = m_rootAreaCache.indexOf(afterThis);
+        int newSize = afterThisIndex + 1;
         while (m_rootAreaCache.size() != newSize)
         {
             KoTextLayoutRootArea *oldArea = m_rootAreaCache.takeLast();
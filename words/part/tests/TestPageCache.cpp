@@ -0,0 +1,176 @@
+#include "TestPageCache.h"
+
+#include <KWDocument.h>
+#include <KWPage.h>
+#include <KWPageCacheManager.h>
+
+#include "MockPart.h"
+
+#include <QtTest>
+
+static KWPageCache *renderedCache(KWPageCacheManager &manager, const QSize &size)
+{
+    KWPageCache *cache = manager.cache(size);
+    cache->exposeAll();
+    QImage image(size, QImage::Format_RGB16);
+    image.fill(0);
+    cache->update(QRect(QPoint(0, 0), size), image);
+    cache->exposed.clear();
+    return cache;
+}
+
+void TestPageCache::testZoomBack()
+{
+    KWDocument doc(new MockPart);
+    KWPage page = doc.appendPage("Standard");
+    KWPageCacheManager manager(8);
+
+    KWPageCache *cache = renderedCache(manager, QSize(100, 150));
+    manager.insert(page, cache);
+
+    // zoom in, the page is kept for the previous zoom level
+    manager.zoomChanged(1.0, 2.0);
+    QVERIFY(!manager.contains(page));
+    QCOMPARE(manager.previousCache(page), cache);
+    QCOMPARE(manager.previousZoom(), 1.0);
+    KWPageCache *zoomed = renderedCache(manager, QSize(200, 300));
+    manager.insert(page, zoomed);
+
+    // zoom back, the page does not have to be rendered again
+    manager.zoomChanged(2.0, 1.0);
+    QVERIFY(manager.contains(page));
+    QCOMPARE(manager.previousCache(page), zoomed);
+    QCOMPARE(manager.previousZoom(), 2.0);
+    KWPageCache *restored = manager.take(page);
+    QCOMPARE(restored, cache);
+    QVERIFY(!restored->allExposed);
+    QVERIFY(restored->exposed.isEmpty());
+    QCOMPARE(restored->rendered, QRegion(0, 0, 100, 150));
+    manager.insert(page, restored);
+
+    // a third zoom level drops the pages of the first one
+    manager.zoomChanged(1.0, 3.0);
+    QCOMPARE(manager.previousCache(page), cache);
+    manager.zoomChanged(3.0, 2.0);
+    QVERIFY(!manager.contains(page));
+    QVERIFY(manager.previousCache(page) == 0);
+}
+
+void TestPageCache::testZoomBackInvalidated()
+{
+    KWDocument doc(new MockPart);
+    KWPage page = doc.appendPage("Standard");
+    KWPageCacheManager manager(8);
+
+    KWPageCache *cache = renderedCache(manager, QSize(100, 150));
+    manager.insert(page, cache);
+    manager.zoomChanged(1.0, 2.0);
+
+    // the page changed while zoomed in, so the kept page is outdated
+    manager.invalidate(page, QRect(0, 0, 200, 300));
+    manager.zoomChanged(2.0, 1.0);
+    QCOMPARE(manager.take(page), cache);
+    QVERIFY(cache->rendered.isEmpty());
+    QRegion exposed;
+    foreach (const QRect &rect, cache->exposed) {
+        exposed += rect;
+    }
+    QCOMPARE(exposed, QRegion(0, 0, 100, 150));
+    delete cache;
+}
+
+void TestPageCache::testInvalidateRect()
+{
+    KWDocument doc(new MockPart);
+    KWPage page = doc.appendPage("Standard");
+    KWPageCacheManager manager(8);
+
+    KWPageCache *cache = renderedCache(manager, QSize(1000, 300));
+    manager.insert(page, cache);
+    manager.zoomChanged(1.0, 2.0);
+    KWPageCache *zoomed = renderedCache(manager, QSize(2000, 600));
+    manager.insert(page, zoomed);
+
+    // only the changed part is rendered again, at both zoom levels
+    manager.invalidate(page, QRect(20, 40, 60, 20));
+    QCOMPARE(zoomed->rendered, QRegion(0, 0, 2000, 600) - QRegion(20, 40, 60, 20));
+    QCOMPARE(zoomed->exposed, QVector<QRect>() << QRect(20, 40, 60, 20));
+    QCOMPARE(cache->rendered, QRegion(0, 0, 1000, 300) - QRegion(10, 20, 30, 10));
+    QCOMPARE(cache->exposed, QVector<QRect>() << QRect(10, 20, 30, 10));
+
+    // invalidating the same part again, like the blinking caret does, queues nothing new
+    manager.invalidate(page, QRect(20, 40, 60, 20));
+    QCOMPARE(zoomed->exposed.count(), 1);
+
+    // big parts are split to keep rendering them responsive, parts outside the page are ignored
+    zoomed->exposed.clear();
+    manager.invalidate(page, QRect(-100, 0, 2200, 300));
+    QVERIFY(zoomed->exposed.count() > 1);
+    QRegion exposed;
+    foreach (const QRect &rect, zoomed->exposed) {
+        QVERIFY(rect.width() * rect.height() < 2000 * 300);
+        exposed += rect;
+    }
+    QCOMPARE(exposed, QRegion(0, 0, 2000, 300));
+}
+
+void TestPageCache::testMemoryLimit()
+{
+    KWDocument doc(new MockPart);
+    QList<KWPage> pages;
+    pages << doc.appendPage("Standard") << doc.appendPage("Standard") << doc.appendPage("Standard");
+    // a page of 500x500 pixels takes about half a megabyte
+    const QSize size(500, 500);
+    KWPageCacheManager manager(1);
+
+    QVERIFY(manager.hasRoom(size));
+    manager.insert(pages[0], renderedCache(manager, size));
+    QVERIFY(manager.hasRoom(size));
+    manager.insert(pages[1], renderedCache(manager, size));
+    QVERIFY(!manager.hasRoom(size));
+    manager.insert(pages[2], renderedCache(manager, size));
+    QVERIFY(!manager.contains(pages[0]));
+    QVERIFY(manager.contains(pages[1]));
+    QVERIFY(manager.contains(pages[2]));
+
+    // room for the pages in view
+    manager.reserve(3, size);
+    QVERIFY(manager.hasRoom(size));
+
+    // the previous zoom level gets half of the memory
+    manager.zoomChanged(1.0, 2.0);
+    QVERIFY((manager.previousCache(pages[1]) == 0) != (manager.previousCache(pages[2]) == 0));
+}
+
+void TestPageCache::testReserveLimit()
+{
+    KWDocument doc(new MockPart);
+    QList<KWPage> pages;
+    for (int i = 0; i < 10; ++i) {
+        pages << doc.appendPage("Standard");
+    }
+    // a page of 500x500 pixels takes about half a megabyte
+    const QSize size(500, 500);
+    KWPageCacheManager manager(1);
+
+    // reserving room for many pages grows the cache to four times its size only
+    manager.reserve(pages.count(), size);
+    foreach (const KWPage &page, pages) {
+        manager.insert(page, renderedCache(manager, size));
+    }
+    int cached = 0;
+    foreach (const KWPage &page, pages) {
+        cached += manager.contains(page) ? 1 : 0;
+    }
+    QCOMPARE(cached, 8);
+
+    // with fewer pages in view, the cache shrinks again
+    manager.reserve(1, size);
+    cached = 0;
+    foreach (const KWPage &page, pages) {
+        cached += manager.contains(page) ? 1 : 0;
+    }
+    QCOMPARE(cached, 2);
+}
+
+QTEST_MAIN(TestPageCache)
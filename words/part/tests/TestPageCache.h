@@ -0,0 +1,17 @@
+#ifndef TESTPAGECACHE_H
+#define TESTPAGECACHE_H
+
+#include <QObject>
+
+class TestPageCache : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS: // tests
+    void testZoomBack();
+    void testZoomBackInvalidated();
+    void testInvalidateRect();
+    void testMemoryLimit();
+    void testReserveLimit();
+};
+
+#endif